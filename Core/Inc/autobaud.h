@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @file           : autobaud.h
+  * @brief          : Header for autobaud.c file.
+  *                   Baud rate detection from the edge timing of the RX line.
+  ******************************************************************************
+  * @attention
+  *
+  * Both edges of the RX pin raise an EXTI interrupt, which stamps them with
+  * the DWT cycle counter, started by HAL_DMAIdleRecieverEx_TimestampInit()
+  * (HAL_MspInit()). The pin stays in its U(S)ART alternate function:
+  * the EXTI input is fed from the GPIO input stage in every mode.
+  * Every interval between two edges of up to 9 bits must be a whole number
+  * of bits of the actual rate; the intervals are checked against the bit time
+  * of each candidate of pRates. A candidate qualifies after LockIntervals
+  * consecutive whole-bit intervals including a single-bit one, with an
+  * averaged rate within Tolerance; the fastest qualifying candidate is
+  * reported through AutoBaud_LockedCallback(), called from the EXTI interrupt.
+  * Data whose bits only form runs of even length (rare in text) cannot tell a
+  * rate from half of it; restart the detection on framing errors if the line
+  * may carry such data.
+  * The EXTI interrupt should have the highest priority: its latency jitter
+  * adds to the measured intervals. Rates up to about SystemCoreClock / 200
+  * are measured reliably.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUTOBAUD_H
+#define __AUTOBAUD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Largest number of candidate rates */
+#define AUTOBAUD_MAX_RATES            8U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Baud rate detection configuration structure definition
+  */
+typedef struct
+{
+  GPIO_TypeDef     *GPIOx;          /*!< GPIO port of the RX pin                                      */
+
+  uint16_t         Pin;             /*!< RX pin, GPIO_PIN_x; its EXTI line must not be used elsewhere  */
+
+  const uint32_t   *pRates;         /*!< Candidate baud rates, no two closer than a factor of 1.5     */
+
+  uint32_t         NumRates;        /*!< Number of candidate rates, at most AUTOBAUD_MAX_RATES        */
+
+  uint32_t         Tolerance;       /*!< Largest measured/candidate mismatch accepted, in ppm         */
+
+  uint32_t         LockIntervals;   /*!< Consecutive consistent edge intervals required to lock       */
+
+  uint32_t         CycleClock;      /*!< Frequency of the edge timestamps in Hz, 0: SystemCoreClock   */
+} AutoBaud_InitTypeDef;
+
+/**
+  * @brief Baud rate detection handle structure definition
+  */
+typedef struct
+{
+  AutoBaud_InitTypeDef Init;        /*!< Detection parameters                                         */
+
+  uint32_t         MinBit;          /*!< Shorter intervals are glitches, in cycles                    */
+
+  uint32_t         Edges;           /*!< Edges seen since the detection started                       */
+
+  uint32_t         LastEdge;        /*!< Timestamp of the previous edge                               */
+
+  uint32_t         Bit[AUTOBAUD_MAX_RATES];        /*!< Bit time of each candidate, in cycles         */
+
+  uint32_t         SumCycles[AUTOBAUD_MAX_RATES];  /*!< Cycles of the consecutive whole-bit intervals */
+
+  uint32_t         SumBits[AUTOBAUD_MAX_RATES];    /*!< Bits of the consecutive whole-bit intervals   */
+
+  uint32_t         Consistent[AUTOBAUD_MAX_RATES]; /*!< Consecutive whole-bit intervals               */
+
+  uint32_t         SingleMask;      /*!< Candidates that saw a single-bit interval since their reset  */
+
+  __IO uint32_t    BaudRate;        /*!< Detected candidate rate, 0 while measuring                   */
+} AutoBaud_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef AutoBaud_Init(AutoBaud_HandleTypeDef *habaud);
+void     AutoBaud_Reset(AutoBaud_HandleTypeDef *habaud);
+uint32_t AutoBaud_Edge(AutoBaud_HandleTypeDef *habaud, uint32_t Cycles);
+
+HAL_StatusTypeDef AutoBaud_Start(AutoBaud_HandleTypeDef *habaud);
+void     AutoBaud_Stop(AutoBaud_HandleTypeDef *habaud);
+void     AutoBaud_IRQHandler(AutoBaud_HandleTypeDef *habaud);
+
+void     AutoBaud_LockedCallback(AutoBaud_HandleTypeDef *habaud);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUTOBAUD_H */
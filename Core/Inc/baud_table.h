@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file           : baud_table.h
+  * @brief          : Header for baud_table.c file.
+  *                   Achievable baud rates and CPU budget for a bus clock.
+  ******************************************************************************
+  * @attention
+  *
+  * The baud rate generator divides the APB clock by 8 (OVER8) or 16 (OVER16)
+  * times USARTDIV, a 12.3 or 12.4 fixed-point value, so the rate obtained is
+  * rarely the one requested. BaudTable_Compute() returns the BRR value the
+  * driver programs for a rate, the rate actually produced, its error in ppm
+  * and the number of CPU cycles available per received 8N1 character.
+  * Receivers tolerate roughly +/-2% (OVER16) or +/-1.5% (OVER8) total
+  * mismatch, shared between both ends of the link.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BAUD_TABLE_H
+#define __BAUD_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Number of entries of BaudTable_StandardRates[] */
+#define BAUDTABLE_NUM_STANDARD_RATES  18U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Baud rate table entry structure definition
+  */
+typedef struct
+{
+  uint32_t Requested;       /*!< Requested baud rate                                      */
+
+  uint32_t Actual;          /*!< Baud rate produced by Brr, rounded; 0 if not achievable   */
+
+  int32_t  ErrorPpm;        /*!< (Actual - Requested) / Requested, in ppm                 */
+
+  uint32_t Brr;             /*!< USART_BRR value, as programmed by the driver             */
+
+  uint32_t CyclesPerByte;   /*!< CPU cycles per 10-bit character (8N1) at SystemCoreClock */
+} BaudTable_EntryTypeDef;
+
+/* Exported variables --------------------------------------------------------*/
+extern const uint32_t BaudTable_StandardRates[BAUDTABLE_NUM_STANDARD_RATES];
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef BaudTable_Compute(uint32_t Pclk, uint32_t OverSampling, uint32_t BaudRate,
+                                    BaudTable_EntryTypeDef *pEntry);
+uint32_t BaudTable_Build(uint32_t Pclk, uint32_t OverSampling, const uint32_t *pRates, uint32_t Count,
+                         BaudTable_EntryTypeDef *pTable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BAUD_TABLE_H */
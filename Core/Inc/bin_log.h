@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file           : bin_log.h
+  * @brief          : Header for bin_log.c file.
+  *                   Log records formatted on the host.
+  ******************************************************************************
+  * @attention
+  *
+  * BINLOG(fmt, args...) sends a record made of the identifier of its format
+  * string and the raw values of its integer arguments, instead of the text.
+  * The format string is placed in the .binlog section, which the linker
+  * script keeps in the ELF file but does not load: it costs no flash, and its
+  * address within the section is its identifier. Records are written to a log
+  * stream and may be mixed with plain text, which must be ASCII:
+  *
+  *   0xFF, payload length, varint(identifier), varint(argument) ...
+  *
+  * Varints are LEB128, 7 bits per byte, low bits first: a value below 128
+  * takes one byte, a negative int takes five. Tools/binlog_decode.py rebuilds
+  * the text from the ELF file. Conversions: %d %i %u %x %X %o %c %p, with
+  * flags and width; arguments are converted to uint32_t, pointers must be
+  * cast by the caller.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BIN_LOG_H
+#define __BIN_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "log_stream.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief First byte of a record, never found in ASCII text */
+#define BINLOG_SYNC                   0xFFU
+
+/** @brief Arguments of a record */
+#define BINLOG_MAX_ARGS               8U
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+  * @brief Send a record of the format string __FMT__, a string literal, and up to
+  *        BINLOG_MAX_ARGS integer arguments.
+  * @note  The call site stores the arguments and calls BinLog_Write().
+  */
+#define BINLOG(__FMT__, ...)                                                                 \
+  do                                                                                         \
+  {                                                                                          \
+    static const char BinLog_Fmt[] __attribute__((section(".binlog"), used)) = __FMT__;     \
+    const uint32_t BinLog_Args[] = { 0U, ##__VA_ARGS__ };                                    \
+    (void)sizeof(char[(sizeof(BinLog_Args) <= ((BINLOG_MAX_ARGS + 1U) * 4U)) ? 1 : -1]);     \
+    BinLog_Write((uint32_t)BinLog_Fmt, &BinLog_Args[1],                                      \
+                 (sizeof(BinLog_Args) / sizeof(BinLog_Args[0])) - 1U);                       \
+  } while (0)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void     BinLog_Init(LogStream_HandleTypeDef *hlog);
+uint32_t BinLog_Write(uint32_t Id, const uint32_t *pArgs, uint32_t NumArgs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BIN_LOG_H */
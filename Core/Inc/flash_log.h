@@ -0,0 +1,167 @@
+/**
+  ******************************************************************************
+  * @file           : flash_log.h
+  * @brief          : Header for flash_log.c file.
+  *                   Append-only log of records in a ring of flash sectors.
+  ******************************************************************************
+  * @attention
+  *
+  * FlashLog_Append() encodes a record into a staging ring of words in RAM and
+  * returns; the flash is programmed one word at a time from the FLASH
+  * interrupt (HAL_FLASH_Program_IT(), FLASH_TYPEPROGRAM_WORD), so the caller
+  * never waits for it. Records go to a ring of reserved sectors: each sector
+  * starts with a header carrying its sequence number and erase count, and
+  * the sector after the current one is erased (HAL_FLASHEx_Erase_IT()) once
+  * the staging ring is empty, which drops the oldest sector. Every reserved
+  * sector is thus erased once per lap of the ring.
+  * While an erase runs, up to 2 s for a 128 KB sector, nothing is programmed
+  * and records wait in the staging ring: it must hold the records of that
+  * time, otherwise FlashLog_Append() drops them. The reserved sectors must be
+  * in bank 2 and the code in bank 1, so that the CPU keeps running from flash
+  * during programming and erase (read-while-write).
+  * A record is: a length word (length and its complement), the timestamp, the
+  * payload padded to whole words, then a CRC-32 of the previous words, written
+  * last. A sector header is valid once its magic word, written last, is set.
+  * After a power failure, FlashLog_Init() continues after the last record
+  * started, and FlashLog_ReadNext() skips records without a matching CRC.
+  * FlashLog_Append() is called from a single context; FlashLog_IRQHandler()
+  * is called from FLASH_IRQHandler(), no other code may use the FLASH HAL.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_LOG_H
+#define __FLASH_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Longest record payload in bytes */
+#define FLASHLOG_MAX_LENGTH           1024U
+
+/** @brief Words of a record besides its payload: length, timestamp and CRC */
+#define FLASHLOG_RECORD_OVERHEAD      3U
+
+/** @brief Words of a sector header: magic, sequence number, erase count, check */
+#define FLASHLOG_HEADER_WORDS         4U
+
+/** @brief Magic word of a valid sector header */
+#define FLASHLOG_MAGIC                0x474F4C46U
+
+/** @defgroup FlashLog_State Programming state
+  * @{
+  */
+#define FLASHLOG_STATE_IDLE           0x00U   /*!< No flash operation in progress             */
+#define FLASHLOG_STATE_PROGRAM        0x01U   /*!< A word is being programmed                 */
+#define FLASHLOG_STATE_ERASE          0x02U   /*!< The next sector is being erased            */
+#define FLASHLOG_STATE_ERROR          0x03U   /*!< An erase failed, the log is stopped        */
+/**
+  * @}
+  */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Flash log Init structure definition
+  */
+typedef struct
+{
+  uint32_t               FirstSector; /*!< First reserved sector, FLASH_SECTOR_12 or above (bank 2) */
+
+  uint32_t               NumSectors;  /*!< Number of consecutive reserved sectors, at least 2       */
+} FlashLog_InitTypeDef;
+
+/**
+  * @brief Flash log handle structure definition
+  */
+typedef struct
+{
+  FlashLog_InitTypeDef   Init;        /*!< Parameters, set before FlashLog_Init()                   */
+
+  uint32_t               *pStage;     /*!< Staging ring of encoded records, CPU only                */
+
+  uint32_t               StageSize;   /*!< Staging ring size in words, power of two                 */
+
+  __IO uint32_t          StageHead;   /*!< Free-running index of the next word to encode            */
+
+  __IO uint32_t          StageTail;   /*!< Free-running index of the next word to program           */
+
+  __IO uint32_t          State;       /*!< A value of @ref FlashLog_State                           */
+
+  uint32_t               Sector;      /*!< Current sector, 0 to Init.NumSectors - 1                 */
+
+  uint32_t               Address;     /*!< Address of the next word to program                      */
+
+  uint32_t               SectorEnd;   /*!< Address after the current sector                         */
+
+  uint32_t               Sequence;    /*!< Sequence number of the current sector                    */
+
+  uint32_t               EraseCount;  /*!< Erase count of the current sector                        */
+
+  __IO uint32_t          NextErased;  /*!< The next sector is erased and has no header              */
+
+  uint32_t               NextEraseCount; /*!< Erase count of the next sector, once erased           */
+
+  uint32_t               HeaderLeft;  /*!< Header words of the current sector left to program       */
+
+  uint32_t               RecordLeft;  /*!< Words of the current record left to program              */
+
+  uint32_t               Records;     /*!< Records accepted by FlashLog_Append()                    */
+
+  uint32_t               DroppedRecords; /*!< Records refused on a full staging ring                */
+
+  uint32_t               StageHighWater; /*!< Highest number of staged words                        */
+
+  uint32_t               EraseStarted; /*!< Sector erases started                                   */
+
+  uint32_t               ErrorCount;  /*!< Failed flash operations                                  */
+} FlashLog_HandleTypeDef;
+
+/**
+  * @brief Record returned by FlashLog_ReadNext()
+  */
+typedef struct
+{
+  const uint8_t          *pData;      /*!< Payload, in flash                                        */
+
+  uint16_t               Len;         /*!< Payload length in bytes                                  */
+
+  uint32_t               Timestamp;   /*!< Timestamp given to FlashLog_Append()                     */
+} FlashLog_RecordTypeDef;
+
+/**
+  * @brief Read position, from the oldest record to the newest
+  */
+typedef struct
+{
+  uint32_t               Sector;      /*!< Sector being read, 0 to Init.NumSectors - 1              */
+
+  uint32_t               Sequence;    /*!< Sequence number of the sector being read, to detect its erase */
+
+  uint32_t               Address;     /*!< Address of the next record                               */
+
+  uint32_t               Skipped;     /*!< Records skipped for a CRC mismatch                       */
+} FlashLog_CursorTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef FlashLog_Init(FlashLog_HandleTypeDef *hflog, uint32_t *pStage, uint32_t StageSize);
+HAL_StatusTypeDef FlashLog_Append(FlashLog_HandleTypeDef *hflog, const uint8_t *pData, uint32_t Len,
+                                  uint32_t Timestamp);
+uint32_t FlashLog_GetPending(const FlashLog_HandleTypeDef *hflog);
+void     FlashLog_IRQHandler(FlashLog_HandleTypeDef *hflog);
+
+/* Reading, while no erase is in progress */
+void     FlashLog_ResetCursor(const FlashLog_HandleTypeDef *hflog, FlashLog_CursorTypeDef *pCursor);
+HAL_StatusTypeDef FlashLog_ReadNext(const FlashLog_HandleTypeDef *hflog, FlashLog_CursorTypeDef *pCursor,
+                                    FlashLog_RecordTypeDef *pRecord);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_LOG_H */
@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file           : gnss_fix.h
+  * @brief          : Header for gnss_fix.c file.
+  *                   Fixed-point position, velocity and time conversions.
+  ******************************************************************************
+  * @attention
+  *
+  * Converts the decimal fields of the NMEA parser and the UBX NAV-PVT record
+  * to one set of integer units, so the fix path needs no float, atof or
+  * snprintf:
+  *   - angles:   1e-7 degree (latitude, longitude), 1e-5 degree (course)
+  *   - distance: millimetre
+  *   - speed:    millimetre per second
+  *   - time:     millisecond of the UTC day
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __GNSS_FIX_H
+#define __GNSS_FIX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "nmea.h"
+#include "ubx.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @defgroup GNSSFIX_Valid Fix validity flags
+  * @{
+  */
+#define GNSSFIX_VALID_TIME            0x01U   /*!< TimeOfDay is set              */
+#define GNSSFIX_VALID_DATE            0x02U   /*!< Date is set                   */
+#define GNSSFIX_VALID_POSITION        0x04U   /*!< Latitude, Longitude are set   */
+#define GNSSFIX_VALID_ALTITUDE        0x08U   /*!< Altitude is set               */
+#define GNSSFIX_VALID_VELOCITY        0x10U   /*!< Speed, Course are set         */
+/**
+  * @}
+  */
+
+#define GNSSFIX_MS_PER_DAY            86400000U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Navigation solution in integer units
+  */
+typedef struct
+{
+  uint32_t          TimeOfDay;        /*!< UTC, ms since midnight                     */
+  uint32_t          Date;             /*!< UTC ddmmyy                                 */
+  int32_t           Latitude;         /*!< 1e-7 deg, north positive                   */
+  int32_t           Longitude;        /*!< 1e-7 deg, east positive                    */
+  int32_t           Altitude;         /*!< Above mean sea level, mm                   */
+  int32_t           Speed;            /*!< Ground speed, mm/s                         */
+  int32_t           Course;           /*!< Course over ground, 1e-5 deg               */
+  uint8_t           NumSatellites;    /*!< Satellites used                            */
+  uint8_t           Valid;            /*!< GNSSFIX_VALID_xxx flags                    */
+} GnssFix_TypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef GnssFix_Rescale(const Nmea_DecimalTypeDef *pField, uint32_t Scale, int32_t *pValue);
+HAL_StatusTypeDef GnssFix_ToDeg7(const Nmea_DecimalTypeDef *pField, char Hemisphere, int32_t *pDeg7);
+HAL_StatusTypeDef GnssFix_ToTimeOfDay(const Nmea_DecimalTypeDef *pField, uint32_t *pMs);
+HAL_StatusTypeDef GnssFix_KnotsToMms(const Nmea_DecimalTypeDef *pField, int32_t *pMms);
+HAL_StatusTypeDef GnssFix_KmhToMms(const Nmea_DecimalTypeDef *pField, int32_t *pMms);
+
+void GnssFix_UpdateNmea(GnssFix_TypeDef *pFix, const Nmea_SentenceTypeDef *pSentence);
+void GnssFix_UpdateUbx(GnssFix_TypeDef *pFix, const Ubx_NavPvtTypeDef *pNavPvt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GNSS_FIX_H */
@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file           : log_stream.h
+  * @brief          : Header for log_stream.c file.
+  *                   Log byte stream drained by the Tx DMA of a port.
+  ******************************************************************************
+  * @attention
+  *
+  * LogStream_Write() copies the bytes into a ring and returns: it never
+  * waits for the UART, except under LOGSTREAM_OVERFLOW_BLOCK with a full
+  * ring. Writers claim their space and publish it in short PRIMASK sections
+  * and copy with interrupts enabled, so they may be called from any context
+  * and interrupt one another. The ring is drained through two DMA-readable
+  * run buffers of LOGSTREAM_RUN_SIZE bytes queued on the transmit queue of
+  * the port, so the ring itself may be in CCM RAM. The application forwards
+  * TxQueue_SentCallback() of that queue to LogStream_SentCallback().
+  * The stream registered with LogStream_SetStdout() receives stdout and
+  * stderr, through _write() in syscalls.c.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LOG_STREAM_H
+#define __LOG_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "tx_queue.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @defgroup LogStream_Overflow Policy on a full ring
+  * @{
+  */
+#define LOGSTREAM_OVERFLOW_DROP_NEWEST 0x00U   /*!< The write that does not fit is dropped              */
+#define LOGSTREAM_OVERFLOW_DROP_OLDEST 0x01U   /*!< The oldest bytes not yet sent make room for it      */
+#define LOGSTREAM_OVERFLOW_BLOCK       0x02U   /*!< The writer waits for room; writes from an interrupt
+                                                    or with interrupts masked drop the newest instead  */
+/**
+  * @}
+  */
+
+/** @brief Size of each of the two run buffers read by the Tx DMA */
+#define LOGSTREAM_RUN_SIZE            64U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Log stream Init structure definition
+  */
+typedef struct
+{
+  uint32_t               Overflow;    /*!< Policy on a full ring, a value of @ref LogStream_Overflow */
+} LogStream_InitTypeDef;
+
+/**
+  * @brief Log stream handle structure definition
+  */
+typedef struct
+{
+  LogStream_InitTypeDef  Init;        /*!< Parameters, set before LogStream_Init()                  */
+
+  TxQueue_HandleTypeDef  *hTxQueue;   /*!< Transmit queue of the port                               */
+
+  uint8_t                *pBuffer;    /*!< Ring storage, CPU only                                   */
+
+  uint32_t               Size;        /*!< Ring size in bytes, power of two                         */
+
+  uint8_t                *pRun;       /*!< Two run buffers, DMA-readable                            */
+
+  __IO uint32_t          Reserve;     /*!< Free-running index of the next byte to claim             */
+
+  __IO uint32_t          Commit;      /*!< Free-running index after the last byte written           */
+
+  __IO uint32_t          Tail;        /*!< Free-running index of the oldest byte not yet sent       */
+
+  __IO uint32_t          Writers;     /*!< Writes between claim and publication                     */
+
+  __IO uint32_t          RunBusy;     /*!< Bit i: run buffer i is queued on the port                */
+
+  uint32_t               HighWater;   /*!< Highest number of bytes claimed and not yet sent         */
+
+  uint32_t               SentBytes;   /*!< Bytes handed over to the USART                           */
+
+  uint32_t               DroppedBytes; /*!< Bytes lost to the overflow policy                       */
+
+  uint32_t               DropCount;   /*!< Writes that lost bytes, or made older ones be dropped    */
+} LogStream_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef LogStream_Init(LogStream_HandleTypeDef *hlog, TxQueue_HandleTypeDef *hTxQueue,
+                                 uint8_t *pBuffer, uint32_t Size, uint8_t *pRun);
+uint32_t LogStream_Write(LogStream_HandleTypeDef *hlog, const uint8_t *pData, uint32_t Len);
+uint32_t LogStream_GetPending(const LogStream_HandleTypeDef *hlog);
+
+/* TxQueue_SentCallback() of the port queue, forwarded by the application */
+void     LogStream_SentCallback(LogStream_HandleTypeDef *hlog, const uint8_t *pData, uint16_t Len);
+
+/* stdout and stderr */
+void     LogStream_SetStdout(LogStream_HandleTypeDef *hlog);
+int      LogStream_WriteStdout(const char *ptr, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOG_STREAM_H */
@@ -59,6 +59,69 @@ void Error_Handler(void);
 /* Private defines -----------------------------------------------------------*/
 
 /* USER CODE BEGIN Private defines */
+/* 1: Rx Event callbacks only record the DMA position and pend PendSV, which
+      copies the received bytes at the lowest interrupt priority.
+   0: copy directly in the USART/DMA interrupt. */
+#define RX_DEFERRED_PROCESSING 1
+
+/* End-of-frame gap on USART1, in tenths of a character time (TIM2) */
+#define RX_EOF_TIMEOUT 35
+
+/* 1: USART1 Rx DMA in Normal mode with the stream FIFO, word writes in INC4
+      bursts, alternating between the two halves of RxData; each IDLE flushes
+      the FIFO. 0: circular Rx DMA with byte writes, read in place. */
+#define RX_DMA_FIFO 0
+
+/* 1: detect the USART1 baud rate from the PA10 edges (EXTI10) before
+      starting reception; 0: receive at the UartPortConfig[] rate. */
+#define RX_AUTOBAUD 0
+
+/* stdout (printf) on USART1 through the DMA-drained log stream; on a full
+   LOG_SIZE ring: LOGSTREAM_OVERFLOW_DROP_NEWEST, LOGSTREAM_OVERFLOW_DROP_OLDEST
+   or LOGSTREAM_OVERFLOW_BLOCK (thread mode only, drops the newest in ISRs) */
+#define LOG_OVERFLOW LOGSTREAM_OVERFLOW_DROP_NEWEST
+
+/* 1: forward every byte received on USART1 to USART6 (PC6 TX, DMA2 Stream6),
+      in place from RxData while USART6 keeps up, through a staging ring
+      otherwise; USART1 data is still parsed. Needs RX_DMA_FIFO 0.
+   0: USART6 is not used. */
+#define UART_BRIDGE 0
+
+/* 1: append every received frame, with its timestamp, to a log in flash
+      sectors 20 to 23 (bank 2, 512 KB, kept out of FLASH by the linker
+      scripts), programmed word by word from the FLASH interrupt.
+   0: the flash is never written. */
+#define FLASH_LOG 0
+
+/* 1: forward every validated RTCM3 frame received on USART1 to USART6 (PC6 TX,
+      DMA2 Stream6), in place from the RX ring, which holds its bytes until
+      they are sent. Frames arriving while the USART6 queue is full are
+      dropped whole.
+   0: RTCM3 frames are validated only. */
+#define RTCM3_FORWARD 1
+
+#if (UART_BRIDGE == 1) && (RX_DMA_FIFO == 1)
+#error "UART_BRIDGE forwards in place from the circular Rx DMA buffer: set RX_DMA_FIFO to 0"
+#endif
+
+#if (UART_BRIDGE == 1) && (RTCM3_FORWARD == 1)
+#error "UART_BRIDGE already forwards every USART1 byte to USART6: set RTCM3_FORWARD to 0"
+#endif
+
+/* System clock profile. The generated SystemClock_Config() sets up the 72 MHz
+   tree of the .ioc, SystemClock_ConfigProfile() (main.c) then moves to 180 MHz:
+   SYSCLK_PROFILE_72MHZ:  HCLK 72 MHz, APB1 36 MHz, APB2 72 MHz, scale 3, 2 wait states
+   SYSCLK_PROFILE_180MHZ: HCLK 180 MHz, APB1 45 MHz, APB2 90 MHz, scale 1 with
+                          over-drive, 5 wait states (VDD 2.7-3.6 V); USART1/6 up to
+                          11.25 Mbaud with OVER8 */
+#define SYSCLK_PROFILE_72MHZ  0
+#define SYSCLK_PROFILE_180MHZ 1
+#define SYSCLK_PROFILE SYSCLK_PROFILE_72MHZ
+
+#if (SYSCLK_PROFILE == SYSCLK_PROFILE_180MHZ) && \
+    ((PREFETCH_ENABLE == 0U) || (INSTRUCTION_CACHE_ENABLE == 0U) || (DATA_CACHE_ENABLE == 0U))
+#error "SYSCLK_PROFILE_180MHZ needs the ART accelerator: enable prefetch and I/D caches in stm32f4xx_hal_conf.h"
+#endif
 
 /* USER CODE END Private defines */
 
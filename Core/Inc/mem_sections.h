@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file           : mem_sections.h
+  * @brief          : Placement of data in the STM32F429 RAM blocks.
+  ******************************************************************************
+  * @attention
+  *
+  * The 64 KB CCM data RAM sits on the CPU D-bus only: accesses there never
+  * compete with DMA traffic on the bus matrix and take no wait state, but the
+  * DMA controllers cannot reach it. Hot CPU-only data (parser state, lookup
+  * tables, rings filled by copy, and the MSP stack set by the linker script)
+  * goes to CCMRAM; buffers read or written by a DMA stream go to SRAM1/SRAM2.
+  * The linker script stops the build if .dmaram leaves SRAM1/SRAM2 or if
+  * CCMRAM overflows into the stack, and the DMAIdleReciever DMA functions
+  * return HAL_ERROR for a buffer in CCMRAM, e.g. on the stack.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MEM_SECTIONS_H
+#define __MEM_SECTIONS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+/** @brief Zero-initialized CPU-only data in CCMRAM (.ccmbss, cleared by the startup code) */
+#define __CCMRAM                      __attribute__((section(".ccmbss")))
+
+/** @brief Initialized CPU-only data in CCMRAM (.ccmram, copied from flash by the startup code) */
+#define __CCMRAM_DATA                 __attribute__((section(".ccmram")))
+
+/** @brief Constant lookup table in CCMRAM, copied from flash by the startup code */
+#define __CCMRAM_CONST                __attribute__((section(".ccmram.const")))
+
+/** @brief DMA buffer in SRAM1/SRAM2 (.dmaram, NOT initialized by the startup code) */
+#define __DMARAM                      __attribute__((section(".dmaram")))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_SECTIONS_H */
@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file           : nmea.h
+  * @brief          : Header for nmea.c file.
+  *                   Incremental NMEA 0183 parser.
+  ******************************************************************************
+  * @attention
+  *
+  * Bytes are fed in fragments of any size with Nmea_Parse(); the parser keeps
+  * its whole state in the handle, so a sentence may be split anywhere. Fields
+  * are decoded into integer records as they arrive and the XOR checksum is
+  * accumulated on the fly. Nmea_SentenceCallback() is only called for
+  * sentences whose checksum matched. No heap, no libc string parsing.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NMEA_H
+#define __NMEA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Longest sentence accepted, from '$' to the checksum included */
+#define NMEA_MAX_LENGTH               82U
+
+/** @brief Longest field kept for decoding, longer fields are rejected */
+#define NMEA_FIELD_MAX                15U
+
+/** @brief Scale of an empty or malformed decimal field */
+#define NMEA_DECIMAL_EMPTY            0xFFU
+
+/** @brief Satellites per GSV sentence */
+#define NMEA_GSV_SATELLITES           4U
+
+/** @brief Satellite slots per GSA sentence */
+#define NMEA_GSA_SATELLITES           12U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Sentence identifiers
+  */
+typedef enum
+{
+  NMEA_SENTENCE_UNKNOWN = 0x00U,
+  NMEA_SENTENCE_GGA     = 0x01U,
+  NMEA_SENTENCE_RMC     = 0x02U,
+  NMEA_SENTENCE_VTG     = 0x03U,
+  NMEA_SENTENCE_GSA     = 0x04U,
+  NMEA_SENTENCE_GSV     = 0x05U
+} Nmea_SentenceIdTypeDef;
+
+/** @brief SentenceMask bit of a sentence type */
+#define NMEA_SENTENCE_MASK(__ID__)    (1UL << (uint32_t)(__ID__))
+
+/** @brief SentenceMask value enabling all supported types */
+#define NMEA_SENTENCE_ALL             (NMEA_SENTENCE_MASK(NMEA_SENTENCE_GGA) | NMEA_SENTENCE_MASK(NMEA_SENTENCE_RMC) \
+                                       | NMEA_SENTENCE_MASK(NMEA_SENTENCE_VTG) | NMEA_SENTENCE_MASK(NMEA_SENTENCE_GSA) \
+                                       | NMEA_SENTENCE_MASK(NMEA_SENTENCE_GSV))
+
+/**
+  * @brief Decimal field: Value / 10^Scale
+  */
+typedef struct
+{
+  int32_t           Value;            /*!< Digits of the field, decimal point removed        */
+
+  uint8_t           Scale;            /*!< Number of fraction digits, NMEA_DECIMAL_EMPTY if null */
+} Nmea_DecimalTypeDef;
+
+/**
+  * @brief GGA - Global positioning system fix data
+  */
+typedef struct
+{
+  Nmea_DecimalTypeDef Time;           /*!< UTC hhmmss.ss                        */
+  Nmea_DecimalTypeDef Latitude;       /*!< ddmm.mmmm                            */
+  char                NS;             /*!< 'N' or 'S'                           */
+  Nmea_DecimalTypeDef Longitude;      /*!< dddmm.mmmm                           */
+  char                EW;             /*!< 'E' or 'W'                           */
+  uint8_t             Quality;        /*!< 0 invalid, 1 GPS, 2 DGPS, 4 RTK fixed, 5 RTK float */
+  uint8_t             NumSatellites;  /*!< Satellites used                      */
+  Nmea_DecimalTypeDef Hdop;           /*!< Horizontal dilution of precision     */
+  Nmea_DecimalTypeDef Altitude;       /*!< Altitude above mean sea level, m     */
+  Nmea_DecimalTypeDef GeoidSeparation; /*!< Geoid separation, m                 */
+} Nmea_GGATypeDef;
+
+/**
+  * @brief RMC - Recommended minimum specific GNSS data
+  */
+typedef struct
+{
+  Nmea_DecimalTypeDef Time;           /*!< UTC hhmmss.ss                        */
+  char                Status;         /*!< 'A' valid, 'V' warning               */
+  Nmea_DecimalTypeDef Latitude;       /*!< ddmm.mmmm                            */
+  char                NS;             /*!< 'N' or 'S'                           */
+  Nmea_DecimalTypeDef Longitude;      /*!< dddmm.mmmm                           */
+  char                EW;             /*!< 'E' or 'W'                           */
+  Nmea_DecimalTypeDef SpeedKnots;     /*!< Speed over ground, knots             */
+  Nmea_DecimalTypeDef Course;         /*!< Course over ground, degrees true     */
+  uint32_t            Date;           /*!< ddmmyy, 0 if null                    */
+  Nmea_DecimalTypeDef MagVariation;   /*!< Magnetic variation, degrees          */
+  char                MagEW;          /*!< 'E' or 'W'                           */
+  char                Mode;           /*!< 'A', 'D', 'E', 'N'... (NMEA 2.3+)     */
+} Nmea_RMCTypeDef;
+
+/**
+  * @brief VTG - Course over ground and ground speed
+  */
+typedef struct
+{
+  Nmea_DecimalTypeDef CourseTrue;     /*!< Degrees true                         */
+  Nmea_DecimalTypeDef CourseMagnetic; /*!< Degrees magnetic                     */
+  Nmea_DecimalTypeDef SpeedKnots;     /*!< Knots                                */
+  Nmea_DecimalTypeDef SpeedKmh;       /*!< km/h                                 */
+  char                Mode;           /*!< 'A', 'D', 'E', 'N'... (NMEA 2.3+)     */
+} Nmea_VTGTypeDef;
+
+/**
+  * @brief GSA - DOP and active satellites
+  */
+typedef struct
+{
+  char                SelectionMode;  /*!< 'M' manual, 'A' automatic            */
+  uint8_t             FixType;        /*!< 1 no fix, 2 2D, 3 3D                 */
+  uint16_t            Prn[NMEA_GSA_SATELLITES]; /*!< Satellites used, 0 if null */
+  Nmea_DecimalTypeDef Pdop;           /*!< Position dilution of precision       */
+  Nmea_DecimalTypeDef Hdop;           /*!< Horizontal dilution of precision     */
+  Nmea_DecimalTypeDef Vdop;           /*!< Vertical dilution of precision       */
+  uint8_t             SystemId;       /*!< GNSS system ID (NMEA 4.1+), 0 if absent */
+} Nmea_GSATypeDef;
+
+/**
+  * @brief GSV satellite entry
+  */
+typedef struct
+{
+  uint16_t            Prn;            /*!< Satellite ID                         */
+  int8_t              Elevation;      /*!< Degrees, -128 if null                */
+  uint16_t            Azimuth;        /*!< Degrees true                         */
+  int8_t              Snr;            /*!< dB-Hz, -1 if not tracked             */
+} Nmea_GSVSatelliteTypeDef;
+
+/**
+  * @brief GSV - Satellites in view
+  */
+typedef struct
+{
+  uint8_t                  NumMessages;      /*!< Total number of GSV sentences     */
+  uint8_t                  MessageNumber;    /*!< Sentence number, from 1           */
+  uint8_t                  SatellitesInView; /*!< Total satellites in view          */
+  uint8_t                  NumSatellites;    /*!< Entries filled in Satellite[]     */
+  Nmea_GSVSatelliteTypeDef Satellite[NMEA_GSV_SATELLITES];
+  uint8_t                  SignalId;         /*!< Signal ID (NMEA 4.1+), 0 if absent */
+} Nmea_GSVTypeDef;
+
+/**
+  * @brief Decoded sentence
+  */
+typedef struct
+{
+  Nmea_SentenceIdTypeDef Id;          /*!< Sentence type                         */
+
+  char                   Talker[2];   /*!< Talker ID, e.g. "GP", "GN"            */
+
+  union
+  {
+    Nmea_GGATypeDef      GGA;
+    Nmea_RMCTypeDef      RMC;
+    Nmea_VTGTypeDef      VTG;
+    Nmea_GSATypeDef      GSA;
+    Nmea_GSVTypeDef      GSV;
+  } Data;                             /*!< Record selected by Id                 */
+} Nmea_SentenceTypeDef;
+
+/**
+  * @brief Parser handle structure definition
+  */
+typedef struct
+{
+  uint8_t              State;         /*!< Parser state                                      */
+
+  uint8_t              Checksum;      /*!< XOR of the characters received after '$'          */
+
+  uint8_t              RxChecksum;    /*!< Checksum received after '*'                       */
+
+  uint8_t              Length;        /*!< Characters received since '$'                     */
+
+  uint8_t              FieldIndex;    /*!< Index of the field being received, 0 = address    */
+
+  uint8_t              FieldLength;   /*!< Characters in Field, NMEA_FIELD_MAX + 1 if too long */
+
+  char                 Field[NMEA_FIELD_MAX]; /*!< Field being received                      */
+
+  Nmea_SentenceTypeDef Sentence;      /*!< Sentence being decoded                            */
+
+  uint32_t             SentenceMask;  /*!< Types decoded, NMEA_SENTENCE_MASK() bits; others are
+                                           skipped unchecked. NMEA_SENTENCE_ALL after Nmea_Init() */
+
+  uint32_t             SentenceCount; /*!< Sentences delivered                               */
+
+  uint32_t             ChecksumErrors; /*!< Sentences rejected on checksum                   */
+
+  uint32_t             FormatErrors;  /*!< Sentences rejected on length, field or framing    */
+
+  uint32_t             IgnoredCount;  /*!< Sentences of unsupported or masked types, skipped unchecked */
+} Nmea_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Nmea_Init(Nmea_HandleTypeDef *hnmea);
+void Nmea_Parse(Nmea_HandleTypeDef *hnmea, const uint8_t *pData, uint32_t Len);
+
+void Nmea_SentenceCallback(Nmea_HandleTypeDef *hnmea, const Nmea_SentenceTypeDef *pSentence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NMEA_H */
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file           : ring_buffer.h
+  * @brief          : Header for ring_buffer.c file.
+  *                   Lock-free single-producer/single-consumer byte ring.
+  ******************************************************************************
+  * @attention
+  *
+  * One context (typically an ISR) may write and one other context (typically
+  * the main loop) may read at the same time without masking interrupts.
+  * Head is only written by the producer and Tail only by the consumer; each
+  * side publishes its index with a release store and observes the other one
+  * with an acquire load.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RING_BUFFER_H
+#define __RING_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Ring buffer handle structure definition
+  */
+typedef struct
+{
+  uint8_t           *pBuffer;       /*!< Ring storage                                          */
+
+  uint32_t          Size;           /*!< Storage size in bytes, must be a power of two         */
+
+  uint32_t          Mask;           /*!< Size - 1, used to wrap the free-running indexes       */
+
+  uint32_t          Head;           /*!< Free-running write index, owned by the producer       */
+
+  uint32_t          Tail;           /*!< Free-running read index, owned by the consumer        */
+
+  uint32_t          HighWater;      /*!< Highest fill level observed by the producer           */
+
+  uint32_t          OverflowCount;  /*!< Number of writes truncated because the ring was full  */
+
+  uint32_t          DroppedBytes;   /*!< Total number of bytes discarded by truncated writes   */
+} RingBuf_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef RingBuf_Init(RingBuf_HandleTypeDef *hring, uint8_t *pBuffer, uint32_t Size);
+
+/* Producer side */
+uint32_t RingBuf_Write(RingBuf_HandleTypeDef *hring, const uint8_t *pData, uint32_t Len);
+uint32_t RingBuf_GetFree(const RingBuf_HandleTypeDef *hring);
+uint32_t RingBuf_GetWriteIndex(const RingBuf_HandleTypeDef *hring);
+
+/* Consumer side */
+uint32_t RingBuf_Read(RingBuf_HandleTypeDef *hring, uint8_t *pData, uint32_t Len);
+uint32_t RingBuf_GetCount(const RingBuf_HandleTypeDef *hring);
+uint32_t RingBuf_GetReadIndex(const RingBuf_HandleTypeDef *hring);
+uint32_t RingBuf_Peek(const RingBuf_HandleTypeDef *hring, uint32_t Index, const uint8_t **ppData);
+void     RingBuf_ReleaseTo(RingBuf_HandleTypeDef *hring, uint32_t Index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RING_BUFFER_H */
@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : rtcm3.h
+  * @brief          : Header for rtcm3.c file.
+  *                   RTCM 3 frame parser with CRC-24Q.
+  ******************************************************************************
+  * @attention
+  *
+  * Frames are D3 <6 reserved bits, 10-bit length> <payload> <CRC-24Q:3>. The
+  * parser scans a byte stream addressed by free-running offsets, like the
+  * frame extractor, and reports each validated frame by offset and length
+  * through Rtcm3_FrameCallback(): the frame is never copied and is read in
+  * place from the buffer holding the stream (e.g. the RX ring), for as long as
+  * the owner holds those bytes.
+  * The owner feeds the bytes found at Rtcm3_GetScanOffset() and must keep all
+  * bytes from Rtcm3_GetSyncOffset() onwards available, since a false preamble
+  * is recovered by scanning again from the byte that follows it.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RTCM3_H
+#define __RTCM3_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define RTCM3_PREAMBLE                0xD3U
+
+/** @brief Preamble and length bytes */
+#define RTCM3_HEADER_LENGTH           3U
+
+/** @brief CRC-24Q bytes */
+#define RTCM3_CRC_LENGTH              3U
+
+/** @brief Largest payload allowed by the 10-bit length field */
+#define RTCM3_MAX_PAYLOAD             1023U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Parser handle structure definition
+  */
+typedef struct
+{
+  uint8_t           State;            /*!< Parser state                                     */
+
+  uint32_t          ScanOffset;       /*!< Stream offset of the next byte to scan           */
+
+  uint32_t          FrameStart;       /*!< Stream offset of the frame being validated       */
+
+  uint32_t          Remaining;        /*!< Payload and CRC bytes left in the frame          */
+
+  uint32_t          Crc;              /*!< Running CRC-24Q of the frame being validated     */
+
+  uint32_t          FrameCount;       /*!< Validated frames delivered                       */
+
+  uint32_t          CrcErrors;        /*!< Candidate frames rejected on CRC                 */
+
+  uint32_t          HeaderErrors;     /*!< Preambles rejected on non-zero reserved bits     */
+} Rtcm3_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Rtcm3_Init(Rtcm3_HandleTypeDef *hrtcm, uint32_t Offset);
+void Rtcm3_Parse(Rtcm3_HandleTypeDef *hrtcm, const uint8_t *pData, uint32_t Len);
+uint32_t Rtcm3_GetScanOffset(const Rtcm3_HandleTypeDef *hrtcm);
+uint32_t Rtcm3_GetSyncOffset(const Rtcm3_HandleTypeDef *hrtcm);
+uint32_t Rtcm3_Crc24q(uint32_t Crc, const uint8_t *pData, uint32_t Len);
+
+void Rtcm3_FrameCallback(Rtcm3_HandleTypeDef *hrtcm, uint32_t Offset, uint32_t Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTCM3_H */
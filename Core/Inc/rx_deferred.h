@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : rx_deferred.h
+  * @brief          : Header for rx_deferred.c file.
+  *                   Defers Rx Event processing from the USART/DMA ISRs to PendSV.
+  ******************************************************************************
+  * @attention
+  *
+  * The high priority ISRs only record the DMA position and the event type with
+  * RxDeferred_Post() and pend PendSV. PendSV runs at the lowest priority and
+  * calls RxDeferred_EventCallback() for every recorded event, where copying,
+  * framing and dispatch take place.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RX_DEFERRED_H
+#define __RX_DEFERRED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Number of pending Rx events, must be a power of two */
+#ifndef RX_DEFERRED_QUEUE_SIZE
+#define RX_DEFERRED_QUEUE_SIZE        16U
+#endif
+
+/** @brief Event type for application events, outside @ref DMAIdleReciever_RxEvent_Type_Values */
+#define RX_DEFERRED_EVENT_TIMEOUT     (0x00000010U)  /*!< End-of-frame timeout elapsed */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Rx event snapshot taken in interrupt context
+  */
+typedef struct
+{
+  DMAIdleReciever_HandleTypeDef          *hDMAIdleReciever;  /*!< Handle that raised the event               */
+
+  uint8_t                                *pBuffer;           /*!< Reception buffer Pos refers to             */
+
+  uint16_t                               Pos;                /*!< Position reported by the Rx Event callback */
+
+  HAL_DMAIdleReciever_RxEventTypeTypeDef EventType;          /*!< HT, TC, IDLE or RX_DEFERRED_EVENT_TIMEOUT */
+} RxDeferred_EventTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void     RxDeferred_Post(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos);
+void     RxDeferred_PostEvent(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos,
+                              HAL_DMAIdleReciever_RxEventTypeTypeDef EventType);
+void     RxDeferred_Process(void);
+uint32_t RxDeferred_GetDroppedEvents(void);
+
+void     RxDeferred_EventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pBuffer,
+                                  uint16_t Pos, HAL_DMAIdleReciever_RxEventTypeTypeDef EventType);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_DEFERRED_H */
@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file           : rx_framer.h
+  * @brief          : Header for rx_framer.c file.
+  *                   Streaming delimiter / fixed length frame extractor.
+  ******************************************************************************
+  * @attention
+  *
+  * The framer scans the received byte stream as it arrives, in fragments of
+  * any size, and queues one descriptor per complete frame. Descriptors hold
+  * the free-running stream offset of the frame, so the frame bytes can be
+  * accessed in place in the buffer they were stored in (e.g. the RX ring)
+  * rather than being copied. RxFramer_Push() is the producer side and
+  * RxFramer_GetFrame() the consumer side; they may run in different contexts.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RX_FRAMER_H
+#define __RX_FRAMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Maximum delimiter length in bytes */
+#define RXFRAMER_MAX_DELIMITER        4U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Framer configuration structure definition
+  */
+typedef struct
+{
+  uint8_t           Delimiter[RXFRAMER_MAX_DELIMITER]; /*!< Frame terminator, e.g. "\r\n"                      */
+
+  uint8_t           DelimiterLength;  /*!< Terminator length in bytes; 0 selects fixed length frames           */
+
+  uint16_t          FrameLength;      /*!< Frame length in bytes when DelimiterLength is 0                      */
+
+  uint16_t          MaxLength;        /*!< Longest accepted delimited frame, terminator included; longer data
+                                           is discarded up to the next terminator. 0 selects 65535            */
+} RxFramer_InitTypeDef;
+
+/**
+  * @brief Frame descriptor structure definition
+  */
+typedef struct
+{
+  uint32_t          Offset;           /*!< Free-running stream offset of the first frame byte */
+
+  uint16_t          Length;           /*!< Frame length in bytes, terminator included          */
+
+  uint32_t          Timestamp;        /*!< Timestamp of the fragment holding the first byte    */
+} RxFramer_FrameTypeDef;
+
+/**
+  * @brief Framer handle structure definition
+  */
+typedef struct
+{
+  RxFramer_InitTypeDef   Init;        /*!< Framing parameters                                          */
+
+  uint8_t                Border[RXFRAMER_MAX_DELIMITER]; /*!< Delimiter prefix function (KMP)          */
+
+  uint8_t                Match;       /*!< Number of delimiter bytes currently matched                 */
+
+  uint8_t                Skip;        /*!< The rest of an oversize line is discarded up to its terminator */
+
+  uint32_t               NextOffset;  /*!< Stream offset expected for the next pushed byte             */
+
+  uint32_t               FrameStart;  /*!< Stream offset of the frame being assembled                  */
+
+  uint32_t               FrameTimestamp; /*!< Timestamp of the frame being assembled                   */
+
+  RxFramer_FrameTypeDef  *pQueue;     /*!< Descriptor queue storage                                    */
+
+  uint32_t               QueueSize;   /*!< Number of descriptors, must be a power of two               */
+
+  uint32_t               QueueHead;   /*!< Free-running write index, owned by RxFramer_Push()          */
+
+  uint32_t               QueueTail;   /*!< Free-running read index, owned by RxFramer_GetFrame()       */
+
+  uint32_t               FrameCount;  /*!< Number of frames extracted                                  */
+
+  uint32_t               DroppedFrames; /*!< Frames lost because the descriptor queue was full         */
+
+  uint32_t               OversizeCount; /*!< Lines discarded because they exceeded MaxLength           */
+
+  uint32_t               ResyncCount; /*!< Partial frames discarded after a gap in the stream          */
+} RxFramer_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef RxFramer_Init(RxFramer_HandleTypeDef *hframer, RxFramer_FrameTypeDef *pQueue, uint32_t QueueSize);
+
+/* Producer side */
+void     RxFramer_Push(RxFramer_HandleTypeDef *hframer, const uint8_t *pData, uint32_t Len, uint32_t Offset,
+                       uint32_t Timestamp);
+void     RxFramer_Discard(RxFramer_HandleTypeDef *hframer);
+void     RxFramer_Flush(RxFramer_HandleTypeDef *hframer);
+
+/* Consumer side */
+uint32_t RxFramer_GetFrame(RxFramer_HandleTypeDef *hframer, RxFramer_FrameTypeDef *pFrame);
+uint32_t RxFramer_GetSyncOffset(const RxFramer_HandleTypeDef *hframer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_FRAMER_H */
@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file           : rx_merge.h
+  * @brief          : Header for rx_merge.c file.
+  *                   Time-ordered merge of frames received on several ports.
+  ******************************************************************************
+  * @attention
+  *
+  * Each source (typically one DMAIdleReciever port) pushes complete frames
+  * tagged with their arrival timestamp into its own staging ring, from its
+  * own context. RxMerge_Poll() moves them, oldest first, into a single output
+  * ring of records; the consumer reads each record in place.
+  * A frame is merged once no source can still deliver an older one: every
+  * other source has a pending frame or has reported a later timestamp
+  * (watermark). A source that stays silent delays the output by at most
+  * Window timestamp ticks; a frame that reaches the merger more than Window
+  * ticks late is still delivered, flagged RXMERGE_FLAG_LATE.
+  * Timestamps are free-running 32-bit tick counts of one common clock and
+  * are compared modulo 2^32; timestamps of one source must not decrease.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RX_MERGE_H
+#define __RX_MERGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "ring_buffer.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Record header: timestamp (4), length (2), source (1), flags (1), little endian */
+#define RXMERGE_HEADER_LENGTH         8U
+
+/** @defgroup RXMERGE_Flags Record flags
+  * @{
+  */
+#define RXMERGE_FLAG_LATE             0x01U   /*!< Older than a record already merged */
+/**
+  * @}
+  */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Merge source structure definition
+  */
+typedef struct
+{
+  RingBuf_HandleTypeDef  Ring;        /*!< Staging ring of records, written by the source only      */
+
+  __IO uint32_t          Watermark;   /*!< No frame older than this will be pushed any more         */
+
+  __IO uint8_t           Started;     /*!< Watermark is valid                                       */
+
+  uint32_t               DroppedFrames; /*!< Frames rejected because the staging ring was full      */
+} RxMerge_SourceTypeDef;
+
+/**
+  * @brief Merged record descriptor structure definition
+  */
+typedef struct
+{
+  uint32_t               Timestamp;   /*!< Arrival timestamp given by the source                    */
+
+  uint32_t               Offset;      /*!< Output ring index of the first payload byte              */
+
+  uint16_t               Length;      /*!< Payload length in bytes                                  */
+
+  uint8_t                Source;      /*!< Source index                                             */
+
+  uint8_t                Flags;       /*!< RXMERGE_FLAG_xxx                                         */
+} RxMerge_RecordTypeDef;
+
+/**
+  * @brief Merger handle structure definition
+  */
+typedef struct
+{
+  RxMerge_SourceTypeDef  *pSources;   /*!< Source array                                             */
+
+  uint32_t               NumSources;  /*!< Number of sources, at most 256                           */
+
+  RingBuf_HandleTypeDef  Output;      /*!< Merged records, in timestamp order                       */
+
+  uint32_t               Window;      /*!< Longest wait for a silent source, in timestamp ticks     */
+
+  uint32_t               LastTimestamp; /*!< Timestamp of the last merged record                    */
+
+  uint32_t               MergedCount; /*!< Records moved to the output ring                         */
+
+  uint32_t               LateCount;   /*!< Records merged out of order                              */
+} RxMerge_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef RxMerge_Init(RxMerge_HandleTypeDef *hmerge, RxMerge_SourceTypeDef *pSources, uint32_t NumSources,
+                               uint8_t *pBuffer, uint32_t Size, uint32_t Window);
+HAL_StatusTypeDef RxMerge_InitSource(RxMerge_HandleTypeDef *hmerge, uint32_t Source, uint8_t *pBuffer, uint32_t Size);
+
+/* Source side, one context per source */
+HAL_StatusTypeDef RxMerge_Push(RxMerge_HandleTypeDef *hmerge, uint32_t Source, const uint8_t *pData, uint16_t Len,
+                               uint32_t Timestamp);
+void     RxMerge_Advance(RxMerge_HandleTypeDef *hmerge, uint32_t Source, uint32_t Timestamp);
+
+/* Merger and consumer side */
+uint32_t RxMerge_Poll(RxMerge_HandleTypeDef *hmerge, uint32_t Now);
+uint32_t RxMerge_GetRecord(RxMerge_HandleTypeDef *hmerge, RxMerge_RecordTypeDef *pRecord);
+void     RxMerge_Release(RxMerge_HandleTypeDef *hmerge, const RxMerge_RecordTypeDef *pRecord);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_MERGE_H */
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file           : rx_timeout.h
+  * @brief          : Header for rx_timeout.c file.
+  *                   End-of-frame timeout in character times on a hardware timer.
+  ******************************************************************************
+  * @attention
+  *
+  * The timeout is expressed in tenths of a character time of the associated
+  * DMAIdleReciever handle (e.g. 15 or 35 for the Modbus 1.5/3.5 character
+  * gaps) and converted once to timer ticks from its BaudRate, WordLength and
+  * StopBits. The timer is driven through its registers in one-pulse mode; no
+  * HAL TIM module is required.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RX_TIMEOUT_H
+#define __RX_TIMEOUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief End-of-frame timeout handle structure definition
+  */
+typedef struct
+{
+  TIM_TypeDef                   *Instance;          /*!< Timer used to measure the gap, TIM2/TIM5 preferred (32-bit) */
+
+  DMAIdleReciever_HandleTypeDef *hDMAIdleReciever;  /*!< Receiver whose line is monitored                           */
+
+  uint32_t                      Timeout;            /*!< Gap length in tenths of a character time                   */
+
+  uint32_t                      Ticks;              /*!< Timer ticks left to wait once IDLE has been detected       */
+
+  uint32_t                      ArmedCount;         /*!< Rx DMA NDTR sampled when the timer was started             */
+
+  uint32_t                      ElapsedCount;       /*!< Number of end-of-frame timeouts reported                   */
+} RxTimeout_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef RxTimeout_Init(RxTimeout_HandleTypeDef *htimeout);
+void RxTimeout_Start(RxTimeout_HandleTypeDef *htimeout);
+void RxTimeout_Stop(RxTimeout_HandleTypeDef *htimeout);
+void RxTimeout_IRQHandler(RxTimeout_HandleTypeDef *htimeout);
+
+void RxTimeout_ElapsedCallback(RxTimeout_HandleTypeDef *htimeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_TIMEOUT_H */
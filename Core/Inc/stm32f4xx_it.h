@@ -55,10 +55,9 @@ void SVC_Handler(void);
 void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
-void USART1_IRQHandler(void);
-void DMA2_Stream2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
-
+void TIM2_IRQHandler(void);
+void FLASH_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
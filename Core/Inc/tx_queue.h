@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : tx_queue.h
+  * @brief          : Header for tx_queue.c file.
+  *                   Queue of buffers transmitted back-to-back by the Tx DMA.
+  ******************************************************************************
+  * @attention
+  *
+  * TxQueue_Send() queues a (pointer, length) descriptor and returns at once;
+  * the buffer, in flash or SRAM (not CCM RAM), is read in place by the Tx DMA
+  * stream and must stay unchanged until TxQueue_SentCallback() reports it.
+  * Descriptors are chained from the Tx DMA transfer complete interrupt with
+  * HAL_DMAIdleRecieverEx_ContinueTransmit_DMA(), so the line does not go idle
+  * between buffers. The application forwards the driver callbacks of the port:
+  * HAL_DMAIdleRecieverEx_TxDmaCpltCallback() to TxQueue_TxDmaCpltCallback(),
+  * HAL_DMAIdleReciever_TxCpltCallback() to TxQueue_TxCpltCallback() and
+  * HAL_DMAIdleReciever_ErrorCallback() to TxQueue_ErrorCallback().
+  * TxQueue_Send() may be called from any context; the queue is the only user
+  * of the transmit side of its port.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TX_QUEUE_H
+#define __TX_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Transmit descriptor structure definition
+  */
+typedef struct
+{
+  const uint8_t          *pData;      /*!< First byte, in flash or SRAM                             */
+
+  uint16_t               Len;         /*!< Number of bytes, not zero                                */
+} TxQueue_DescTypeDef;
+
+/**
+  * @brief Transmit queue handle structure definition
+  */
+typedef struct
+{
+  DMAIdleReciever_HandleTypeDef *hDMAIdleReciever; /*!< Port, with a Tx DMA stream linked            */
+
+  TxQueue_DescTypeDef    *pDesc;      /*!< Descriptor storage                                       */
+
+  uint32_t               Size;        /*!< Number of descriptors, power of two                      */
+
+  __IO uint32_t          Head;        /*!< Free-running index of the next free descriptor           */
+
+  __IO uint32_t          Tail;        /*!< Free-running index of the descriptor being transmitted   */
+
+  __IO uint32_t          Running;     /*!< A transmission is in progress                            */
+
+  uint32_t               HighWater;   /*!< Highest number of queued descriptors                     */
+
+  uint32_t               FullCount;   /*!< TxQueue_Send() calls refused on a full queue             */
+
+  uint32_t               SentBytes;   /*!< Bytes handed over to the USART                           */
+
+  uint32_t               ErrorCount;  /*!< Descriptors dropped on a DMA or USART error or an abort  */
+} TxQueue_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef TxQueue_Init(TxQueue_HandleTypeDef *htxq, DMAIdleReciever_HandleTypeDef *hDMAIdleReciever,
+                               TxQueue_DescTypeDef *pDesc, uint32_t Size);
+HAL_StatusTypeDef TxQueue_Send(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len);
+uint32_t TxQueue_GetPending(const TxQueue_HandleTypeDef *htxq);
+void     TxQueue_Abort(TxQueue_HandleTypeDef *htxq);
+
+/* Driver callbacks of the port, forwarded by the application */
+void     TxQueue_TxDmaCpltCallback(TxQueue_HandleTypeDef *htxq);
+void     TxQueue_TxCpltCallback(TxQueue_HandleTypeDef *htxq);
+void     TxQueue_ErrorCallback(TxQueue_HandleTypeDef *htxq);
+
+void     TxQueue_SentCallback(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TX_QUEUE_H */
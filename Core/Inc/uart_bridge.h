@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file           : uart_bridge.h
+  * @brief          : Header for uart_bridge.c file.
+  *                   Forwarding of the bytes received on one port to another.
+  ******************************************************************************
+  * @attention
+  *
+  * UartBridge_Forward() takes the bytes the ingress Rx DMA wrote since its
+  * last call, through HAL_DMAIdleRecieverEx_GetRxView(), and queues them on
+  * the transmit queue of the egress port. While the egress port is at least
+  * as fast as the ingress one and keeps up, each region is transmitted in
+  * place from the Rx DMA buffer and released to the Rx DMA once the egress
+  * Tx DMA has read it. Otherwise the region is copied into a staging ring,
+  * which must be DMA-readable, released at once, and the staging ring is
+  * transmitted in runs as large as possible. Bytes always leave in reception
+  * order.
+  * The bridge is the only consumer of the ingress Rx view: it is called in
+  * place of the application release, from the Rx Event context, and hands
+  * each new region to UartBridge_RxCallback() for the application to parse.
+  * The application forwards TxQueue_SentCallback() of the egress queue to
+  * UartBridge_SentCallback(); the egress queue may carry other buffers too.
+  * Ingress reception must use a circular Rx DMA.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UART_BRIDGE_H
+#define __UART_BRIDGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "ring_buffer.h"
+#include "tx_queue.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Regions transmitted in place at the same time, power of two */
+#define UARTBRIDGE_MAX_REGIONS        8U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief Region of the ingress Rx DMA buffer transmitted in place
+  */
+typedef struct
+{
+  const uint8_t          *pData;      /*!< First byte, in the ingress Rx DMA buffer                 */
+
+  uint16_t               Len;         /*!< Number of bytes                                          */
+
+  uint32_t               End;         /*!< Ingress byte count (RxConsumedCount) after the last byte */
+
+  uint32_t               Timestamp;   /*!< DWT cycle count of the Rx Event that reported it         */
+} UartBridge_RegionTypeDef;
+
+/**
+  * @brief Bridge handle structure definition
+  */
+typedef struct
+{
+  DMAIdleReciever_HandleTypeDef *hIngress; /*!< Port received with a circular Rx DMA               */
+
+  TxQueue_HandleTypeDef  *hEgress;    /*!< Transmit queue of the egress port                        */
+
+  RingBuf_HandleTypeDef  Stage;       /*!< Staging ring, in DMA-readable memory                     */
+
+  UartBridge_RegionTypeDef Region[UARTBRIDGE_MAX_REGIONS]; /*!< Regions transmitted in place       */
+
+  __IO uint32_t          RegionHead;  /*!< Free-running index of the next free region               */
+
+  __IO uint32_t          RegionTail;  /*!< Free-running index of the oldest region not yet sent     */
+
+  uint32_t               Forwarded;   /*!< Ingress byte count handed to the egress port             */
+
+  uint32_t               InPlaceQueued; /*!< Bytes queued in place                                  */
+
+  __IO uint32_t          InPlaceSent; /*!< Bytes sent in place                                      */
+
+  __IO uint32_t          StagedSent;  /*!< Bytes sent from the staging ring                         */
+
+  __IO uint32_t          StageBusy;   /*!< A staging run is queued on the egress port               */
+
+  const uint8_t          *pStageRun;  /*!< Staging run being transmitted                            */
+
+  uint32_t               StageRunTimestamp; /*!< Rx Event timestamp of the last byte of the run     */
+
+  __IO uint32_t          StageTimestamp; /*!< Rx Event timestamp of the last staged byte            */
+
+  uint32_t               LatencyLast; /*!< Rx Event to egress Tx DMA completion, last region, cycles */
+
+  uint32_t               LatencyMax;  /*!< Highest LatencyLast, cycles                              */
+
+  uint32_t               BacklogMax;  /*!< Highest UartBridge_GetBacklog() seen by UartBridge_Forward() */
+} UartBridge_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef UartBridge_Init(UartBridge_HandleTypeDef *hbridge, DMAIdleReciever_HandleTypeDef *hIngress,
+                                  TxQueue_HandleTypeDef *hEgress, uint8_t *pStage, uint32_t StageSize);
+void     UartBridge_Forward(UartBridge_HandleTypeDef *hbridge);
+uint32_t UartBridge_GetBacklog(const UartBridge_HandleTypeDef *hbridge);
+
+/* TxQueue_SentCallback() of the egress queue, forwarded by the application */
+void     UartBridge_SentCallback(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint16_t Len);
+
+void     UartBridge_RxCallback(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint32_t Len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_BRIDGE_H */
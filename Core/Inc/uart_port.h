@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file           : uart_port.h
+  * @brief          : Header for uart_port.c file.
+  *                   Registry of the U(S)ART ports received with DMA.
+  ******************************************************************************
+  * @attention
+  *
+  * UARTPORT_TABLE() maps each of the eight STM32F429 U(S)ARTs to its bus
+  * clock, GPIO alternate function and Rx DMA stream/channel (RM0090, DMA1 and
+  * DMA2 request mapping). Ports are brought up from an array of
+  * UartPort_ConfigTypeDef: UartPort_Init() fills and initializes each
+  * DMAIdleReciever handle, and HAL_DMAIdleReciever_MspInit() delegates the
+  * clock, GPIO, DMA and NVIC setup to UartPort_MspInit().
+  * The USART and DMA stream interrupt handlers of all ports are defined by
+  * expanding UARTPORT_TABLE(UARTPORT_DEFINE_IRQ_HANDLERS) in stm32f4xx_it.c;
+  * a port that is not registered keeps its interrupts disabled.
+  * Ports listed in UARTPORT_TX_TABLE() also get a Tx DMA stream, linked as
+  * hdmatx, whose handlers come from UARTPORT_TX_TABLE(UARTPORT_DEFINE_TX_IRQ_HANDLER).
+  * Two streams used twice, Rx or Tx, stop the build (duplicate case label in
+  * uart_port.c).
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UART_PORT_H
+#define __UART_PORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/**
+  * @brief Port map: X(Id, Peripheral, GPIO alternate function, APB bus,
+  *                     Rx DMA controller, Rx DMA stream, Rx DMA channel)
+  * @note  UART4/5/7/8 are named DMAIdleReciever4/5/7/8 in the device header.
+  *        USART1 and USART6 may alternatively use DMA2 stream 5 and 2.
+  */
+#define UARTPORT_TABLE(X) \
+  X(USART1, USART1,           GPIO_AF7_USART1,           2, 2, 2, DMA_CHANNEL_4) \
+  X(USART2, USART2,           GPIO_AF7_USART2,           1, 1, 5, DMA_CHANNEL_4) \
+  X(USART3, USART3,           GPIO_AF7_USART3,           1, 1, 1, DMA_CHANNEL_4) \
+  X(UART4,  DMAIdleReciever4, GPIO_AF8_DMAIdleReciever4, 1, 1, 2, DMA_CHANNEL_4) \
+  X(UART5,  DMAIdleReciever5, GPIO_AF8_DMAIdleReciever5, 1, 1, 0, DMA_CHANNEL_4) \
+  X(USART6, USART6,           GPIO_AF8_USART6,           2, 2, 1, DMA_CHANNEL_5) \
+  X(UART7,  DMAIdleReciever7, GPIO_AF8_DMAIdleReciever7, 1, 1, 3, DMA_CHANNEL_5) \
+  X(UART8,  DMAIdleReciever8, GPIO_AF8_DMAIdleReciever8, 1, 1, 6, DMA_CHANNEL_5)
+
+/**
+  * @brief Tx DMA map: X(Id, Tx DMA controller, Tx DMA stream, Tx DMA channel)
+  * @note  Tx requests (RM0090): USART1 DMA2 S7 ch4, USART2 DMA1 S6 ch4, USART3 DMA1 S3 ch4
+  *        or S4 ch7, UART4 DMA1 S4 ch4, UART5 DMA1 S7 ch4, USART6 DMA2 S6 or S7 ch5,
+  *        UART7 DMA1 S1 ch5, UART8 DMA1 S0 ch5. USART2, UART7, UART8 and USART3 on S3
+  *        collide with Rx streams of UARTPORT_TABLE, which must then be edited first.
+  */
+#define UARTPORT_TX_TABLE(X) \
+  X(USART1, 2, 7, DMA_CHANNEL_4) \
+  X(USART6, 2, 6, DMA_CHANNEL_5)
+
+/* Exported types ------------------------------------------------------------*/
+#define UARTPORT_ENUM_ENTRY(__ID__, __PERIPH__, __AF__, __APB__, __DMA__, __STREAM__, __CHANNEL__) \
+  UARTPORT_##__ID__,
+
+/**
+  * @brief Port identifiers
+  */
+typedef enum
+{
+  UARTPORT_TABLE(UARTPORT_ENUM_ENTRY)
+  UARTPORT_COUNT
+} UartPort_IdTypeDef;
+
+/**
+  * @brief Port configuration structure definition
+  */
+typedef struct
+{
+  UartPort_IdTypeDef            Id;                 /*!< Port to bring up                                           */
+
+  DMAIdleReciever_HandleTypeDef *hDMAIdleReciever;  /*!< Handle of the port, Instance and Init set by UartPort_Init */
+
+  uint32_t                      BaudRate;           /*!< Baud rate, 8 data bits, 1 stop bit, no parity              */
+
+  GPIO_TypeDef                  *TxPort;            /*!< GPIO port of the TX pin                                    */
+
+  uint16_t                      TxPin;              /*!< TX pin, GPIO_PIN_x                                         */
+
+  GPIO_TypeDef                  *RxPort;            /*!< GPIO port of the RX pin                                    */
+
+  uint16_t                      RxPin;              /*!< RX pin, GPIO_PIN_x                                         */
+
+  uint32_t                      Priority;           /*!< Preemption priority of the USART and Rx DMA interrupts     */
+
+  uint32_t                      OverSampling;       /*!< DMAIdleReciever_OVERSAMPLING_16 (0, default) or _8, which
+                                                         doubles the highest baud rate                              */
+
+  uint32_t                      RxFifo;             /*!< 0: circular Rx DMA, byte writes. 1: Normal mode Rx DMA with
+                                                         its FIFO, word writes in INC4 bursts; each IDLE or TC event
+                                                         ends the reception, to be restarted by the application      */
+} UartPort_ConfigTypeDef;
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+  * @brief Define the USART and Rx DMA stream interrupt handlers of one port.
+  * @note  Expand once, as UARTPORT_TABLE(UARTPORT_DEFINE_IRQ_HANDLERS).
+  */
+#define UARTPORT_DEFINE_IRQ_HANDLERS(__ID__, __PERIPH__, __AF__, __APB__, __DMA__, __STREAM__, __CHANNEL__) \
+  void __PERIPH__##_IRQHandler(void)                                                               \
+  {                                                                                                \
+    UartPort_IRQHandler(UARTPORT_##__ID__);                                                        \
+  }                                                                                                \
+  void DMA##__DMA__##_Stream##__STREAM__##_IRQHandler(void)                                        \
+  {                                                                                                \
+    UartPort_DMA_IRQHandler(UARTPORT_##__ID__);                                                    \
+  }
+
+/**
+  * @brief Define the Tx DMA stream interrupt handler of one port.
+  * @note  Expand once, as UARTPORT_TX_TABLE(UARTPORT_DEFINE_TX_IRQ_HANDLER).
+  */
+#define UARTPORT_DEFINE_TX_IRQ_HANDLER(__ID__, __DMA__, __STREAM__, __CHANNEL__) \
+  void DMA##__DMA__##_Stream##__STREAM__##_IRQHandler(void)                     \
+  {                                                                             \
+    UartPort_TxDMA_IRQHandler(UARTPORT_##__ID__);                               \
+  }
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef UartPort_Init(const UartPort_ConfigTypeDef *pConfig, uint32_t Count);
+HAL_StatusTypeDef UartPort_DeInit(UartPort_IdTypeDef Id);
+HAL_StatusTypeDef UartPort_SetBaudRate(UartPort_IdTypeDef Id, uint32_t BaudRate);
+DMAIdleReciever_HandleTypeDef *UartPort_GetHandle(UartPort_IdTypeDef Id);
+UartPort_IdTypeDef UartPort_GetId(const DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+
+void UartPort_MspInit(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+void UartPort_MspDeInit(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+
+void UartPort_IRQHandler(UartPort_IdTypeDef Id);
+void UartPort_DMA_IRQHandler(UartPort_IdTypeDef Id);
+void UartPort_TxDMA_IRQHandler(UartPort_IdTypeDef Id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_PORT_H */
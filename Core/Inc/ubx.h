@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file           : ubx.h
+  * @brief          : Header for ubx.c file.
+  *                   Incremental u-blox UBX binary protocol decoder.
+  ******************************************************************************
+  * @attention
+  *
+  * Frames are B5 62 <class> <id> <length:2 LE> <payload> <CK_A> <CK_B>. The
+  * decoder is fed fragments of any size with Ubx_Parse(), computes the
+  * Fletcher-8 checksum while the frame streams in and assembles the frame in
+  * the handle. A candidate frame that fails is rescanned from the byte after
+  * its B5, so a false sync in binary data does not hide the frames it covers. Valid NAV-PVT and NAV-SAT messages are decoded and passed to
+  * their callbacks; any other valid message goes to Ubx_MessageCallback().
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UBX_H
+#define __UBX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** @brief Largest payload assembled, longer frames are taken for false syncs */
+#ifndef UBX_MAX_PAYLOAD
+#define UBX_MAX_PAYLOAD               1024U
+#endif
+
+#define UBX_SYNC_CHAR_1               0xB5U
+#define UBX_SYNC_CHAR_2               0x62U
+
+/** @brief Sync characters, class, ID and length */
+#define UBX_HEADER_LENGTH             6U
+
+/** @brief CK_A and CK_B */
+#define UBX_CHECKSUM_LENGTH           2U
+
+#define UBX_CLASS_NAV                 0x01U
+#define UBX_ID_NAV_PVT                0x07U
+#define UBX_ID_NAV_SAT                0x35U
+
+#define UBX_NAV_PVT_LENGTH            92U
+#define UBX_NAV_SAT_HEADER_LENGTH     8U
+#define UBX_NAV_SAT_BLOCK_LENGTH      12U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief UBX-NAV-PVT - Navigation position velocity time solution
+  */
+typedef struct
+{
+  uint32_t          iTOW;             /*!< GPS time of week, ms                       */
+  uint16_t          Year;             /*!< UTC year                                   */
+  uint8_t           Month;            /*!< UTC month, 1..12                           */
+  uint8_t           Day;              /*!< UTC day, 1..31                             */
+  uint8_t           Hour;             /*!< UTC hour                                   */
+  uint8_t           Min;              /*!< UTC minute                                 */
+  uint8_t           Sec;              /*!< UTC second                                 */
+  uint8_t           Valid;            /*!< Validity flags (validDate, validTime...)   */
+  uint32_t          tAcc;             /*!< Time accuracy estimate, ns                 */
+  int32_t           Nano;             /*!< Fraction of second, ns                     */
+  uint8_t           FixType;          /*!< 0 no fix, 2 2D, 3 3D, 4 GNSS+DR, 5 time only */
+  uint8_t           Flags;            /*!< gnssFixOK, diffSoln, carrSoln...           */
+  uint8_t           Flags2;           /*!< confirmedAvai, confirmedDate...            */
+  uint8_t           NumSV;            /*!< Satellites used                            */
+  int32_t           Lon;              /*!< Longitude, 1e-7 deg                        */
+  int32_t           Lat;              /*!< Latitude, 1e-7 deg                         */
+  int32_t           Height;           /*!< Height above ellipsoid, mm                 */
+  int32_t           hMSL;             /*!< Height above mean sea level, mm            */
+  uint32_t          hAcc;             /*!< Horizontal accuracy estimate, mm           */
+  uint32_t          vAcc;             /*!< Vertical accuracy estimate, mm             */
+  int32_t           VelN;             /*!< NED north velocity, mm/s                   */
+  int32_t           VelE;             /*!< NED east velocity, mm/s                    */
+  int32_t           VelD;             /*!< NED down velocity, mm/s                    */
+  int32_t           gSpeed;           /*!< Ground speed, mm/s                         */
+  int32_t           HeadMot;          /*!< Heading of motion, 1e-5 deg                */
+  uint32_t          sAcc;             /*!< Speed accuracy estimate, mm/s              */
+  uint32_t          HeadAcc;          /*!< Heading accuracy estimate, 1e-5 deg        */
+  uint16_t          pDOP;             /*!< Position DOP, 0.01                         */
+  uint8_t           Flags3;           /*!< invalidLlh, lastCorrectionAge              */
+  int32_t           HeadVeh;          /*!< Heading of vehicle, 1e-5 deg               */
+  int16_t           MagDec;           /*!< Magnetic declination, 1e-2 deg             */
+  uint16_t          MagAcc;           /*!< Magnetic declination accuracy, 1e-2 deg    */
+} Ubx_NavPvtTypeDef;
+
+/**
+  * @brief UBX-NAV-SAT satellite block
+  */
+typedef struct
+{
+  uint8_t           GnssId;           /*!< GNSS identifier                            */
+  uint8_t           SvId;             /*!< Satellite identifier                       */
+  uint8_t           Cno;              /*!< Carrier to noise ratio, dB-Hz              */
+  int8_t            Elev;             /*!< Elevation, deg                             */
+  int16_t           Azim;             /*!< Azimuth, deg                               */
+  int16_t           PrRes;            /*!< Pseudorange residual, 0.1 m                */
+  uint32_t          Flags;            /*!< Quality indicator, svUsed, health...       */
+} Ubx_NavSatSvTypeDef;
+
+/**
+  * @brief UBX-NAV-SAT - Satellite information
+  */
+typedef struct
+{
+  uint32_t          iTOW;             /*!< GPS time of week, ms                       */
+  uint8_t           Version;          /*!< Message version                            */
+  uint8_t           NumSvs;           /*!< Number of satellite blocks                 */
+  const uint8_t     *pBlocks;         /*!< Raw blocks, decode with Ubx_GetNavSatSv()  */
+} Ubx_NavSatTypeDef;
+
+/**
+  * @brief Decoder handle structure definition
+  */
+typedef struct
+{
+  uint8_t           State;            /*!< Decoder state                                   */
+
+  uint8_t           Class;            /*!< Class of the frame being received               */
+
+  uint8_t           Id;               /*!< ID of the frame being received                  */
+
+  uint8_t           CkA;              /*!< Running Fletcher checksum, first byte           */
+
+  uint8_t           CkB;              /*!< Running Fletcher checksum, second byte          */
+
+  uint16_t          Length;           /*!< Payload length announced by the frame           */
+
+  uint16_t          Index;            /*!< Bytes of the candidate frame received           */
+
+  uint8_t           Frame[UBX_HEADER_LENGTH + UBX_MAX_PAYLOAD + UBX_CHECKSUM_LENGTH]; /*!< Candidate
+                                           frame from its B5, rescanned if rejected        */
+
+  uint32_t          FrameCount;       /*!< Valid frames delivered                          */
+
+  uint32_t          ChecksumErrors;   /*!< Candidate frames rejected on checksum           */
+
+  uint32_t          LengthErrors;     /*!< Candidate frames rejected because longer than
+                                           UBX_MAX_PAYLOAD, or NAV messages too short for
+                                           their type                                      */
+} Ubx_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Ubx_Init(Ubx_HandleTypeDef *hubx);
+void Ubx_Parse(Ubx_HandleTypeDef *hubx, const uint8_t *pData, uint32_t Len);
+HAL_StatusTypeDef Ubx_GetNavSatSv(const Ubx_NavSatTypeDef *pNavSat, uint32_t Index, Ubx_NavSatSvTypeDef *pSv);
+
+void Ubx_NavPvtCallback(Ubx_HandleTypeDef *hubx, const Ubx_NavPvtTypeDef *pNavPvt);
+void Ubx_NavSatCallback(Ubx_HandleTypeDef *hubx, const Ubx_NavSatTypeDef *pNavSat);
+void Ubx_MessageCallback(Ubx_HandleTypeDef *hubx, uint8_t Class, uint8_t Id, const uint8_t *pPayload, uint16_t Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UBX_H */
@@ -0,0 +1,286 @@
+/**
+  ******************************************************************************
+  * @file           : autobaud.c
+  * @brief          : Baud rate detection from the edge timing of the RX line.
+  ******************************************************************************
+  * @attention
+  *
+  * Within a character the line holds each level for 1 to 9 bit times (start
+  * bit plus eight equal data bits); longer intervals end with the stop bit
+  * and an idle line and are ignored. An interval is a whole number of bits
+  * when it is within 1/4 of a bit of one: this absorbs the EXTI latency
+  * jitter and a 1.5% rate mismatch over 9 bits, while candidates 1.5 times
+  * apart disagree by a third of a bit. A faster candidate that is a multiple
+  * of the actual rate sees only multi-bit intervals and never qualifies; a
+  * twice slower one is reset by the first run of odd length.
+  * AutoBaud_Edge() holds the whole algorithm and does not touch the hardware;
+  * it can be fed from any edge timestamp source.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "autobaud.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Longest run of equal bits inside a character */
+#define AUTOBAUD_MAX_RUN_BITS         9U
+
+/* Whole-bit margin, in eighths of a bit */
+#define AUTOBAUD_MARGIN_EIGHTHS       2U
+
+/* Defaults for the Init fields left at 0 */
+#define AUTOBAUD_DEFAULT_TOLERANCE    30000U
+#define AUTOBAUD_DEFAULT_LOCK         12U
+
+/* Private function prototypes -----------------------------------------------*/
+static void AutoBaud_ResetCandidate(AutoBaud_HandleTypeDef *habaud, uint32_t Index);
+static uint32_t AutoBaud_Qualifies(const AutoBaud_HandleTypeDef *habaud, uint32_t Index);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Check the parameters and derive the plausible interval range.
+  * @param  habaud Detection handle, Init filled.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef AutoBaud_Init(AutoBaud_HandleTypeDef *habaud)
+{
+  uint32_t max_rate = 0U;
+  uint32_t i;
+
+  if ((habaud == NULL) || (habaud->Init.pRates == NULL) || (habaud->Init.NumRates == 0U)
+      || (habaud->Init.NumRates > AUTOBAUD_MAX_RATES))
+  {
+    return HAL_ERROR;
+  }
+  if (habaud->Init.CycleClock == 0U)
+  {
+    habaud->Init.CycleClock = SystemCoreClock;
+  }
+  if (habaud->Init.Tolerance == 0U)
+  {
+    habaud->Init.Tolerance = AUTOBAUD_DEFAULT_TOLERANCE;
+  }
+  if (habaud->Init.LockIntervals == 0U)
+  {
+    habaud->Init.LockIntervals = AUTOBAUD_DEFAULT_LOCK;
+  }
+
+  for (i = 0U; i < habaud->Init.NumRates; i++)
+  {
+    /* At least 8 cycles per bit, for the whole-bit margin */
+    if ((habaud->Init.pRates[i] == 0U) || (habaud->Init.pRates[i] > (habaud->Init.CycleClock / 8U)))
+    {
+      return HAL_ERROR;
+    }
+    habaud->Bit[i] = habaud->Init.CycleClock / habaud->Init.pRates[i];
+    max_rate = (habaud->Init.pRates[i] > max_rate) ? habaud->Init.pRates[i] : max_rate;
+  }
+  habaud->MinBit = (habaud->Init.CycleClock / max_rate) / 2U;
+
+  AutoBaud_Reset(habaud);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Discard the measurements and the detected rate.
+  * @param  habaud Detection handle.
+  * @retval None
+  */
+void AutoBaud_Reset(AutoBaud_HandleTypeDef *habaud)
+{
+  uint32_t i;
+
+  habaud->Edges = 0U;
+  habaud->LastEdge = 0U;
+  for (i = 0U; i < habaud->Init.NumRates; i++)
+  {
+    AutoBaud_ResetCandidate(habaud, i);
+  }
+  habaud->BaudRate = 0U;
+}
+
+/**
+  * @brief  Process one edge of the RX line.
+  * @param  habaud Detection handle.
+  * @param  Cycles Edge timestamp, free-running 32-bit count at Init.CycleClock.
+  * @retval Detected baud rate, 0 while measuring
+  */
+uint32_t AutoBaud_Edge(AutoBaud_HandleTypeDef *habaud, uint32_t Cycles)
+{
+  uint32_t interval;
+  uint32_t bits;
+  uint32_t rem;
+  uint32_t i;
+
+  if (habaud->BaudRate != 0U)
+  {
+    return habaud->BaudRate;
+  }
+  if (habaud->Edges++ == 0U)
+  {
+    habaud->LastEdge = Cycles;
+    return 0U;
+  }
+  interval = Cycles - habaud->LastEdge;
+  habaud->LastEdge = Cycles;
+
+  /* Glitch */
+  if (interval < habaud->MinBit)
+  {
+    return 0U;
+  }
+
+  for (i = 0U; i < habaud->Init.NumRates; i++)
+  {
+    bits = (interval + (habaud->Bit[i] / 2U)) / habaud->Bit[i];
+    if (bits > AUTOBAUD_MAX_RUN_BITS)
+    {
+      /* Idle line or break, no information */
+      continue;
+    }
+    rem = (interval > (bits * habaud->Bit[i])) ? (interval - (bits * habaud->Bit[i]))
+                                               : ((bits * habaud->Bit[i]) - interval);
+    if ((bits == 0U) || ((rem * 8U) > (habaud->Bit[i] * AUTOBAUD_MARGIN_EIGHTHS)))
+    {
+      AutoBaud_ResetCandidate(habaud, i);
+      continue;
+    }
+    habaud->SumCycles[i] += interval;
+    habaud->SumBits[i] += bits;
+    habaud->Consistent[i]++;
+    if (bits == 1U)
+    {
+      habaud->SingleMask |= (1UL << i);
+    }
+  }
+
+  for (i = 0U; i < habaud->Init.NumRates; i++)
+  {
+    if ((AutoBaud_Qualifies(habaud, i) != 0U) && (habaud->Init.pRates[i] > habaud->BaudRate))
+    {
+      habaud->BaudRate = habaud->Init.pRates[i];
+    }
+  }
+  return habaud->BaudRate;
+}
+
+/**
+  * @brief  Route both edges of the RX pin to its EXTI line and start the detection.
+  * @note   Call AutoBaud_Init() first. The EXTI interrupt (EXTIx_IRQn of the
+  *         pin) is configured and enabled by the caller. The pin mode is left
+  *         untouched.
+  * @param  habaud Detection handle.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef AutoBaud_Start(AutoBaud_HandleTypeDef *habaud)
+{
+  uint32_t pos;
+
+  if ((habaud == NULL) || (habaud->Init.GPIOx == NULL) || (habaud->Init.Pin == 0U))
+  {
+    return HAL_ERROR;
+  }
+  pos = POSITION_VAL(habaud->Init.Pin);
+
+  AutoBaud_Reset(habaud);
+
+  __HAL_RCC_SYSCFG_CLK_ENABLE();
+  EXTI->IMR &= ~(uint32_t)habaud->Init.Pin;
+  MODIFY_REG(SYSCFG->EXTICR[pos >> 2U], 0x0FU << (4U * (pos & 0x03U)),
+             (uint32_t)GPIO_GET_INDEX(habaud->Init.GPIOx) << (4U * (pos & 0x03U)));
+  EXTI->RTSR |= habaud->Init.Pin;
+  EXTI->FTSR |= habaud->Init.Pin;
+  EXTI->PR = habaud->Init.Pin;
+  EXTI->IMR |= habaud->Init.Pin;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Stop the detection and release the EXTI line.
+  * @param  habaud Detection handle.
+  * @retval None
+  */
+void AutoBaud_Stop(AutoBaud_HandleTypeDef *habaud)
+{
+  EXTI->IMR &= ~(uint32_t)habaud->Init.Pin;
+  EXTI->RTSR &= ~(uint32_t)habaud->Init.Pin;
+  EXTI->FTSR &= ~(uint32_t)habaud->Init.Pin;
+  EXTI->PR = habaud->Init.Pin;
+}
+
+/**
+  * @brief  Handle the EXTI interrupt of the RX pin.
+  * @param  habaud Detection handle.
+  * @retval None
+  */
+void AutoBaud_IRQHandler(AutoBaud_HandleTypeDef *habaud)
+{
+  uint32_t now = DWT->CYCCNT;
+
+  if ((EXTI->PR & habaud->Init.Pin) == 0U)
+  {
+    return;
+  }
+  EXTI->PR = habaud->Init.Pin;
+
+  if (AutoBaud_Edge(habaud, now) != 0U)
+  {
+    AutoBaud_Stop(habaud);
+    AutoBaud_LockedCallback(habaud);
+  }
+}
+
+/**
+  * @brief  Rate detected callback, habaud->BaudRate holds the rate.
+  * @param  habaud Detection handle.
+  * @retval None
+  */
+__weak void AutoBaud_LockedCallback(AutoBaud_HandleTypeDef *habaud)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(habaud);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the AutoBaud_LockedCallback can be implemented in the user file.
+   */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Discard the intervals accumulated for one candidate.
+  * @param  habaud Detection handle.
+  * @param  Index Candidate index.
+  * @retval None
+  */
+static void AutoBaud_ResetCandidate(AutoBaud_HandleTypeDef *habaud, uint32_t Index)
+{
+  habaud->SumCycles[Index] = 0U;
+  habaud->SumBits[Index] = 0U;
+  habaud->Consistent[Index] = 0U;
+  habaud->SingleMask &= ~(1UL << Index);
+}
+
+/**
+  * @brief  Check whether a candidate can be locked on.
+  * @param  habaud Detection handle.
+  * @param  Index Candidate index.
+  * @retval 1 if enough whole-bit intervals agree on this rate, 0 otherwise
+  */
+static uint32_t AutoBaud_Qualifies(const AutoBaud_HandleTypeDef *habaud, uint32_t Index)
+{
+  uint32_t rate = habaud->Init.pRates[Index];
+  uint32_t measured;
+  uint32_t diff;
+
+  if ((habaud->Consistent[Index] < habaud->Init.LockIntervals) || ((habaud->SingleMask & (1UL << Index)) == 0U))
+  {
+    return 0U;
+  }
+  measured = (uint32_t)(((uint64_t)habaud->Init.CycleClock * habaud->SumBits[Index]) / habaud->SumCycles[Index]);
+  diff = (measured > rate) ? (measured - rate) : (rate - measured);
+
+  return ((((uint64_t)diff * 1000000U) / rate) <= habaud->Init.Tolerance) ? 1U : 0U;
+}
@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file           : baud_table.c
+  * @brief          : Achievable baud rates and CPU budget for a bus clock.
+  ******************************************************************************
+  * @attention
+  *
+  * BRR is computed with the driver's own DMAIdleReciever_BRR_SAMPLINGx()
+  * macros, so the table shows exactly what HAL_DMAIdleReciever_Init() would
+  * program. The effective divider is then read back from BRR: with OVER8 the
+  * fraction keeps 3 bits (BRR[2:0]) and the divider is 8 * USARTDIV.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "baud_table.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Start, 8 data and stop bit */
+#define BAUDTABLE_FRAME_BITS          10U
+
+/* Largest USARTDIV mantissa (BRR[15:4]) */
+#define BAUDTABLE_MANTISSA_MAX        0xFFFU
+
+/* Exported variables --------------------------------------------------------*/
+/* Common rates; the last ones need OVER8 and PCLK2 of the 180 MHz profile (90 MHz) */
+const uint32_t BaudTable_StandardRates[BAUDTABLE_NUM_STANDARD_RATES] =
+{
+  9600U, 19200U, 38400U, 57600U, 115200U, 230400U, 460800U, 921600U, 1000000U,
+  2000000U, 3000000U, 4000000U, 4500000U, 5250000U, 6000000U, 7500000U, 9000000U,
+  10500000U
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Compute the BRR value, actual rate and error for one baud rate.
+  * @param  Pclk APB clock of the U(S)ART in Hz (PCLK2 for USART1/6).
+  * @param  OverSampling DMAIdleReciever_OVERSAMPLING_8 or DMAIdleReciever_OVERSAMPLING_16.
+  * @param  BaudRate Requested baud rate.
+  * @param  pEntry Entry to fill. Requested is always set; the other fields are
+  *         zero when the rate is out of range for this clock.
+  * @retval HAL_ERROR if the rate cannot be generated (USARTDIV below 1 or
+  *         above the 12-bit mantissa), HAL_OK otherwise
+  */
+HAL_StatusTypeDef BaudTable_Compute(uint32_t Pclk, uint32_t OverSampling, uint32_t BaudRate,
+                                    BaudTable_EntryTypeDef *pEntry)
+{
+  uint32_t brr;
+  uint32_t divider;
+  uint32_t step;
+
+  if (pEntry == NULL)
+  {
+    return HAL_ERROR;
+  }
+  pEntry->Requested = BaudRate;
+  pEntry->Actual = 0U;
+  pEntry->ErrorPpm = 0;
+  pEntry->Brr = 0U;
+  pEntry->CyclesPerByte = 0U;
+
+  step = (OverSampling == DMAIdleReciever_OVERSAMPLING_8) ? 8U : 16U;
+  if ((Pclk == 0U) || (BaudRate == 0U) || (BaudRate > (Pclk / step)))
+  {
+    return HAL_ERROR;
+  }
+
+  if (OverSampling == DMAIdleReciever_OVERSAMPLING_8)
+  {
+    brr = DMAIdleReciever_BRR_SAMPLING8(Pclk, BaudRate);
+    divider = ((brr >> 4U) * 8U) + (brr & 0x07U);
+  }
+  else
+  {
+    brr = DMAIdleReciever_BRR_SAMPLING16(Pclk, BaudRate);
+    divider = brr;
+  }
+  if (((brr >> 4U) == 0U) || ((brr >> 4U) > BAUDTABLE_MANTISSA_MAX))
+  {
+    return HAL_ERROR;
+  }
+
+  pEntry->Brr = brr;
+  pEntry->Actual = (Pclk + (divider / 2U)) / divider;
+  pEntry->ErrorPpm = (int32_t)((((int64_t)Pclk * 1000000) / ((int64_t)divider * BaudRate)) - 1000000);
+  pEntry->CyclesPerByte = (uint32_t)(((uint64_t)SystemCoreClock * BAUDTABLE_FRAME_BITS * divider) / Pclk);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Fill a table for a list of baud rates.
+  * @param  Pclk APB clock of the U(S)ART in Hz.
+  * @param  OverSampling DMAIdleReciever_OVERSAMPLING_8 or DMAIdleReciever_OVERSAMPLING_16.
+  * @param  pRates Requested rates, e.g. BaudTable_StandardRates.
+  * @param  Count Number of rates.
+  * @param  pTable Table of Count entries.
+  * @retval Number of rates that can be generated
+  */
+uint32_t BaudTable_Build(uint32_t Pclk, uint32_t OverSampling, const uint32_t *pRates, uint32_t Count,
+                         BaudTable_EntryTypeDef *pTable)
+{
+  uint32_t valid = 0U;
+  uint32_t i;
+
+  if ((pRates == NULL) || (pTable == NULL))
+  {
+    return 0U;
+  }
+  for (i = 0U; i < Count; i++)
+  {
+    if (BaudTable_Compute(Pclk, OverSampling, pRates[i], &pTable[i]) == HAL_OK)
+    {
+      valid++;
+    }
+  }
+  return valid;
+}
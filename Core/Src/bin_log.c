@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file           : bin_log.c
+  * @brief          : Log records formatted on the host.
+  ******************************************************************************
+  * @attention
+  *
+  * A record is built on the stack of the caller and written to the log
+  * stream in one LogStream_Write() call, so that records from different
+  * contexts never interleave. The payload is at most 5 * (1 + BINLOG_MAX_ARGS)
+  * bytes, which the length byte always holds.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bin_log.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Sync, length and the longest payload */
+#define BINLOG_RECORD_SIZE            (2U + (5U * (1U + BINLOG_MAX_ARGS)))
+
+/* Private variables ---------------------------------------------------------*/
+static LogStream_HandleTypeDef *BinLog_Stream = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t BinLog_PutVarint(uint8_t *pDst, uint32_t Value);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Select the log stream receiving the records.
+  * @param  hlog Log stream handle, initialized, or NULL to discard records.
+  * @retval None
+  */
+void BinLog_Init(LogStream_HandleTypeDef *hlog)
+{
+  BinLog_Stream = hlog;
+}
+
+/**
+  * @brief  Encode a record and write it to the log stream. Called by BINLOG().
+  * @note   Takes a few cycles per argument byte plus LogStream_Write(), which
+  *         applies its overflow policy to the whole record.
+  * @param  Id      Identifier of the format string, its address in .binlog.
+  * @param  pArgs   Argument values.
+  * @param  NumArgs Number of arguments, at most BINLOG_MAX_ARGS.
+  * @retval Number of bytes accepted by the log stream, 0 if the record was dropped
+  */
+uint32_t BinLog_Write(uint32_t Id, const uint32_t *pArgs, uint32_t NumArgs)
+{
+  uint8_t record[BINLOG_RECORD_SIZE];
+  uint32_t len;
+  uint32_t i;
+
+  if ((BinLog_Stream == NULL) || (NumArgs > BINLOG_MAX_ARGS))
+  {
+    return 0U;
+  }
+
+  len = 2U + BinLog_PutVarint(&record[2], Id);
+  for (i = 0U; i < NumArgs; i++)
+  {
+    len += BinLog_PutVarint(&record[len], pArgs[i]);
+  }
+
+  record[0] = (uint8_t)BINLOG_SYNC;
+  record[1] = (uint8_t)(len - 2U);
+
+  return LogStream_Write(BinLog_Stream, record, len);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Store a value as a LEB128 varint.
+  * @param  pDst  Destination, room for 5 bytes.
+  * @param  Value Value.
+  * @retval Number of bytes stored, 1 to 5
+  */
+static uint32_t BinLog_PutVarint(uint8_t *pDst, uint32_t Value)
+{
+  uint32_t n = 0U;
+
+  while (Value >= 0x80U)
+  {
+    pDst[n++] = (uint8_t)(Value | 0x80U);
+    Value >>= 7;
+  }
+  pDst[n++] = (uint8_t)Value;
+
+  return n;
+}
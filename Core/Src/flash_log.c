@@ -0,0 +1,639 @@
+/**
+  ******************************************************************************
+  * @file           : flash_log.c
+  * @brief          : Append-only log of records in a ring of flash sectors.
+  ******************************************************************************
+  * @attention
+  *
+  * Words [StageTail, StageHead) of the staging ring are encoded records not
+  * yet programmed. FlashLog_Append() fills it and publishes StageHead with
+  * release semantics; the FLASH interrupt programs from StageTail and
+  * publishes it the same way. The programming state is only changed with
+  * interrupts masked, from FlashLog_Append() or after HAL_FLASH_IRQHandler()
+  * has closed the operation: chaining the next word from
+  * HAL_FLASH_EndOfOperationCallback() does not work, as the HAL clears the
+  * PG bit and the interrupt enables after that callback.
+  * Each flash word is programmed once, in address order, so a power failure
+  * leaves at most one word partially programmed: a length word that does
+  * not match its complement closes the sector, any other word is covered by
+  * the CRC of its record or by the header check.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "flash_log.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FLASHLOG_ERASED               0xFFFFFFFFU
+
+#define FLASHLOG_SR_ERRORS            (FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | \
+                                       FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR | FLASH_FLAG_RDERR)
+
+/* Sectors per bank: 4 x 16 KB, 1 x 64 KB, 7 x 128 KB */
+#define FLASHLOG_SECTORS_PER_BANK     12U
+#define FLASHLOG_BANK_SIZE            0x100000U
+
+/* Private macro -------------------------------------------------------------*/
+#define FLASHLOG_WORD(__ADDRESS__)    (*(const __IO uint32_t *)(__ADDRESS__))
+
+/* Length word of a record of __LEN__ bytes, and its check */
+#define FLASHLOG_LENGTH_WORD(__LEN__) ((uint32_t)(__LEN__) | ((~(uint32_t)(__LEN__)) << 16))
+#define FLASHLOG_IS_LENGTH_WORD(__W__) \
+  ((((__W__) >> 16) == ((~(__W__)) & 0xFFFFU)) && (((__W__) & 0xFFFFU) != 0U) \
+   && (((__W__) & 0xFFFFU) <= FLASHLOG_MAX_LENGTH))
+
+/* Words of a record of __LEN__ bytes */
+#define FLASHLOG_RECORD_WORDS(__LEN__) (FLASHLOG_RECORD_OVERHEAD + (((__LEN__) + 3U) / 4U))
+
+/* Private variables ---------------------------------------------------------*/
+/* CRC-32 (reflected polynomial 0xEDB88320), one nibble at a time */
+static const uint32_t FlashLog_CrcTable[16] =
+{
+  0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+  0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t FlashLog_SectorBase(const FlashLog_HandleTypeDef *hflog, uint32_t Index);
+static uint32_t FlashLog_SectorEnd(const FlashLog_HandleTypeDef *hflog, uint32_t Index);
+static uint32_t FlashLog_ReadHeader(const FlashLog_HandleTypeDef *hflog, uint32_t Index,
+                                    uint32_t *pSequence, uint32_t *pEraseCount);
+static uint32_t FlashLog_FindEnd(uint32_t Address, uint32_t End);
+static uint32_t FlashLog_IsErased(uint32_t Address, uint32_t End);
+static uint32_t FlashLog_Crc(uint32_t Crc, uint32_t Word);
+static void     FlashLog_Step(FlashLog_HandleTypeDef *hflog);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Find the end of the log in the reserved sectors and start erasing the
+  *         next sector if needed.
+  * @note   hflog->Init must be set, and FLASH_IRQn enabled, before the call. The
+  *         flash is left unlocked. Reads the whole next sector once to check
+  *         that it is erased.
+  * @param  hflog     Flash log handle.
+  * @param  pStage    Staging ring storage, in any RAM.
+  * @param  StageSize Staging ring size in words, a power of two holding at least
+  *                   one record of FLASHLOG_MAX_LENGTH bytes.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FlashLog_Init(FlashLog_HandleTypeDef *hflog, uint32_t *pStage, uint32_t StageSize)
+{
+  uint32_t primask;
+  uint32_t sequence;
+  uint32_t eraseCount;
+  uint32_t next;
+  uint32_t found = 0U;
+  uint32_t i;
+
+  if ((hflog == NULL) || (pStage == NULL) || ((StageSize & (StageSize - 1U)) != 0U)
+      || (StageSize < FLASHLOG_RECORD_WORDS(FLASHLOG_MAX_LENGTH))
+      || (hflog->Init.FirstSector < FLASHLOG_SECTORS_PER_BANK) || (hflog->Init.NumSectors < 2U)
+      || ((hflog->Init.FirstSector + hflog->Init.NumSectors) > FLASH_SECTOR_TOTAL))
+  {
+    return HAL_ERROR;
+  }
+
+  hflog->pStage         = pStage;
+  hflog->StageSize      = StageSize;
+  hflog->StageHead      = 0U;
+  hflog->StageTail      = 0U;
+  hflog->State          = FLASHLOG_STATE_IDLE;
+  hflog->HeaderLeft     = 0U;
+  hflog->RecordLeft     = 0U;
+  hflog->Records        = 0U;
+  hflog->DroppedRecords = 0U;
+  hflog->StageHighWater = 0U;
+  hflog->EraseStarted   = 0U;
+  hflog->ErrorCount     = 0U;
+
+  /* The current sector is the one with the highest sequence number */
+  for (i = 0U; i < hflog->Init.NumSectors; i++)
+  {
+    if ((FlashLog_ReadHeader(hflog, i, &sequence, &eraseCount) != 0U)
+        && ((found == 0U) || ((int32_t)(sequence - hflog->Sequence) > 0)))
+    {
+      found = 1U;
+      hflog->Sector     = i;
+      hflog->Sequence   = sequence;
+      hflog->EraseCount = eraseCount;
+    }
+  }
+
+  if (found != 0U)
+  {
+    hflog->SectorEnd = FlashLog_SectorEnd(hflog, hflog->Sector);
+    hflog->Address   = FlashLog_FindEnd(FlashLog_SectorBase(hflog, hflog->Sector) + (4U * FLASHLOG_HEADER_WORDS),
+                                        hflog->SectorEnd);
+  }
+  else
+  {
+    /* Blank log: the last sector is taken as full, the first record opens sector 0 */
+    hflog->Sector     = hflog->Init.NumSectors - 1U;
+    hflog->Sequence   = 0U;
+    hflog->EraseCount = 0U;
+    hflog->SectorEnd  = FlashLog_SectorEnd(hflog, hflog->Sector);
+    hflog->Address    = hflog->SectorEnd;
+  }
+
+  next = (hflog->Sector + 1U) % hflog->Init.NumSectors;
+  hflog->NextEraseCount = hflog->EraseCount;
+  hflog->NextErased = FlashLog_IsErased(FlashLog_SectorBase(hflog, next), FlashLog_SectorEnd(hflog, next));
+
+  if (HAL_FLASH_Unlock() != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASHLOG_SR_ERRORS);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  FlashLog_Step(hflog);
+  __set_PRIMASK(primask);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Append a record to the log.
+  * @note   Only encodes the record into the staging ring (a CRC step per payload
+  *         byte) and starts programming if the flash is idle.
+  * @param  hflog     Flash log handle.
+  * @param  pData     Payload, copied before the function returns.
+  * @param  Len       Payload length in bytes, 1 to FLASHLOG_MAX_LENGTH.
+  * @param  Timestamp Stored with the record, e.g. the Rx Event timestamp.
+  * @retval HAL_OK, HAL_BUSY if the staging ring is full (the record is dropped),
+  *         HAL_ERROR on a bad length or a stopped log
+  */
+HAL_StatusTypeDef FlashLog_Append(FlashLog_HandleTypeDef *hflog, const uint8_t *pData, uint32_t Len,
+                                  uint32_t Timestamp)
+{
+  uint32_t mask = hflog->StageSize - 1U;
+  uint32_t primask;
+  uint32_t words;
+  uint32_t head;
+  uint32_t used;
+  uint32_t word;
+  uint32_t crc;
+  uint32_t i;
+
+  if ((pData == NULL) || (Len == 0U) || (Len > FLASHLOG_MAX_LENGTH) || (hflog->State == FLASHLOG_STATE_ERROR))
+  {
+    return HAL_ERROR;
+  }
+
+  words = FLASHLOG_RECORD_WORDS(Len);
+  head = hflog->StageHead;
+  used = head - __atomic_load_n(&hflog->StageTail, __ATOMIC_ACQUIRE);
+  if ((used + words) > hflog->StageSize)
+  {
+    hflog->DroppedRecords++;
+    return HAL_BUSY;
+  }
+
+  word = FLASHLOG_LENGTH_WORD(Len);
+  hflog->pStage[head++ & mask] = word;
+  crc = FlashLog_Crc(0xFFFFFFFFU, word);
+  hflog->pStage[head++ & mask] = Timestamp;
+  crc = FlashLog_Crc(crc, Timestamp);
+
+  /* Payload in little-endian words, the last one padded with erased bytes */
+  for (i = 0U; i < Len; i += 4U)
+  {
+    word = FLASHLOG_ERASED;
+    memcpy(&word, &pData[i], ((Len - i) < 4U) ? (Len - i) : 4U);
+    hflog->pStage[head++ & mask] = word;
+    crc = FlashLog_Crc(crc, word);
+  }
+  hflog->pStage[head++ & mask] = ~crc;
+
+  __atomic_store_n(&hflog->StageHead, head, __ATOMIC_RELEASE);
+  hflog->Records++;
+  if ((used + words) > hflog->StageHighWater)
+  {
+    hflog->StageHighWater = used + words;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  FlashLog_Step(hflog);
+  __set_PRIMASK(primask);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Number of staged words not yet programmed.
+  * @param  hflog Flash log handle.
+  * @retval Pending words
+  */
+uint32_t FlashLog_GetPending(const FlashLog_HandleTypeDef *hflog)
+{
+  return hflog->StageHead - hflog->StageTail;
+}
+
+/**
+  * @brief  Handle the FLASH interrupt and start the next operation.
+  * @note   Calls HAL_FLASH_IRQHandler(); the HAL end of operation and error
+  *         callbacks are still called.
+  * @param  hflog Flash log handle.
+  * @retval None
+  */
+void FlashLog_IRQHandler(FlashLog_HandleTypeDef *hflog)
+{
+  uint32_t primask;
+  uint32_t sr = FLASH->SR;
+
+  HAL_FLASH_IRQHandler();
+
+  if ((sr & (FLASH_FLAG_EOP | FLASHLOG_SR_ERRORS)) == 0U)
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (hflog->State == FLASHLOG_STATE_PROGRAM)
+  {
+    if ((sr & FLASHLOG_SR_ERRORS) != 0U)
+    {
+      /* Close the sector, the rest of the record is dropped */
+      hflog->ErrorCount++;
+      __atomic_store_n(&hflog->StageTail, hflog->StageTail + hflog->RecordLeft, __ATOMIC_RELEASE);
+      hflog->RecordLeft = 0U;
+      hflog->HeaderLeft = 0U;
+      hflog->Address = hflog->SectorEnd;
+    }
+    else if (hflog->HeaderLeft > 0U)
+    {
+      hflog->HeaderLeft--;
+    }
+    else
+    {
+      hflog->Address += 4U;
+      hflog->RecordLeft--;
+      __atomic_store_n(&hflog->StageTail, hflog->StageTail + 1U, __ATOMIC_RELEASE);
+    }
+    hflog->State = FLASHLOG_STATE_IDLE;
+  }
+  else if (hflog->State == FLASHLOG_STATE_ERASE)
+  {
+    if ((sr & FLASHLOG_SR_ERRORS) != 0U)
+    {
+      hflog->ErrorCount++;
+      hflog->State = FLASHLOG_STATE_ERROR;
+    }
+    else
+    {
+      hflog->NextErased = 1U;
+      hflog->State = FLASHLOG_STATE_IDLE;
+    }
+  }
+
+  FlashLog_Step(hflog);
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Place a cursor before the oldest record of the log.
+  * @param  hflog   Flash log handle.
+  * @param  pCursor Cursor.
+  * @retval None
+  */
+void FlashLog_ResetCursor(const FlashLog_HandleTypeDef *hflog, FlashLog_CursorTypeDef *pCursor)
+{
+  UNUSED(hflog);
+
+  /* The oldest sector is looked up by the first FlashLog_ReadNext() */
+  pCursor->Sector   = 0U;
+  pCursor->Sequence = 0U;
+  pCursor->Address  = 0U;
+  pCursor->Skipped  = 0U;
+}
+
+/**
+  * @brief  Read the record after the cursor, from the oldest to the newest.
+  * @note   Reading a sector being erased would stall the CPU until the end of the
+  *         erase: HAL_BUSY is returned instead. A cursor whose sector was erased
+  *         since is moved to the oldest record.
+  * @param  hflog   Flash log handle.
+  * @param  pCursor Cursor, set by FlashLog_ResetCursor().
+  * @param  pRecord Record, pointing to its payload in flash.
+  * @retval HAL_OK, HAL_BUSY during an erase, HAL_ERROR if there is no newer
+  *         record yet
+  */
+HAL_StatusTypeDef FlashLog_ReadNext(const FlashLog_HandleTypeDef *hflog, FlashLog_CursorTypeDef *pCursor,
+                                    FlashLog_RecordTypeDef *pRecord)
+{
+  uint32_t sequence;
+  uint32_t eraseCount;
+  uint32_t current;
+  uint32_t address;
+  uint32_t limit;
+  uint32_t word;
+  uint32_t words;
+  uint32_t crc;
+  uint32_t i;
+
+  if (hflog->State == FLASHLOG_STATE_ERASE)
+  {
+    return HAL_BUSY;
+  }
+
+  for (;;)
+  {
+    if ((pCursor->Address == 0U)
+        || (FlashLog_ReadHeader(hflog, pCursor->Sector, &sequence, &eraseCount) == 0U)
+        || (sequence != pCursor->Sequence))
+    {
+      /* Oldest sector: the valid header furthest behind the current sequence number */
+      pCursor->Address = 0U;
+      for (i = 0U; i < hflog->Init.NumSectors; i++)
+      {
+        if ((FlashLog_ReadHeader(hflog, i, &sequence, &eraseCount) != 0U)
+            && ((pCursor->Address == 0U)
+                || ((hflog->Sequence - sequence) > (hflog->Sequence - pCursor->Sequence))))
+        {
+          pCursor->Sector   = i;
+          pCursor->Sequence = sequence;
+          pCursor->Address  = FlashLog_SectorBase(hflog, i) + (4U * FLASHLOG_HEADER_WORDS);
+        }
+      }
+      if (pCursor->Address == 0U)
+      {
+        return HAL_ERROR;
+      }
+    }
+
+    /* In the current sector, only words already programmed */
+    current = ((pCursor->Sector == hflog->Sector) && (pCursor->Sequence == hflog->Sequence)) ? 1U : 0U;
+    limit = (current != 0U) ? hflog->Address : FlashLog_SectorEnd(hflog, pCursor->Sector);
+
+    address = pCursor->Address;
+    word = ((address + 4U) <= limit) ? FLASHLOG_WORD(address) : FLASHLOG_ERASED;
+    if (FLASHLOG_IS_LENGTH_WORD(word) && ((address + (4U * FLASHLOG_RECORD_WORDS(word & 0xFFFFU))) <= limit))
+    {
+      words = FLASHLOG_RECORD_WORDS(word & 0xFFFFU);
+      crc = 0xFFFFFFFFU;
+      for (i = 0U; i < (words - 1U); i++)
+      {
+        crc = FlashLog_Crc(crc, FLASHLOG_WORD(address + (4U * i)));
+      }
+      pCursor->Address = address + (4U * words);
+      if (~crc == FLASHLOG_WORD(address + (4U * (words - 1U))))
+      {
+        pRecord->pData     = (const uint8_t *)(address + 8U);
+        pRecord->Len       = (uint16_t)(word & 0xFFFFU);
+        pRecord->Timestamp = FLASHLOG_WORD(address + 4U);
+        return HAL_OK;
+      }
+      pCursor->Skipped++;
+      continue;
+    }
+
+    if (current != 0U)
+    {
+      return HAL_ERROR;
+    }
+
+    /* End of a full sector: next valid one in ring order, if newer */
+    for (i = 1U; i < hflog->Init.NumSectors; i++)
+    {
+      address = (pCursor->Sector + i) % hflog->Init.NumSectors;
+      if ((FlashLog_ReadHeader(hflog, address, &sequence, &eraseCount) != 0U)
+          && ((int32_t)(sequence - pCursor->Sequence) > 0))
+      {
+        break;
+      }
+    }
+    if (i == hflog->Init.NumSectors)
+    {
+      return HAL_ERROR;
+    }
+    pCursor->Sector   = address;
+    pCursor->Sequence = sequence;
+    pCursor->Address  = FlashLog_SectorBase(hflog, address) + (4U * FLASHLOG_HEADER_WORDS);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Start the next flash operation if none is in progress: header words
+  *         of a new sector, then staged records, then the erase of the sector
+  *         after the current one once nothing is left to program.
+  * @note   Called with interrupts masked.
+  * @param  hflog Flash log handle.
+  * @retval None
+  */
+static void FlashLog_Step(FlashLog_HandleTypeDef *hflog)
+{
+  FLASH_EraseInitTypeDef erase;
+  uint32_t sequence;
+  uint32_t eraseCount;
+  uint32_t next;
+  uint32_t base;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t word;
+  uint32_t words;
+
+  if (hflog->State != FLASHLOG_STATE_IDLE)
+  {
+    return;
+  }
+
+  next = (hflog->Sector + 1U) % hflog->Init.NumSectors;
+
+  if (hflog->HeaderLeft > 0U)
+  {
+    /* Sequence number, erase count and check, then the magic word */
+    base = FlashLog_SectorBase(hflog, hflog->Sector);
+    switch (hflog->HeaderLeft)
+    {
+      case 4U:  word = hflog->Sequence;                         break;
+      case 3U:  word = hflog->EraseCount;                       break;
+      case 2U:  word = ~(hflog->Sequence ^ hflog->EraseCount);  break;
+      default:  word = FLASHLOG_MAGIC;                          break;
+    }
+    hflog->State = FLASHLOG_STATE_PROGRAM;
+    (void)HAL_FLASH_Program_IT(FLASH_TYPEPROGRAM_WORD,
+                               base + (4U * ((FLASHLOG_HEADER_WORDS + 1U - hflog->HeaderLeft) % FLASHLOG_HEADER_WORDS)),
+                               word);
+    return;
+  }
+
+  if (hflog->RecordLeft == 0U)
+  {
+    head = __atomic_load_n(&hflog->StageHead, __ATOMIC_ACQUIRE);
+    tail = hflog->StageTail;
+    if (head != tail)
+    {
+      words = FLASHLOG_RECORD_WORDS(hflog->pStage[tail & (hflog->StageSize - 1U)] & 0xFFFFU);
+      if ((hflog->Address + (4U * words)) <= hflog->SectorEnd)
+      {
+        hflog->RecordLeft = words;
+      }
+      else if (hflog->NextErased != 0U)
+      {
+        /* Open the next sector: its header goes first */
+        hflog->Sector     = next;
+        hflog->Sequence++;
+        hflog->EraseCount = hflog->NextEraseCount;
+        hflog->SectorEnd  = FlashLog_SectorEnd(hflog, next);
+        hflog->Address    = FlashLog_SectorBase(hflog, next) + (4U * FLASHLOG_HEADER_WORDS);
+        hflog->HeaderLeft = FLASHLOG_HEADER_WORDS;
+        hflog->NextErased = 0U;
+        FlashLog_Step(hflog);
+        return;
+      }
+    }
+  }
+
+  if (hflog->RecordLeft == 0U)
+  {
+    if (hflog->NextErased == 0U)
+    {
+      /* The erase count is carried over from the old header, if still valid */
+      hflog->NextEraseCount = hflog->EraseCount;
+      if (FlashLog_ReadHeader(hflog, next, &sequence, &eraseCount) != 0U)
+      {
+        hflog->NextEraseCount = eraseCount + 1U;
+      }
+
+      erase.TypeErase    = FLASH_TYPEERASE_SECTORS;
+      erase.Banks        = FLASH_BANK_2;
+      erase.Sector       = hflog->Init.FirstSector + next;
+      erase.NbSectors    = 1U;
+      erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+      hflog->State = FLASHLOG_STATE_ERASE;
+      hflog->EraseStarted++;
+      (void)HAL_FLASHEx_Erase_IT(&erase);
+    }
+    return;
+  }
+
+  hflog->State = FLASHLOG_STATE_PROGRAM;
+  (void)HAL_FLASH_Program_IT(FLASH_TYPEPROGRAM_WORD, hflog->Address,
+                             hflog->pStage[hflog->StageTail & (hflog->StageSize - 1U)]);
+}
+
+/**
+  * @brief  Address of a reserved sector.
+  * @param  hflog Flash log handle.
+  * @param  Index Sector, 0 to Init.NumSectors - 1.
+  * @retval Address of its first byte
+  */
+static uint32_t FlashLog_SectorBase(const FlashLog_HandleTypeDef *hflog, uint32_t Index)
+{
+  uint32_t sector = hflog->Init.FirstSector + Index;
+  uint32_t base = FLASH_BASE + ((sector / FLASHLOG_SECTORS_PER_BANK) * FLASHLOG_BANK_SIZE);
+
+  sector %= FLASHLOG_SECTORS_PER_BANK;
+  if (sector < 4U)
+  {
+    return base + (sector * 0x4000U);
+  }
+  return base + ((sector == 4U) ? 0x10000U : ((sector - 4U) * 0x20000U));
+}
+
+/**
+  * @brief  End of a reserved sector.
+  * @param  hflog Flash log handle.
+  * @param  Index Sector, 0 to Init.NumSectors - 1.
+  * @retval Address after its last byte
+  */
+static uint32_t FlashLog_SectorEnd(const FlashLog_HandleTypeDef *hflog, uint32_t Index)
+{
+  uint32_t sector = (hflog->Init.FirstSector + Index) % FLASHLOG_SECTORS_PER_BANK;
+  uint32_t size = (sector < 4U) ? 0x4000U : ((sector == 4U) ? 0x10000U : 0x20000U);
+
+  return FlashLog_SectorBase(hflog, Index) + size;
+}
+
+/**
+  * @brief  Check the header of a reserved sector.
+  * @param  hflog       Flash log handle.
+  * @param  Index       Sector, 0 to Init.NumSectors - 1.
+  * @param  pSequence   Sequence number, if valid.
+  * @param  pEraseCount Erase count, if valid.
+  * @retval 1 if the header is valid, 0 otherwise
+  */
+static uint32_t FlashLog_ReadHeader(const FlashLog_HandleTypeDef *hflog, uint32_t Index,
+                                    uint32_t *pSequence, uint32_t *pEraseCount)
+{
+  uint32_t base = FlashLog_SectorBase(hflog, Index);
+
+  *pSequence   = FLASHLOG_WORD(base + 4U);
+  *pEraseCount = FLASHLOG_WORD(base + 8U);
+
+  return ((FLASHLOG_WORD(base) == FLASHLOG_MAGIC)
+          && (FLASHLOG_WORD(base + 12U) == ~(*pSequence ^ *pEraseCount))) ? 1U : 0U;
+}
+
+/**
+  * @brief  Skip the records of a sector, complete or not.
+  * @param  Address First record.
+  * @param  End     End of the sector.
+  * @retval Address of the first erased word after them, End if a length word is
+  *         damaged or the sector is full
+  */
+static uint32_t FlashLog_FindEnd(uint32_t Address, uint32_t End)
+{
+  uint32_t word;
+
+  while ((Address + 4U) <= End)
+  {
+    word = FLASHLOG_WORD(Address);
+    if (word == FLASHLOG_ERASED)
+    {
+      return Address;
+    }
+    if (!FLASHLOG_IS_LENGTH_WORD(word))
+    {
+      break;
+    }
+    Address += 4U * FLASHLOG_RECORD_WORDS(word & 0xFFFFU);
+  }
+
+  return End;
+}
+
+/**
+  * @brief  Check that a range of flash is erased.
+  * @param  Address First word.
+  * @param  End     Address after the last word.
+  * @retval 1 if all words are erased, 0 otherwise
+  */
+static uint32_t FlashLog_IsErased(uint32_t Address, uint32_t End)
+{
+  for (; Address < End; Address += 4U)
+  {
+    if (FLASHLOG_WORD(Address) != FLASHLOG_ERASED)
+    {
+      return 0U;
+    }
+  }
+
+  return 1U;
+}
+
+/**
+  * @brief  Fold a word, least significant byte first, into a CRC-32.
+  * @param  Crc  CRC so far, 0xFFFFFFFF initially; the stored value is inverted.
+  * @param  Word Word.
+  * @retval Updated CRC
+  */
+static uint32_t FlashLog_Crc(uint32_t Crc, uint32_t Word)
+{
+  uint32_t i;
+
+  Crc ^= Word;
+  for (i = 0U; i < 8U; i++)
+  {
+    Crc = (Crc >> 4) ^ FlashLog_CrcTable[Crc & 0x0FU];
+  }
+
+  return Crc;
+}
@@ -0,0 +1,361 @@
+/**
+  ******************************************************************************
+  * @file           : gnss_fix.c
+  * @brief          : Fixed-point position, velocity and time conversions.
+  ******************************************************************************
+  * @attention
+  *
+  * Everything is done in 32-bit integer arithmetic: decimal fields are first
+  * brought to the scale the unit needs, then converted with constant factors
+  * rounded half away from zero. A ddmm.mmmm angle keeps all of its digits up
+  * to 1e-7 minute, below the 1e-7 degree output resolution.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "gnss_fix.h"
+#include "mem_sections.h"
+
+/* Private define ------------------------------------------------------------*/
+#define GNSSFIX_DEG7_MAX              1800000000L
+#define GNSSFIX_SPEED3_MAX            4000000L     /* 4000 knots or 4000 km/h, in 1e-3 */
+
+/* UBX-NAV-PVT flag bits */
+#define GNSSFIX_UBX_VALID_DATE        0x01U
+#define GNSSFIX_UBX_VALID_TIME        0x02U
+#define GNSSFIX_UBX_GNSS_FIX_OK       0x01U
+#define GNSSFIX_UBX_INVALID_LLH       0x01U
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t GnssFix_Pow10[10] __CCMRAM_CONST =
+{
+  1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t GnssFix_DivRound(int32_t Num, uint32_t Den);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Express a decimal field with a given number of fraction digits.
+  * @param  pField Decimal field.
+  * @param  Scale  Fraction digits of the result, 0 to 9.
+  * @param  pValue Field * 10^Scale, rounded.
+  * @retval HAL_ERROR if the field is empty or the result overflows.
+  */
+HAL_StatusTypeDef GnssFix_Rescale(const Nmea_DecimalTypeDef *pField, uint32_t Scale, int32_t *pValue)
+{
+  uint32_t m;
+  uint32_t a;
+
+  if ((pField->Scale == NMEA_DECIMAL_EMPTY) || (Scale > 9U))
+  {
+    return HAL_ERROR;
+  }
+
+  if (pField->Scale > Scale)
+  {
+    *pValue = GnssFix_DivRound(pField->Value, GnssFix_Pow10[pField->Scale - Scale]);
+    return HAL_OK;
+  }
+
+  m = GnssFix_Pow10[Scale - pField->Scale];
+  a = (pField->Value < 0) ? (0U - (uint32_t)pField->Value) : (uint32_t)pField->Value;
+  if (a > (0x7FFFFFFFU / m))
+  {
+    return HAL_ERROR;
+  }
+  *pValue = pField->Value * (int32_t)m;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Convert a ddmm.mmmm / dddmm.mmmm angle to 1e-7 degree.
+  * @param  pField     Angle field.
+  * @param  Hemisphere 'N', 'S', 'E' or 'W'; 'S' and 'W' give negative angles.
+  * @param  pDeg7      Angle, 1e-7 deg.
+  * @retval HAL_ERROR if a field is empty or out of range.
+  */
+HAL_StatusTypeDef GnssFix_ToDeg7(const Nmea_DecimalTypeDef *pField, char Hemisphere, int32_t *pDeg7)
+{
+  uint32_t value;
+  uint32_t scale = pField->Scale;
+  uint32_t unit;
+  uint32_t deg;
+  uint32_t minutes;
+  uint32_t deg7;
+
+  if ((scale == NMEA_DECIMAL_EMPTY) || (pField->Value < 0))
+  {
+    return HAL_ERROR;
+  }
+  if ((Hemisphere != 'N') && (Hemisphere != 'S') && (Hemisphere != 'E') && (Hemisphere != 'W'))
+  {
+    return HAL_ERROR;
+  }
+
+  value = (uint32_t)pField->Value;
+  if (((value / GnssFix_Pow10[scale]) % 100U) >= 60U)
+  {
+    return HAL_ERROR;
+  }
+
+  /* Minutes beyond 1e-7 do not change the result */
+  if (scale > 7U)
+  {
+    value = (uint32_t)GnssFix_DivRound((int32_t)value, GnssFix_Pow10[scale - 7U]);
+    scale = 7U;
+  }
+  unit = 100U * GnssFix_Pow10[scale];
+  deg = value / unit;
+  minutes = value % unit;
+  /* Checked before scaling, which would wrap from 430 degrees */
+  if (deg > 180U)
+  {
+    return HAL_ERROR;
+  }
+
+  /* minutes / 10^scale / 60 degree, i.e. minutes * 10^(7 - scale) / 60 in 1e-7 deg */
+  deg7 = (deg * 10000000U) + (((minutes * GnssFix_Pow10[7U - scale]) + 30U) / 60U);
+  if (deg7 > (uint32_t)GNSSFIX_DEG7_MAX)
+  {
+    return HAL_ERROR;
+  }
+
+  *pDeg7 = ((Hemisphere == 'S') || (Hemisphere == 'W')) ? -(int32_t)deg7 : (int32_t)deg7;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Convert a hhmmss.sss time to milliseconds of the day.
+  * @param  pField Time field.
+  * @param  pMs    Milliseconds since UTC midnight.
+  * @retval HAL_ERROR if the field is empty or out of range.
+  */
+HAL_StatusTypeDef GnssFix_ToTimeOfDay(const Nmea_DecimalTypeDef *pField, uint32_t *pMs)
+{
+  int32_t t;
+  uint32_t hh;
+  uint32_t mm;
+  uint32_t ms;
+
+  if ((GnssFix_Rescale(pField, 3U, &t) != HAL_OK) || (t < 0))
+  {
+    return HAL_ERROR;
+  }
+
+  hh = (uint32_t)t / 10000000U;
+  mm = ((uint32_t)t / 100000U) % 100U;
+  ms = (uint32_t)t % 100000U;
+
+  /* Second 60 is a leap second */
+  if ((hh >= 24U) || (mm >= 60U) || (ms >= 61000U))
+  {
+    return HAL_ERROR;
+  }
+
+  *pMs = (hh * 3600000U) + (mm * 60000U) + ms;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Convert a speed in knots to mm/s.
+  * @param  pField Speed field.
+  * @param  pMms   Speed, mm/s.
+  * @retval HAL_ERROR if the field is empty or out of range.
+  */
+HAL_StatusTypeDef GnssFix_KnotsToMms(const Nmea_DecimalTypeDef *pField, int32_t *pMms)
+{
+  int32_t v;
+
+  if ((GnssFix_Rescale(pField, 3U, &v) != HAL_OK) || (v > GNSSFIX_SPEED3_MAX) || (v < -GNSSFIX_SPEED3_MAX))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 1 knot = 1852 m/h = 1852000 / 3600 mm/s = 463 / 900 mm/s per 1e-3 knot */
+  *pMms = GnssFix_DivRound(v * 463, 900U);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Convert a speed in km/h to mm/s.
+  * @param  pField Speed field.
+  * @param  pMms   Speed, mm/s.
+  * @retval HAL_ERROR if the field is empty or out of range.
+  */
+HAL_StatusTypeDef GnssFix_KmhToMms(const Nmea_DecimalTypeDef *pField, int32_t *pMms)
+{
+  int32_t v;
+
+  if ((GnssFix_Rescale(pField, 3U, &v) != HAL_OK) || (v > GNSSFIX_SPEED3_MAX) || (v < -GNSSFIX_SPEED3_MAX))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 1e-3 km/h = 1 m/h = 1000 / 3600 mm/s */
+  *pMms = GnssFix_DivRound(v * 5, 18U);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Update a fix from a decoded NMEA sentence.
+  * @note   Only the quantities carried by the sentence are updated. A GGA
+  *         without fix or an RMC with status 'V' invalidates the position.
+  * @param  pFix      Fix to update.
+  * @param  pSentence Sentence delivered by Nmea_SentenceCallback().
+  * @retval None
+  */
+void GnssFix_UpdateNmea(GnssFix_TypeDef *pFix, const Nmea_SentenceTypeDef *pSentence)
+{
+  const Nmea_GGATypeDef *gga;
+  const Nmea_RMCTypeDef *rmc;
+  const Nmea_VTGTypeDef *vtg;
+  int32_t lat;
+  int32_t lon;
+  int32_t v;
+
+  switch (pSentence->Id)
+  {
+    case NMEA_SENTENCE_GGA:
+      gga = &pSentence->Data.GGA;
+      if (GnssFix_ToTimeOfDay(&gga->Time, &pFix->TimeOfDay) == HAL_OK)
+      {
+        pFix->Valid |= GNSSFIX_VALID_TIME;
+      }
+      pFix->NumSatellites = gga->NumSatellites;
+      pFix->Valid &= (uint8_t)~(GNSSFIX_VALID_POSITION | GNSSFIX_VALID_ALTITUDE);
+      if ((gga->Quality != 0U)
+          && (GnssFix_ToDeg7(&gga->Latitude, gga->NS, &lat) == HAL_OK)
+          && (GnssFix_ToDeg7(&gga->Longitude, gga->EW, &lon) == HAL_OK))
+      {
+        pFix->Latitude = lat;
+        pFix->Longitude = lon;
+        pFix->Valid |= GNSSFIX_VALID_POSITION;
+        if (GnssFix_Rescale(&gga->Altitude, 3U, &pFix->Altitude) == HAL_OK)
+        {
+          pFix->Valid |= GNSSFIX_VALID_ALTITUDE;
+        }
+      }
+      break;
+
+    case NMEA_SENTENCE_RMC:
+      rmc = &pSentence->Data.RMC;
+      if (GnssFix_ToTimeOfDay(&rmc->Time, &pFix->TimeOfDay) == HAL_OK)
+      {
+        pFix->Valid |= GNSSFIX_VALID_TIME;
+      }
+      if (rmc->Date != 0U)
+      {
+        pFix->Date = rmc->Date;
+        pFix->Valid |= GNSSFIX_VALID_DATE;
+      }
+      pFix->Valid &= (uint8_t)~(GNSSFIX_VALID_POSITION | GNSSFIX_VALID_VELOCITY);
+      if ((rmc->Status == 'A')
+          && (GnssFix_ToDeg7(&rmc->Latitude, rmc->NS, &lat) == HAL_OK)
+          && (GnssFix_ToDeg7(&rmc->Longitude, rmc->EW, &lon) == HAL_OK))
+      {
+        pFix->Latitude = lat;
+        pFix->Longitude = lon;
+        pFix->Valid |= GNSSFIX_VALID_POSITION;
+        if (GnssFix_KnotsToMms(&rmc->SpeedKnots, &v) == HAL_OK)
+        {
+          pFix->Speed = v;
+          pFix->Course = (GnssFix_Rescale(&rmc->Course, 5U, &v) == HAL_OK) ? v : 0;
+          pFix->Valid |= GNSSFIX_VALID_VELOCITY;
+        }
+      }
+      break;
+
+    case NMEA_SENTENCE_VTG:
+      vtg = &pSentence->Data.VTG;
+      if ((GnssFix_KmhToMms(&vtg->SpeedKmh, &v) == HAL_OK)
+          || (GnssFix_KnotsToMms(&vtg->SpeedKnots, &v) == HAL_OK))
+      {
+        pFix->Speed = v;
+        pFix->Course = (GnssFix_Rescale(&vtg->CourseTrue, 5U, &v) == HAL_OK) ? v : 0;
+        pFix->Valid |= GNSSFIX_VALID_VELOCITY;
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief  Update a fix from a UBX NAV-PVT message.
+  * @param  pFix    Fix to update.
+  * @param  pNavPvt Message delivered by Ubx_NavPvtCallback().
+  * @retval None
+  */
+void GnssFix_UpdateUbx(GnssFix_TypeDef *pFix, const Ubx_NavPvtTypeDef *pNavPvt)
+{
+  int32_t t;
+
+  pFix->Valid &= (uint8_t)~(GNSSFIX_VALID_POSITION | GNSSFIX_VALID_ALTITUDE | GNSSFIX_VALID_VELOCITY);
+  pFix->NumSatellites = pNavPvt->NumSV;
+
+  if ((pNavPvt->Valid & GNSSFIX_UBX_VALID_TIME) != 0U)
+  {
+    /* Nano is signed, the rounded time may cross midnight either way */
+    t = (int32_t)(((uint32_t)pNavPvt->Hour * 3600000U) + ((uint32_t)pNavPvt->Min * 60000U)
+                  + ((uint32_t)pNavPvt->Sec * 1000U))
+        + GnssFix_DivRound(pNavPvt->Nano, 1000000U);
+    if (t < 0)
+    {
+      t += (int32_t)GNSSFIX_MS_PER_DAY;
+    }
+    else if (t >= (int32_t)GNSSFIX_MS_PER_DAY)
+    {
+      t -= (int32_t)GNSSFIX_MS_PER_DAY;
+    }
+    pFix->TimeOfDay = (uint32_t)t;
+    pFix->Valid |= GNSSFIX_VALID_TIME;
+  }
+
+  if ((pNavPvt->Valid & GNSSFIX_UBX_VALID_DATE) != 0U)
+  {
+    pFix->Date = ((uint32_t)pNavPvt->Day * 10000U) + ((uint32_t)pNavPvt->Month * 100U)
+                 + ((uint32_t)pNavPvt->Year % 100U);
+    pFix->Valid |= GNSSFIX_VALID_DATE;
+  }
+
+  /* 2D, 3D or GNSS + dead reckoning */
+  if (((pNavPvt->Flags & GNSSFIX_UBX_GNSS_FIX_OK) != 0U) && ((pNavPvt->Flags3 & GNSSFIX_UBX_INVALID_LLH) == 0U)
+      && (pNavPvt->FixType >= 2U) && (pNavPvt->FixType <= 4U))
+  {
+    pFix->Latitude = pNavPvt->Lat;
+    pFix->Longitude = pNavPvt->Lon;
+    pFix->Speed = pNavPvt->gSpeed;
+    pFix->Course = pNavPvt->HeadMot;
+    pFix->Valid |= GNSSFIX_VALID_POSITION | GNSSFIX_VALID_VELOCITY;
+    if (pNavPvt->FixType != 2U)
+    {
+      pFix->Altitude = pNavPvt->hMSL;
+      pFix->Valid |= GNSSFIX_VALID_ALTITUDE;
+    }
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Signed division rounded half away from zero.
+  * @param  Num Dividend.
+  * @param  Den Divisor, not 0.
+  * @retval Quotient
+  */
+static int32_t GnssFix_DivRound(int32_t Num, uint32_t Den)
+{
+  uint32_t a = (Num < 0) ? (0U - (uint32_t)Num) : (uint32_t)Num;
+
+  a = (a + (Den / 2U)) / Den;
+
+  return (Num < 0) ? -(int32_t)a : (int32_t)a;
+}
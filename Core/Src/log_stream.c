@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file           : log_stream.c
+  * @brief          : Log byte stream drained by the Tx DMA of a port.
+  ******************************************************************************
+  * @attention
+  *
+  * Bytes [Tail, Commit) are written and wait for a run buffer, [Commit,
+  * Reserve) are claimed by writers still copying. A writer claims its space
+  * and bumps Writers in one PRIMASK section, copies, then drops Writers in
+  * another; the last writer to finish publishes Commit. Writers interrupting
+  * one another nest, so the outermost one always finishes last. Runs are
+  * filled from Tail and queued with interrupts masked, so that they reach the
+  * transmit queue in ring order whatever context fills them; dropping the
+  * oldest bytes moves Tail under the same mask.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "log_stream.h"
+
+/* Private variables ---------------------------------------------------------*/
+static LogStream_HandleTypeDef *LogStream_Stdout = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static void LogStream_Kick(LogStream_HandleTypeDef *hlog);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a log stream on top of caller provided storage.
+  * @note   hlog->Init.Overflow must be set before the call.
+  * @param  hlog     Log stream handle.
+  * @param  hTxQueue Transmit queue of the port, initialized.
+  * @param  pBuffer  Ring storage, in any RAM.
+  * @param  Size     Ring size in bytes, must be a non-zero power of two.
+  * @param  pRun     2 * LOGSTREAM_RUN_SIZE bytes in SRAM1/SRAM2, read by the Tx DMA.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef LogStream_Init(LogStream_HandleTypeDef *hlog, TxQueue_HandleTypeDef *hTxQueue,
+                                 uint8_t *pBuffer, uint32_t Size, uint8_t *pRun)
+{
+  if ((hlog == NULL) || (hTxQueue == NULL) || (pBuffer == NULL) || (Size == 0U) || ((Size & (Size - 1U)) != 0U)
+      || (pRun == NULL) || !IS_DMAIdleReciever_DMA_BUFFER(pRun) || (hlog->Init.Overflow > LOGSTREAM_OVERFLOW_BLOCK))
+  {
+    return HAL_ERROR;
+  }
+
+  hlog->hTxQueue     = hTxQueue;
+  hlog->pBuffer      = pBuffer;
+  hlog->Size         = Size;
+  hlog->pRun         = pRun;
+  hlog->Reserve      = 0U;
+  hlog->Commit       = 0U;
+  hlog->Tail         = 0U;
+  hlog->Writers      = 0U;
+  hlog->RunBusy      = 0U;
+  hlog->HighWater    = 0U;
+  hlog->SentBytes    = 0U;
+  hlog->DroppedBytes = 0U;
+  hlog->DropCount    = 0U;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Append bytes to the stream and start the Tx DMA if it is idle.
+  * @note   Takes a few hundred cycles for a short line. On a full ring, Init.Overflow
+  *         applies; a write larger than the ring is always dropped.
+  * @param  hlog  Log stream handle.
+  * @param  pData Bytes, copied before the function returns.
+  * @param  Len   Number of bytes.
+  * @retval Number of bytes accepted, Len or 0
+  */
+uint32_t LogStream_Write(LogStream_HandleTypeDef *hlog, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t primask;
+  uint32_t pos;
+  uint32_t used;
+  uint32_t drop;
+  uint32_t offset;
+  uint32_t n;
+
+  if ((pData == NULL) || (Len == 0U))
+  {
+    return 0U;
+  }
+
+  primask = __get_PRIMASK();
+  for (;;)
+  {
+    __disable_irq();
+    used = hlog->Reserve - hlog->Tail;
+    if ((used + Len) <= hlog->Size)
+    {
+      break;
+    }
+
+    /* Only published bytes still in the ring can go, not those being written */
+    if ((hlog->Init.Overflow == LOGSTREAM_OVERFLOW_DROP_OLDEST)
+        && (((hlog->Reserve - hlog->Commit) + Len) <= hlog->Size))
+    {
+      drop = (used + Len) - hlog->Size;
+      hlog->Tail += drop;
+      hlog->DroppedBytes += drop;
+      hlog->DropCount++;
+      break;
+    }
+
+    /* Waiting is only possible if the Tx DMA interrupts can run */
+    if ((hlog->Init.Overflow != LOGSTREAM_OVERFLOW_BLOCK) || (Len > hlog->Size)
+        || (primask != 0U) || (__get_IPSR() != 0U))
+    {
+      hlog->DroppedBytes += Len;
+      hlog->DropCount++;
+      __set_PRIMASK(primask);
+      return 0U;
+    }
+
+    __set_PRIMASK(primask);
+    LogStream_Kick(hlog);
+  }
+
+  pos = hlog->Reserve;
+  hlog->Reserve = pos + Len;
+  hlog->Writers++;
+  used = hlog->Reserve - hlog->Tail;
+  if (used > hlog->HighWater)
+  {
+    hlog->HighWater = used;
+  }
+  __set_PRIMASK(primask);
+
+  /* The claimed space may wrap around the end of the storage */
+  offset = pos & (hlog->Size - 1U);
+  n = hlog->Size - offset;
+  if (n > Len)
+  {
+    n = Len;
+  }
+  memcpy(&hlog->pBuffer[offset], pData, n);
+  memcpy(hlog->pBuffer, &pData[n], Len - n);
+
+  __disable_irq();
+  hlog->Writers--;
+  if (hlog->Writers == 0U)
+  {
+    hlog->Commit = hlog->Reserve;
+  }
+  __set_PRIMASK(primask);
+
+  LogStream_Kick(hlog);
+
+  return Len;
+}
+
+/**
+  * @brief  Number of bytes written and not yet handed to the Tx DMA.
+  * @param  hlog Log stream handle.
+  * @retval Pending bytes
+  */
+uint32_t LogStream_GetPending(const LogStream_HandleTypeDef *hlog)
+{
+  return hlog->Commit - hlog->Tail;
+}
+
+/**
+  * @brief  Refill a run buffer once sent. To be called from TxQueue_SentCallback()
+  *         of the port queue.
+  * @note   Buffers of other senders on the same queue are ignored, but free a
+  *         descriptor for a run that found the queue full.
+  * @param  hlog  Log stream handle.
+  * @param  pData Buffer reported by TxQueue_SentCallback().
+  * @param  Len   Number of bytes reported by TxQueue_SentCallback().
+  * @retval None
+  */
+void LogStream_SentCallback(LogStream_HandleTypeDef *hlog, const uint8_t *pData, uint16_t Len)
+{
+  uint32_t primask;
+  uint32_t i;
+
+  for (i = 0U; i < 2U; i++)
+  {
+    if (pData == &hlog->pRun[i * LOGSTREAM_RUN_SIZE])
+    {
+      primask = __get_PRIMASK();
+      __disable_irq();
+      hlog->RunBusy &= ~(1UL << i);
+      hlog->SentBytes += Len;
+      __set_PRIMASK(primask);
+    }
+  }
+
+  LogStream_Kick(hlog);
+}
+
+/**
+  * @brief  Select the stream receiving stdout and stderr.
+  * @param  hlog Log stream handle, initialized, or NULL to detach.
+  * @retval None
+  */
+void LogStream_SetStdout(LogStream_HandleTypeDef *hlog)
+{
+  LogStream_Stdout = hlog;
+}
+
+/**
+  * @brief  Write stdout or stderr bytes, from _write().
+  * @note   Bytes lost to the overflow policy are reported as written, so that
+  *         the C library does not flag the stream in error.
+  * @param  ptr Bytes.
+  * @param  len Number of bytes.
+  * @retval len, or -1 if no stream is selected
+  */
+int LogStream_WriteStdout(const char *ptr, int len)
+{
+  if (LogStream_Stdout == NULL)
+  {
+    return -1;
+  }
+
+  if (len > 0)
+  {
+    (void)LogStream_Write(LogStream_Stdout, (const uint8_t *)ptr, (uint32_t)len);
+  }
+
+  return len;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Fill the free run buffers from the ring and queue them on the port.
+  * @note   Runs with interrupts masked: at most two copies of LOGSTREAM_RUN_SIZE
+  *         bytes and two TxQueue_Send() calls. On a full transmit queue, the run
+  *         is filled again on the next write or the next buffer sent by the queue.
+  * @param  hlog Log stream handle.
+  * @retval None
+  */
+static void LogStream_Kick(LogStream_HandleTypeDef *hlog)
+{
+  uint8_t *run;
+  uint32_t primask;
+  uint32_t offset;
+  uint32_t first;
+  uint32_t n;
+  uint32_t i;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  for (i = 0U; i < 2U; i++)
+  {
+    if ((hlog->RunBusy & (1UL << i)) != 0U)
+    {
+      continue;
+    }
+
+    n = hlog->Commit - hlog->Tail;
+    if (n == 0U)
+    {
+      break;
+    }
+    if (n > LOGSTREAM_RUN_SIZE)
+    {
+      n = LOGSTREAM_RUN_SIZE;
+    }
+
+    run = &hlog->pRun[i * LOGSTREAM_RUN_SIZE];
+    offset = hlog->Tail & (hlog->Size - 1U);
+    first = hlog->Size - offset;
+    if (first > n)
+    {
+      first = n;
+    }
+    memcpy(run, &hlog->pBuffer[offset], first);
+    memcpy(&run[first], hlog->pBuffer, n - first);
+
+    /* Taken before queuing: a run the queue drops is reported at once */
+    hlog->Tail += n;
+    hlog->RunBusy |= (1UL << i);
+    if (TxQueue_Send(hlog->hTxQueue, run, (uint16_t)n) != HAL_OK)
+    {
+      hlog->Tail -= n;
+      hlog->RunBusy &= ~(1UL << i);
+      break;
+    }
+  }
+
+  __set_PRIMASK(primask);
+}
@@ -23,6 +23,23 @@
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
 #include <string.h>
+#include "ring_buffer.h"
+#include "rx_deferred.h"
+#include "rx_framer.h"
+#include "rx_timeout.h"
+#include "nmea.h"
+#include "ubx.h"
+#include "rtcm3.h"
+#include "gnss_fix.h"
+#include "uart_port.h"
+#include "baud_table.h"
+#include "autobaud.h"
+#include "mem_sections.h"
+#include "tx_queue.h"
+#include "uart_bridge.h"
+#include "log_stream.h"
+#include "bin_log.h"
+#include "flash_log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -41,49 +58,572 @@
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
-DMAIdleReciever_HandleTypeDef hDMAIdleReciever1;
-DMA_HandleTypeDef hdma_usart1_rx;
 
 /* USER CODE BEGIN PV */
-
+/* Ports are not in the .ioc: UartPort_Init() owns their handles and MSP */
+DMAIdleReciever_HandleTypeDef hDMAIdleReciever1;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
-static void MX_DMA_Init(void);
-static void MX_USART1_DMAIdleReciever_Init(void);
 /* USER CODE BEGIN PFP */
-
+#if (SYSCLK_PROFILE == SYSCLK_PROFILE_180MHZ)
+static void SystemClock_ConfigProfile(void);
+#endif
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+#if (UART_BRIDGE == 1) || (RTCM3_FORWARD == 1)
+DMAIdleReciever_HandleTypeDef hDMAIdleReciever6;
+#endif
+
+/* Serial ports, brought up by UartPort_Init(); IRQs at the TIM2 priority */
+static const UartPort_ConfigTypeDef UartPortConfig[] =
+{
+	/* Id,              Handle,             Baud,   TX,                 RX,                  Priority, Oversampling,                    Rx FIFO */
+	{ UARTPORT_USART1,  &hDMAIdleReciever1, 115200, GPIOA, GPIO_PIN_9,  GPIOA, GPIO_PIN_10, 0,        DMAIdleReciever_OVERSAMPLING_16, RX_DMA_FIFO },
+#if (UART_BRIDGE == 1) || (RTCM3_FORWARD == 1)
+	{ UARTPORT_USART6,  &hDMAIdleReciever6, 115200, GPIOC, GPIO_PIN_6,  GPIOC, GPIO_PIN_7,  0,        DMAIdleReciever_OVERSAMPLING_16, 0 },
+#endif
+};
+
+/* USART1 rates with OVER8 at the current PCLK2: actual rate, error and CPU
+   cycles per character, for inspection in the debugger */
+BaudTable_EntryTypeDef baudTable[BAUDTABLE_NUM_STANDARD_RATES] __CCMRAM;
+
 #define RXSIZE 256
-uint8_t RxData[RXSIZE];
-uint8_t FinalBuf[4096];
-uint16_t indx1 = 0, indx2=0, rxcplt=0;
-int count = 0;
-int enable_timer = 0;
-uint16_t timer = 0;
+#define RXRING_SIZE 4096
+/* Written by the Rx DMA: SRAM1/SRAM2, aligned for the INC4 word bursts of
+   RX_DMA_FIFO. The ring is read in place by the Tx DMA that forwards RTCM3
+   frames, so it is in SRAM too. Everything else the CPU alone touches per
+   byte is in CCMRAM. */
+uint8_t RxData[RXSIZE] __DMARAM __ALIGNED(16);
+uint8_t RxRingBuf[RXRING_SIZE] __DMARAM;
+RingBuf_HandleTypeDef hRxRing __CCMRAM;
+uint32_t rxLostCount = 0;
+
+#define RXFRAME_MAX_LENGTH 128
+#define RXFRAME_QUEUE_SIZE 16
+RxFramer_FrameTypeDef RxFrameQueue[RXFRAME_QUEUE_SIZE] __CCMRAM;
+RxFramer_HandleTypeDef hRxFramer __CCMRAM;
+RxTimeout_HandleTypeDef hRxTimeout __CCMRAM;
+Nmea_HandleTypeDef hNmea __CCMRAM;
+Ubx_HandleTypeDef hUbx __CCMRAM;
+Rtcm3_HandleTypeDef hRtcm3 __CCMRAM;
+GnssFix_TypeDef gnssFix __CCMRAM;
+
+/* USART1 transmissions, read in place by DMA2 Stream7 */
+#define TXQUEUE_DEPTH 16
+TxQueue_DescTypeDef TxQueueDesc[TXQUEUE_DEPTH] __CCMRAM;
+TxQueue_HandleTypeDef hTxQueue __CCMRAM;
+
+/* stdout: written into LogBuf by the CPU, copied into LogRun for DMA2 Stream7 */
+#define LOG_SIZE 2048
+uint8_t LogBuf[LOG_SIZE] __CCMRAM;
+uint8_t LogRun[2U * LOGSTREAM_RUN_SIZE] __DMARAM;
+LogStream_HandleTypeDef hLog __CCMRAM;
+
+#if (FLASH_LOG == 1)
+/* Received frames logged in flash sectors 20-23, staged in CCM RAM: 16 KB hold
+   the frames received during a sector erase (up to 2 s) at up to ~5 KB/s */
+#define FLASH_LOG_STAGE_SIZE 4096
+uint32_t FlashLogStage[FLASH_LOG_STAGE_SIZE] __CCMRAM;
+FlashLog_HandleTypeDef hFlashLog __CCMRAM;
+#endif
+
+#if (UART_BRIDGE == 1)
+/* USART1 bytes forwarded to USART6: in place from RxData, or from the staging
+   ring, both read by DMA2 Stream6. Latency and backlog are in hBridge. */
+#define BRIDGE_STAGE_SIZE 2048
+TxQueue_DescTypeDef BridgeTxQueueDesc[TXQUEUE_DEPTH] __CCMRAM;
+TxQueue_HandleTypeDef hBridgeTxQueue __CCMRAM;
+uint8_t BridgeStage[BRIDGE_STAGE_SIZE] __DMARAM;
+UartBridge_HandleTypeDef hBridge __CCMRAM;
+#endif
+
+#if (RTCM3_FORWARD == 1)
+/* Validated RTCM3 frames sent to USART6 in place from hRxRing, read by DMA2
+   Stream6. Rtcm3Held[] has the ring index of each segment queued, oldest
+   first: RxRelease() stops there until TxQueue_SentCallback() reports it. */
+TxQueue_DescTypeDef Rtcm3TxQueueDesc[TXQUEUE_DEPTH] __CCMRAM;
+TxQueue_HandleTypeDef hRtcm3TxQueue __CCMRAM;
+uint32_t Rtcm3Held[TXQUEUE_DEPTH] __CCMRAM;
+__IO uint32_t rtcm3HeldHead __CCMRAM;
+__IO uint32_t rtcm3HeldTail __CCMRAM;
+uint32_t rtcm3DroppedFrames __CCMRAM;
+#endif
+
+#if (RX_AUTOBAUD == 1)
+/* Rates GNSS receivers ship with */
+static const uint32_t AutoBaudRates[] = { 4800, 9600, 19200, 38400, 57600, 115200 };
+AutoBaud_HandleTypeDef hAutoBaud __CCMRAM;
+#endif
+
+/* Append a contiguous run of received bytes to the ring and let the framer
+   scan the bytes the ring accepted, at their ring index. UBX frames are binary
+   and not CRLF delimited: the decoder sees every received byte, ring full or
+   not, and assembles its own payload. */
+static void RxStore(const uint8_t *pData, uint32_t Len, uint32_t Timestamp)
+{
+	uint32_t index = RingBuf_GetWriteIndex(&hRxRing);
+	uint32_t n = RingBuf_Write(&hRxRing, pData, Len);
 
-void HAL_DMAIdleRecieverEx_RxEventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Size)
+	RxFramer_Push(&hRxFramer, pData, n, index, Timestamp);
+	Ubx_Parse(&hUbx, pData, Len);
+	if (n < Len)
+	{
+		/* Ring full: the frame being assembled lost bytes */
+		RxFramer_Discard(&hRxFramer);
+	}
+}
+
+/* End of the last byte of the latest Rx Event, in microseconds */
+static uint32_t RxNow(void)
+{
+	return (uint32_t)(HAL_DMAIdleRecieverEx_CyclesToNs(
+			HAL_DMAIdleRecieverEx_GetRxEventTimestamp(&hDMAIdleReciever1)) / 1000U);
+}
+
+#if (RX_DMA_FIFO == 1)
+/* Normal mode transfers alternate between the two halves of RxData: the half
+   an event reports is left alone while the DMA fills the other one */
+static uint8_t *RxHalf = RxData;
+
+static void RxRearm(void)
+{
+	RxHalf = (RxHalf == RxData) ? &RxData[RXSIZE / 2U] : RxData;
+	HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(&hDMAIdleReciever1, RxHalf, RXSIZE / 2U);
+}
+#elif (UART_BRIDGE == 1)
+/* The bridge forwards the bytes the DMA wrote into RxData and releases them
+   once USART6 has sent them, handing each new run to UartBridge_RxCallback() */
+static void RxPublish(void)
+{
+	UartBridge_Forward(&hBridge);
+}
+
+/* Runs in the RxPublish() context, the bytes are still in RxData */
+void UartBridge_RxCallback(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint32_t Len)
+{
+	UNUSED(hbridge);
+
+	if (hDMAIdleReciever1.RxLostCount != rxLostCount)
+	{
+		rxLostCount = hDMAIdleReciever1.RxLostCount;
+		RxFramer_Discard(&hRxFramer);
+	}
+	RxStore(pData, Len, RxNow());
+}
+#else
+/* Publish the bytes the DMA wrote into RxData and not yet published, read in
+   place through the driver view. Bytes the DMA overwrote before they could be
+   published are skipped and counted by the driver (RxLostCount); the framer
+   is resynchronized across such a gap. */
+static void RxPublish(void)
 {
-	memcpy (FinalBuf+indx2, RxData+indx1, Size);
-	if (Size == RXSIZE)
+	DMAIdleReciever_RxViewTypeDef view;
+	uint32_t now = RxNow();
+
+	if (HAL_DMAIdleRecieverEx_GetRxView(&hDMAIdleReciever1, &view) != HAL_OK)
+	{
+		return;
+	}
+
+	if (hDMAIdleReciever1.RxLostCount != rxLostCount)
+	{
+		rxLostCount = hDMAIdleReciever1.RxLostCount;
+		RxFramer_Discard(&hRxFramer);
+	}
+
+	if (view.Size1 != 0U)
+	{
+		RxStore(view.pData1, view.Size1, now);
+	}
+	if (view.Size2 != 0U)
+	{
+		RxStore(view.pData2, view.Size2, now);
+	}
+	(void)HAL_DMAIdleRecieverEx_ReleaseRxData(&hDMAIdleReciever1, view.Size1 + view.Size2);
+}
+#endif
+
+/* Hand one complete frame, located in hRxRing, to the application */
+static void RxProcessFrame(const RxFramer_FrameTypeDef *pFrame)
+{
+	uint32_t index = pFrame->Offset;
+	uint32_t left = pFrame->Length;
+	const uint8_t *p;
+	uint32_t n;
+#if (FLASH_LOG == 1)
+	uint8_t line[RXFRAME_MAX_LENGTH];
+	uint32_t pos = 0U;
+#endif
+
+	/* A frame crossing the end of the ring storage is seen as two segments */
+	while ((left > 0U) && ((n = RingBuf_Peek(&hRxRing, index, &p)) > 0U))
 	{
-		rxcplt++;
-		indx2 = RXSIZE*rxcplt;
-		indx1=0;
+		if (n > left)
+		{
+			n = left;
+		}
+		Nmea_Parse(&hNmea, p, n);
+#if (FLASH_LOG == 1)
+		memcpy(&line[pos], p, n);
+		pos += n;
+#endif
+		index += n;
+		left -= n;
+	}
+
+#if (FLASH_LOG == 1)
+	/* Dropped, and counted in hFlashLog.DroppedRecords, if the stage is full */
+	(void)FlashLog_Append(&hFlashLog, line, pos, pFrame->Timestamp);
+#endif
+}
+
+/* Run the RTCM3 parser over the ring bytes it has not scanned yet. Validated
+   frames are handed to Rtcm3_FrameCallback() in place in the ring. */
+static void RxScanRtcm3(void)
+{
+	const uint8_t *p;
+	uint32_t n;
+
+	while ((n = RingBuf_Peek(&hRxRing, Rtcm3_GetScanOffset(&hRtcm3), &p)) > 0U)
+	{
+		Rtcm3_Parse(&hRtcm3, p, n);
+	}
+}
+
+/* Release ring bytes up to Index, but not the RTCM3 frame being validated,
+   nor the RTCM3 frames still being forwarded. */
+static void RxRelease(uint32_t Index)
+{
+	uint32_t rtcm = Rtcm3_GetSyncOffset(&hRtcm3);
+#if (RTCM3_FORWARD == 1)
+	uint32_t tail = __atomic_load_n(&rtcm3HeldTail, __ATOMIC_ACQUIRE);
+
+	if ((tail != rtcm3HeldHead) && ((int32_t)(rtcm - Rtcm3Held[tail & (TXQUEUE_DEPTH - 1U)]) > 0))
+	{
+		rtcm = Rtcm3Held[tail & (TXQUEUE_DEPTH - 1U)];
+	}
+#endif
+
+	if ((int32_t)(Index - rtcm) > 0)
+	{
+		Index = rtcm;
+	}
+	RingBuf_ReleaseTo(&hRxRing, Index);
+}
+
+#if (RTCM3_FORWARD == 1)
+/* Runs in the main loop, from RxScanRtcm3(): queue the frame on USART6 in
+   place, as two segments if it crosses the end of the ring storage, or drop
+   it whole if the queue has no room for all of them */
+void Rtcm3_FrameCallback(Rtcm3_HandleTypeDef *hrtcm, uint32_t Offset, uint32_t Length)
+{
+	const uint8_t *seg[2];
+	uint32_t len[2];
+	uint32_t num = 1U;
+	uint32_t head;
+	uint32_t i;
+
+	UNUSED(hrtcm);
+
+	len[0] = RingBuf_Peek(&hRxRing, Offset, &seg[0]);
+	if (len[0] < Length)
+	{
+		(void)RingBuf_Peek(&hRxRing, Offset + len[0], &seg[1]);
+		len[1] = Length - len[0];
+		num = 2U;
 	}
 	else
 	{
-		indx2 = indx2 + (Size-indx1);
-		indx1 = Size;
+		len[0] = Length;
+	}
+
+	if ((TXQUEUE_DEPTH - TxQueue_GetPending(&hRtcm3TxQueue)) < num)
+	{
+		rtcm3DroppedFrames++;
+		return;
+	}
+
+	for (i = 0U; i < num; i++)
+	{
+		/* Held before it is queued: it may be sent before TxQueue_Send() returns */
+		head = rtcm3HeldHead;
+		Rtcm3Held[head & (TXQUEUE_DEPTH - 1U)] = Offset;
+		__atomic_store_n(&rtcm3HeldHead, head + 1U, __ATOMIC_RELEASE);
+		(void)TxQueue_Send(&hRtcm3TxQueue, seg[i], (uint16_t)len[i]);
+		Offset += len[i];
+	}
+}
+#endif
+
+/* Ring, framer and decoders of the USART1 bytes, the RTCM3 forwarding queue
+   and the TIM2 end-of-frame timeout. Reception itself is started by RxStart(). */
+static void RxInit(void)
+{
+	RingBuf_Init(&hRxRing, RxRingBuf, RXRING_SIZE);
+
+	hRxFramer.Init.Delimiter[0] = '\r';
+	hRxFramer.Init.Delimiter[1] = '\n';
+	hRxFramer.Init.DelimiterLength = 2;
+	hRxFramer.Init.MaxLength = RXFRAME_MAX_LENGTH;
+	RxFramer_Init(&hRxFramer, RxFrameQueue, RXFRAME_QUEUE_SIZE);
+	Nmea_Init(&hNmea);
+	Ubx_Init(&hUbx);
+	Rtcm3_Init(&hRtcm3, RingBuf_GetWriteIndex(&hRxRing));
+#if (RTCM3_FORWARD == 1)
+	if (TxQueue_Init(&hRtcm3TxQueue, &hDMAIdleReciever6, Rtcm3TxQueueDesc, TXQUEUE_DEPTH) != HAL_OK)
+	{
+		Error_Handler();
+	}
+#endif
+
+	/* TIM2 measures the end-of-frame gap, at the USART1/DMA2_Stream2 priority */
+	__HAL_RCC_TIM2_CLK_ENABLE();
+	HAL_NVIC_SetPriority(TIM2_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(TIM2_IRQn);
+	hRxTimeout.Instance = TIM2;
+	hRxTimeout.hDMAIdleReciever = &hDMAIdleReciever1;
+	hRxTimeout.Timeout = RX_EOF_TIMEOUT;
+}
+
+/* One pass of the main loop over the received bytes */
+static void RxPoll(void)
+{
+	RxFramer_FrameTypeDef frame;
+	uint32_t sync = RxFramer_GetSyncOffset(&hRxFramer);
+
+	RxScanRtcm3();
+
+	/* Frames are processed in place and released as soon as they terminate */
+	while (RxFramer_GetFrame(&hRxFramer, &frame) != 0U)
+	{
+		RxProcessFrame(&frame);
+		RxRelease(frame.Offset + frame.Length);
 	}
-	enable_timer = 1;
-	timer = 0;
 
+	/* Also drop bytes that were discarded by the framer */
+	RxRelease(sync);
+}
+
+/* Runs in USART1/DMA2_Stream2 interrupt context */
+void HAL_DMAIdleRecieverEx_RxEventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Size)
+{
+	uint32_t idle = (HAL_DMAIdleRecieverEx_GetRxEventType(hDMAIdleReciever) == HAL_DMAIdleReciever_RXEVENT_IDLE);
+#if (RX_DMA_FIFO == 1) && (RX_DEFERRED_PROCESSING == 0)
+	uint8_t *pData = RxHalf;
+#endif
+
+	if (hDMAIdleReciever->Instance != USART1)
+	{
+		return;
+	}
+
+#if (RX_DMA_FIFO == 1)
+	/* The transfer has ended and its bytes are in memory: report this half,
+	   then receive into the other one before the next byte completes */
+#if (RX_DEFERRED_PROCESSING == 1)
+	RxDeferred_Post(hDMAIdleReciever, Size);
+	RxRearm();
+#else
+	RxRearm();
+	RxStore(pData, Size, RxNow());
+#endif
+	/* Armed on the new transfer, whose counter it watches */
+	if (idle)
+	{
+		RxTimeout_Start(&hRxTimeout);
+	}
+#else
+#if (RX_DEFERRED_PROCESSING == 1)
+	RxDeferred_Post(hDMAIdleReciever, Size);
+#else
+	UNUSED(Size);
+	RxPublish();
+#endif
+
+	/* Gap measurement starts from the IDLE interrupt itself, not from PendSV.
+	   Started after the bytes are handed over: with RX_EOF_TIMEOUT <= 10 the
+	   gap is reported at once and must not discard the end of the record. */
+	if (idle)
+	{
+		RxTimeout_Start(&hRxTimeout);
+	}
+#endif
+}
+
+/* Runs in DMA2_Stream7 (USART1) or DMA2_Stream6 (USART6) interrupt context,
+   the USART still sends the last bytes */
+void HAL_DMAIdleRecieverEx_TxDmaCpltCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+	if (hDMAIdleReciever == hTxQueue.hDMAIdleReciever)
+	{
+		TxQueue_TxDmaCpltCallback(&hTxQueue);
+	}
+#if (UART_BRIDGE == 1)
+	else if (hDMAIdleReciever == hBridgeTxQueue.hDMAIdleReciever)
+	{
+		TxQueue_TxDmaCpltCallback(&hBridgeTxQueue);
+	}
+#endif
+#if (RTCM3_FORWARD == 1)
+	else if (hDMAIdleReciever == hRtcm3TxQueue.hDMAIdleReciever)
+	{
+		TxQueue_TxDmaCpltCallback(&hRtcm3TxQueue);
+	}
+#endif
+}
+
+/* Runs in USART1 or USART6 interrupt context, the line is idle */
+void HAL_DMAIdleReciever_TxCpltCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+	if (hDMAIdleReciever == hTxQueue.hDMAIdleReciever)
+	{
+		TxQueue_TxCpltCallback(&hTxQueue);
+	}
+#if (UART_BRIDGE == 1)
+	else if (hDMAIdleReciever == hBridgeTxQueue.hDMAIdleReciever)
+	{
+		TxQueue_TxCpltCallback(&hBridgeTxQueue);
+	}
+#endif
+#if (RTCM3_FORWARD == 1)
+	else if (hDMAIdleReciever == hRtcm3TxQueue.hDMAIdleReciever)
+	{
+		TxQueue_TxCpltCallback(&hRtcm3TxQueue);
+	}
+#endif
+}
+
+/* Runs in USART or DMA interrupt context, Rx errors are ignored by the queues */
+void HAL_DMAIdleReciever_ErrorCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+	if (hDMAIdleReciever == hTxQueue.hDMAIdleReciever)
+	{
+		TxQueue_ErrorCallback(&hTxQueue);
+	}
+#if (UART_BRIDGE == 1)
+	else if (hDMAIdleReciever == hBridgeTxQueue.hDMAIdleReciever)
+	{
+		TxQueue_ErrorCallback(&hBridgeTxQueue);
+	}
+#endif
+#if (RTCM3_FORWARD == 1)
+	else if (hDMAIdleReciever == hRtcm3TxQueue.hDMAIdleReciever)
+	{
+		TxQueue_ErrorCallback(&hRtcm3TxQueue);
+	}
+#endif
+}
+
+/* Runs in Tx DMA or USART interrupt context: the buffer was read by the DMA */
+void TxQueue_SentCallback(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len)
+{
+	if (htxq == &hTxQueue)
+	{
+		LogStream_SentCallback(&hLog, pData, Len);
+	}
+#if (UART_BRIDGE == 1)
+	else if (htxq == &hBridgeTxQueue)
+	{
+		UartBridge_SentCallback(&hBridge, pData, Len);
+	}
+#endif
+#if (RTCM3_FORWARD == 1)
+	else if (htxq == &hRtcm3TxQueue)
+	{
+		/* Sent, or dropped on an error: the ring is released past it */
+		__atomic_store_n(&rtcm3HeldTail, rtcm3HeldTail + 1U, __ATOMIC_RELEASE);
+	}
+#endif
+}
+
+/* Start USART1 reception at the current rate of its handle */
+static void RxStart(void)
+{
+	RxTimeout_Init(&hRxTimeout);
+#if (RX_DMA_FIFO == 1)
+	RxHalf = RxData;
+	HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(&hDMAIdleReciever1, RxHalf, RXSIZE / 2U);
+#else
+	HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(&hDMAIdleReciever1, RxData, RXSIZE);
+#endif
+}
+
+#if (RX_AUTOBAUD == 1)
+/* Runs in EXTI15_10 interrupt context, the rate is known: the characters
+   received so far at the configured rate are discarded with the abort, and
+   so is the output being transmitted */
+void AutoBaud_LockedCallback(AutoBaud_HandleTypeDef *habaud)
+{
+	if (UartPort_SetBaudRate(UARTPORT_USART1, habaud->BaudRate) == HAL_OK)
+	{
+		TxQueue_Abort(&hTxQueue);
+		RxStart();
+	}
+}
+#endif
+
+/* Runs in TIM2 interrupt context: the line stayed silent for RX_EOF_TIMEOUT */
+void RxTimeout_ElapsedCallback(RxTimeout_HandleTypeDef *htimeout)
+{
+#if (RX_DEFERRED_PROCESSING == 1)
+	RxDeferred_PostEvent(htimeout->hDMAIdleReciever, 0, RX_DEFERRED_EVENT_TIMEOUT);
+#else
+	UNUSED(htimeout);
+	/* A record still unterminated when the line goes quiet is incomplete */
+	RxFramer_Discard(&hRxFramer);
+#endif
+}
+
+#if (RX_DEFERRED_PROCESSING == 1)
+/* Runs in PendSV context, after all pending USART1/DMA2 interrupts */
+void RxDeferred_EventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pBuffer,
+		uint16_t Pos, HAL_DMAIdleReciever_RxEventTypeTypeDef EventType)
+{
+	UNUSED(hDMAIdleReciever);
+
+	if (EventType == RX_DEFERRED_EVENT_TIMEOUT)
+	{
+		/* A record still unterminated when the line goes quiet is incomplete */
+		RxFramer_Discard(&hRxFramer);
+		return;
+	}
+#if (RX_DMA_FIFO == 1)
+	/* One whole transfer, in the half of RxData it was received in */
+	RxStore(pBuffer, Pos, RxNow());
+#else
+	UNUSED(pBuffer);
+	UNUSED(Pos);
+	RxPublish();
+#endif
+}
+#endif
+
+/* Sentences are decoded from the main loop: keep the fix in integer units.
+   Masked against Ubx_NavPvtCallback(), which updates the same fix. */
+void Nmea_SentenceCallback(Nmea_HandleTypeDef *hnmea, const Nmea_SentenceTypeDef *pSentence)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	UNUSED(hnmea);
+
+	__disable_irq();
+	GnssFix_UpdateNmea(&gnssFix, pSentence);
+	__set_PRIMASK(primask);
+}
+
+/* Runs in the Rx processing context (PendSV when deferred), which preempts
+   the main loop: a UBX-only receiver gets its fix from NAV-PVT */
+void Ubx_NavPvtCallback(Ubx_HandleTypeDef *hubx, const Ubx_NavPvtTypeDef *pNavPvt)
+{
+	UNUSED(hubx);
+
+	GnssFix_UpdateUbx(&gnssFix, pNavPvt);
 }
 
 /* USER CODE END 0 */
@@ -112,17 +652,71 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+#if (SYSCLK_PROFILE == SYSCLK_PROFILE_180MHZ)
+  /* The generated config sets up the 72 MHz tree of the .ioc */
+  SystemClock_ConfigProfile();
+#endif
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
-  MX_DMA_Init();
-  MX_USART1_DMAIdleReciever_Init();
   /* USER CODE BEGIN 2 */
-
-  HAL_DMAIdleReciever_Transmit(&hDMAIdleReciever1, (uint8_t*)"Hello\r\n", 7, 1000);
-  HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(&hDMAIdleReciever1, RxData, RXSIZE);
+  if (UartPort_Init(UartPortConfig, sizeof(UartPortConfig) / sizeof(UartPortConfig[0])) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  BaudTable_Build(HAL_RCC_GetPCLK2Freq(), DMAIdleReciever_OVERSAMPLING_8, BaudTable_StandardRates,
+                  BAUDTABLE_NUM_STANDARD_RATES, baudTable);
+  if (TxQueue_Init(&hTxQueue, &hDMAIdleReciever1, TxQueueDesc, TXQUEUE_DEPTH) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  hLog.Init.Overflow = LOG_OVERFLOW;
+  if (LogStream_Init(&hLog, &hTxQueue, LogBuf, LOG_SIZE, LogRun) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  LogStream_SetStdout(&hLog);
+  BinLog_Init(&hLog);
+#if (FLASH_LOG == 1)
+  /* Flash operations complete at the lowest priority, below the Rx interrupts */
+  HAL_NVIC_SetPriority(FLASH_IRQn, 15, 0);
+  HAL_NVIC_EnableIRQ(FLASH_IRQn);
+  hFlashLog.Init.FirstSector = FLASH_SECTOR_20;
+  hFlashLog.Init.NumSectors = 4;
+  if (FlashLog_Init(&hFlashLog, FlashLogStage, FLASH_LOG_STAGE_SIZE) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
+#if (UART_BRIDGE == 1)
+  if ((TxQueue_Init(&hBridgeTxQueue, &hDMAIdleReciever6, BridgeTxQueueDesc, TXQUEUE_DEPTH) != HAL_OK)
+      || (UartBridge_Init(&hBridge, &hDMAIdleReciever1, &hBridgeTxQueue, BridgeStage, BRIDGE_STAGE_SIZE) != HAL_OK))
+  {
+    Error_Handler();
+  }
+#endif
+
+  RxInit();
+
+#if (RX_AUTOBAUD == 1)
+  /* PA10 edges are timestamped at the USART1 priority, reception starts from
+     AutoBaud_LockedCallback() */
+  hAutoBaud.Init.GPIOx = GPIOA;
+  hAutoBaud.Init.Pin = GPIO_PIN_10;
+  hAutoBaud.Init.pRates = AutoBaudRates;
+  hAutoBaud.Init.NumRates = sizeof(AutoBaudRates) / sizeof(AutoBaudRates[0]);
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+  if ((AutoBaud_Init(&hAutoBaud) != HAL_OK) || (AutoBaud_Start(&hAutoBaud) != HAL_OK))
+  {
+    Error_Handler();
+  }
+#else
+  printf("Hello\r\n");
+  BINLOG("USART1 %u baud, PCLK2 %u Hz\r\n", hDMAIdleReciever1.Init.BaudRate, HAL_RCC_GetPCLK2Freq());
+  RxStart();
+#endif
 
 
   /* USER CODE END 2 */
@@ -134,30 +728,7 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-	  if (timer >= 1000){
-		  count++;
-		  enable_timer = 0;
-		  timer=0;
-	  }
-	/* if (message_ready) {
-	  			message_ready = 0;
-
-	  			// Null-terminate for safe string handling
-	  			FinalBuf[indx] = '\0';
-
-	  			// Example: Print received GPS/NMEA data back over DMAIdleReciever
-	  			char msg[100];
-	  			snprintf(msg, sizeof(msg), "Received: %s\r\n", FinalBuf);
-	  			HAL_DMAIdleReciever_Transmit(&hDMAIdleReciever1, (uint8_t*) msg, strlen(msg),
-	  					HAL_MAX_DELAY);
-
-	  			// Reset buffer
-	  			indx = 0;
-	  			memset(FinalBuf, 0, sizeof(FinalBuf));
-	  		}
-
-	  HAL_Delay(1000);*/
-
+	  RxPoll();
   }
   /* USER CODE END 3 */
 }
@@ -207,55 +778,6 @@ void SystemClock_Config(void)
   }
 }
 
-/**
-  * @brief USART1 Initialization Function
-  * @param None
-  * @retval None
-  */
-static void MX_USART1_DMAIdleReciever_Init(void)
-{
-
-  /* USER CODE BEGIN USART1_Init 0 */
-
-  /* USER CODE END USART1_Init 0 */
-
-  /* USER CODE BEGIN USART1_Init 1 */
-
-  /* USER CODE END USART1_Init 1 */
-  hDMAIdleReciever1.Instance = USART1;
-  hDMAIdleReciever1.Init.BaudRate = 115200;
-  hDMAIdleReciever1.Init.WordLength = DMAIdleReciever_WORDLENGTH_8B;
-  hDMAIdleReciever1.Init.StopBits = DMAIdleReciever_STOPBITS_1;
-  hDMAIdleReciever1.Init.Parity = DMAIdleReciever_PARITY_NONE;
-  hDMAIdleReciever1.Init.Mode = DMAIdleReciever_MODE_TX_RX;
-  hDMAIdleReciever1.Init.HwFlowCtl = DMAIdleReciever_HWCONTROL_NONE;
-  hDMAIdleReciever1.Init.OverSampling = DMAIdleReciever_OVERSAMPLING_16;
-  if (HAL_DMAIdleReciever_Init(&hDMAIdleReciever1) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  /* USER CODE BEGIN USART1_Init 2 */
-
-  /* USER CODE END USART1_Init 2 */
-
-}
-
-/**
-  * Enable DMA controller clock
-  */
-static void MX_DMA_Init(void)
-{
-
-  /* DMA controller clock enable */
-  __HAL_RCC_DMA2_CLK_ENABLE();
-
-  /* DMA interrupt init */
-  /* DMA2_Stream2_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
-
-}
-
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -277,6 +799,65 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
+#if (SYSCLK_PROFILE == SYSCLK_PROFILE_180MHZ)
+/**
+  * @brief  Move from the generated 72 MHz tree to the 180 MHz profile.
+  * @note   The PLL cannot be reconfigured while it clocks the system, and the
+  *         regulator scale only changes with the PLL off: run from HSE
+  *         meanwhile. HAL_RCC_ClockConfig() updates SystemCoreClock and the
+  *         SysTick.
+  * @retval None
+  */
+static void SystemClock_ConfigProfile(void)
+{
+	RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+	RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+	RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_SYSCLK;
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSE;
+	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_OFF;
+	if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+	{
+		Error_Handler();
+	}
+	__HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+	/* HSE 8 MHz / 4 * 180 / 2 */
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+	RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+	RCC_OscInitStruct.PLL.PLLM = 4;
+	RCC_OscInitStruct.PLL.PLLN = 180;
+	RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+	RCC_OscInitStruct.PLL.PLLQ = 8;
+	if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	/* Over-Drive, required above 168 MHz */
+	if (HAL_PWREx_EnableOverDrive() != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+	                            |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+	RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+	RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+	{
+		Error_Handler();
+	}
+}
+#endif
 
 /* USER CODE END 4 */
 
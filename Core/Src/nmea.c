@@ -0,0 +1,544 @@
+/**
+  ******************************************************************************
+  * @file           : nmea.c
+  * @brief          : Incremental NMEA 0183 parser.
+  ******************************************************************************
+  * @attention
+  *
+  * One state per syntactic element ('$', address, fields, two checksum
+  * digits). Characters of the current field are kept in the handle until the
+  * next ',' or '*', then decoded straight into the record of the sentence;
+  * the record is only delivered once the checksum digits match. Sentences of
+  * unsupported or masked types are dropped as soon as their address is known,
+  * without decoding their fields. The address is mapped to its type by a
+  * perfect hash of the formatter into a constant table.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "nmea.h"
+#include "mem_sections.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define NMEA_STATE_IDLE               0U  /* Waiting for '$'            */
+#define NMEA_STATE_ADDRESS            1U  /* Receiving talker + type    */
+#define NMEA_STATE_FIELDS             2U  /* Receiving data fields      */
+#define NMEA_STATE_CHECKSUM_HI        3U  /* First checksum digit       */
+#define NMEA_STATE_CHECKSUM_LO        4U  /* Second checksum digit      */
+
+#define NMEA_ADDRESS_LENGTH           5U
+
+/* Supported sentence formatters, X(c1, c2, c3, Id) */
+#define NMEA_FORMATTERS(X)                                                    \
+  X('G', 'G', 'A', NMEA_SENTENCE_GGA)                                         \
+  X('R', 'M', 'C', NMEA_SENTENCE_RMC)                                         \
+  X('V', 'T', 'G', NMEA_SENTENCE_VTG)                                         \
+  X('G', 'S', 'A', NMEA_SENTENCE_GSA)                                         \
+  X('G', 'S', 'V', NMEA_SENTENCE_GSV)
+
+/* Multiplicative hash of the packed formatter into NMEA_HASH_SIZE slots. The
+   multiplier was searched offline to be collision free on NMEA_FORMATTERS;
+   Nmea_HashCheck() stops the build if a new formatter breaks that. */
+#define NMEA_HASH_BITS                4U
+#define NMEA_HASH_SIZE                (1U << NMEA_HASH_BITS)
+#define NMEA_HASH_MULTIPLIER          0x3C6EF363U
+
+/* Private macro -------------------------------------------------------------*/
+#define NMEA_KEY(__C1__, __C2__, __C3__)  (((uint32_t)(uint8_t)(__C1__) << 16) \
+                                           | ((uint32_t)(uint8_t)(__C2__) << 8) \
+                                           | (uint32_t)(uint8_t)(__C3__))
+#define NMEA_HASH(__KEY__)            ((uint32_t)((uint32_t)(__KEY__) * NMEA_HASH_MULTIPLIER) >> (32U - NMEA_HASH_BITS))
+
+#define NMEA_TABLE_ENTRY(__C1__, __C2__, __C3__, __ID__) \
+  [NMEA_HASH(NMEA_KEY(__C1__, __C2__, __C3__))] = { NMEA_KEY(__C1__, __C2__, __C3__), (__ID__) },
+#define NMEA_HASH_CASE(__C1__, __C2__, __C3__, __ID__) \
+  case NMEA_HASH(NMEA_KEY(__C1__, __C2__, __C3__)):
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t               Key;         /* Packed formatter, 0 for an empty slot */
+  Nmea_SentenceIdTypeDef Id;
+} Nmea_FormatterTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const Nmea_FormatterTypeDef Nmea_FormatterTable[NMEA_HASH_SIZE] __CCMRAM_CONST =
+{
+  NMEA_FORMATTERS(NMEA_TABLE_ENTRY)
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static Nmea_SentenceIdTypeDef Nmea_Identify(const char *pAddress);
+static void     Nmea_CommitField(Nmea_HandleTypeDef *hnmea);
+static void     Nmea_Finalize(Nmea_HandleTypeDef *hnmea);
+static void     Nmea_ParseDecimal(const char *p, uint32_t n, Nmea_DecimalTypeDef *pDecimal);
+static uint32_t Nmea_ParseUInt(const char *p, uint32_t n);
+static int32_t  Nmea_HexDigit(uint8_t c);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a parser.
+  * @param  hnmea Parser handle.
+  * @retval None
+  */
+void Nmea_Init(Nmea_HandleTypeDef *hnmea)
+{
+  memset(hnmea, 0, sizeof(*hnmea));
+  hnmea->State = NMEA_STATE_IDLE;
+  hnmea->SentenceMask = NMEA_SENTENCE_ALL;
+}
+
+/**
+  * @brief  Feed received bytes to the parser.
+  * @note   Nmea_SentenceCallback() is called from this function, once per valid
+  *         sentence of a supported type.
+  * @param  hnmea Parser handle.
+  * @param  pData Received bytes.
+  * @param  Len   Number of bytes.
+  * @retval None
+  */
+void Nmea_Parse(Nmea_HandleTypeDef *hnmea, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t i;
+  uint8_t c;
+  int32_t hex;
+
+  for (i = 0U; i < Len; i++)
+  {
+    c = pData[i];
+
+    if ((c == (uint8_t)'$') || (c == (uint8_t)'!'))
+    {
+      /* Start of sentence, also resynchronizes a truncated one */
+      if (hnmea->State != NMEA_STATE_IDLE)
+      {
+        hnmea->FormatErrors++;
+      }
+      hnmea->State = NMEA_STATE_ADDRESS;
+      hnmea->Checksum = 0U;
+      hnmea->Length = 1U;
+      hnmea->FieldIndex = 0U;
+      hnmea->FieldLength = 0U;
+      continue;
+    }
+
+    switch (hnmea->State)
+    {
+      case NMEA_STATE_FIELDS:
+        if (c == (uint8_t)'*')
+        {
+          Nmea_CommitField(hnmea);
+          hnmea->State = NMEA_STATE_CHECKSUM_HI;
+        }
+        else if ((c < 0x20U) || (++hnmea->Length > (NMEA_MAX_LENGTH - 3U)))
+        {
+          /* Line ended without checksum, or sentence too long */
+          hnmea->FormatErrors++;
+          hnmea->State = NMEA_STATE_IDLE;
+        }
+        else
+        {
+          hnmea->Checksum ^= c;
+          if (c == (uint8_t)',')
+          {
+            Nmea_CommitField(hnmea);
+            hnmea->FieldIndex++;
+            hnmea->FieldLength = 0U;
+          }
+          else if (hnmea->FieldLength < NMEA_FIELD_MAX)
+          {
+            hnmea->Field[hnmea->FieldLength++] = (char)c;
+          }
+          else
+          {
+            /* Too long to be decoded: marks the field as malformed */
+            hnmea->FieldLength = NMEA_FIELD_MAX + 1U;
+          }
+        }
+        break;
+
+      case NMEA_STATE_ADDRESS:
+        hnmea->Checksum ^= c;
+        hnmea->Length++;
+        if (c == (uint8_t)',')
+        {
+          hnmea->Sentence.Id = (hnmea->FieldLength == NMEA_ADDRESS_LENGTH) ? Nmea_Identify(hnmea->Field)
+                                                                            : NMEA_SENTENCE_UNKNOWN;
+          if ((hnmea->Sentence.Id == NMEA_SENTENCE_UNKNOWN)
+              || ((hnmea->SentenceMask & NMEA_SENTENCE_MASK(hnmea->Sentence.Id)) == 0U))
+          {
+            hnmea->IgnoredCount++;
+            hnmea->State = NMEA_STATE_IDLE;
+            break;
+          }
+          hnmea->Sentence.Talker[0] = hnmea->Field[0];
+          hnmea->Sentence.Talker[1] = hnmea->Field[1];
+          memset(&hnmea->Sentence.Data, 0, sizeof(hnmea->Sentence.Data));
+          hnmea->FieldIndex = 1U;
+          hnmea->FieldLength = 0U;
+          hnmea->State = NMEA_STATE_FIELDS;
+        }
+        else if ((hnmea->FieldLength < NMEA_ADDRESS_LENGTH) && (c >= 0x20U) && (c != (uint8_t)'*'))
+        {
+          hnmea->Field[hnmea->FieldLength++] = (char)c;
+        }
+        else
+        {
+          hnmea->FormatErrors++;
+          hnmea->State = NMEA_STATE_IDLE;
+        }
+        break;
+
+      case NMEA_STATE_CHECKSUM_HI:
+        hex = Nmea_HexDigit(c);
+        if (hex < 0)
+        {
+          hnmea->FormatErrors++;
+          hnmea->State = NMEA_STATE_IDLE;
+          break;
+        }
+        hnmea->RxChecksum = (uint8_t)(hex << 4);
+        hnmea->State = NMEA_STATE_CHECKSUM_LO;
+        break;
+
+      case NMEA_STATE_CHECKSUM_LO:
+        hex = Nmea_HexDigit(c);
+        hnmea->State = NMEA_STATE_IDLE;
+        if (hex < 0)
+        {
+          hnmea->FormatErrors++;
+          break;
+        }
+        if ((hnmea->RxChecksum | (uint8_t)hex) != hnmea->Checksum)
+        {
+          hnmea->ChecksumErrors++;
+          break;
+        }
+        Nmea_Finalize(hnmea);
+        hnmea->SentenceCount++;
+        Nmea_SentenceCallback(hnmea, &hnmea->Sentence);
+        break;
+
+      default:
+        /* NMEA_STATE_IDLE: skip up to the next '$' */
+        break;
+    }
+  }
+}
+
+/**
+  * @brief  Valid sentence callback.
+  * @param  hnmea     Parser handle.
+  * @param  pSentence Decoded sentence, valid during the call only.
+  * @retval None
+  */
+__weak void Nmea_SentenceCallback(Nmea_HandleTypeDef *hnmea, const Nmea_SentenceTypeDef *pSentence)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hnmea);
+  UNUSED(pSentence);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the Nmea_SentenceCallback can be implemented in the user file.
+   */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Compile time check of the formatter hash, never called.
+  * @note   Two formatters sharing a slot give a duplicate case value error.
+  * @param  Hash Unused.
+  * @retval None
+  */
+static inline void Nmea_HashCheck(uint32_t Hash)
+{
+  switch (Hash)
+  {
+    NMEA_FORMATTERS(NMEA_HASH_CASE)
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief  Map the address field to a supported sentence type.
+  * @note   One hash and one compare, whatever the number of formatters. The
+  *         talker ID is not part of the key, any talker is accepted.
+  * @param  pAddress Talker ID followed by the 3-character sentence formatter.
+  * @retval Sentence identifier
+  */
+static Nmea_SentenceIdTypeDef Nmea_Identify(const char *pAddress)
+{
+  uint32_t key = NMEA_KEY(pAddress[2], pAddress[3], pAddress[4]);
+  const Nmea_FormatterTypeDef *entry = &Nmea_FormatterTable[NMEA_HASH(key)];
+
+  return (entry->Key == key) ? entry->Id : NMEA_SENTENCE_UNKNOWN;
+}
+
+/**
+  * @brief  Decode the field just received into the sentence record.
+  * @param  hnmea Parser handle.
+  * @retval None
+  */
+static void Nmea_CommitField(Nmea_HandleTypeDef *hnmea)
+{
+  const char *p = hnmea->Field;
+  uint32_t n = hnmea->FieldLength;
+  uint32_t k = hnmea->FieldIndex;
+  char c;
+  Nmea_GSVSatelliteTypeDef *sat;
+
+  if (n > NMEA_FIELD_MAX)
+  {
+    /* Oversized field: leave the record entry null */
+    n = 0U;
+  }
+  c = (n != 0U) ? p[0] : '\0';
+
+  switch (hnmea->Sentence.Id)
+  {
+    case NMEA_SENTENCE_GGA:
+    {
+      Nmea_GGATypeDef *gga = &hnmea->Sentence.Data.GGA;
+      switch (k)
+      {
+        case 1U:  Nmea_ParseDecimal(p, n, &gga->Time);            break;
+        case 2U:  Nmea_ParseDecimal(p, n, &gga->Latitude);        break;
+        case 3U:  gga->NS = c;                                    break;
+        case 4U:  Nmea_ParseDecimal(p, n, &gga->Longitude);       break;
+        case 5U:  gga->EW = c;                                    break;
+        case 6U:  gga->Quality = (uint8_t)Nmea_ParseUInt(p, n);   break;
+        case 7U:  gga->NumSatellites = (uint8_t)Nmea_ParseUInt(p, n); break;
+        case 8U:  Nmea_ParseDecimal(p, n, &gga->Hdop);            break;
+        case 9U:  Nmea_ParseDecimal(p, n, &gga->Altitude);        break;
+        case 11U: Nmea_ParseDecimal(p, n, &gga->GeoidSeparation); break;
+        default:                                                  break;
+      }
+      break;
+    }
+
+    case NMEA_SENTENCE_RMC:
+    {
+      Nmea_RMCTypeDef *rmc = &hnmea->Sentence.Data.RMC;
+      switch (k)
+      {
+        case 1U:  Nmea_ParseDecimal(p, n, &rmc->Time);            break;
+        case 2U:  rmc->Status = c;                                break;
+        case 3U:  Nmea_ParseDecimal(p, n, &rmc->Latitude);        break;
+        case 4U:  rmc->NS = c;                                    break;
+        case 5U:  Nmea_ParseDecimal(p, n, &rmc->Longitude);       break;
+        case 6U:  rmc->EW = c;                                    break;
+        case 7U:  Nmea_ParseDecimal(p, n, &rmc->SpeedKnots);      break;
+        case 8U:  Nmea_ParseDecimal(p, n, &rmc->Course);          break;
+        case 9U:  rmc->Date = Nmea_ParseUInt(p, n);               break;
+        case 10U: Nmea_ParseDecimal(p, n, &rmc->MagVariation);    break;
+        case 11U: rmc->MagEW = c;                                 break;
+        case 12U: rmc->Mode = c;                                  break;
+        default:                                                  break;
+      }
+      break;
+    }
+
+    case NMEA_SENTENCE_VTG:
+    {
+      Nmea_VTGTypeDef *vtg = &hnmea->Sentence.Data.VTG;
+      switch (k)
+      {
+        case 1U:  Nmea_ParseDecimal(p, n, &vtg->CourseTrue);      break;
+        case 3U:  Nmea_ParseDecimal(p, n, &vtg->CourseMagnetic);  break;
+        case 5U:  Nmea_ParseDecimal(p, n, &vtg->SpeedKnots);      break;
+        case 7U:  Nmea_ParseDecimal(p, n, &vtg->SpeedKmh);        break;
+        case 9U:  vtg->Mode = c;                                  break;
+        default:                                                  break;
+      }
+      break;
+    }
+
+    case NMEA_SENTENCE_GSA:
+    {
+      Nmea_GSATypeDef *gsa = &hnmea->Sentence.Data.GSA;
+      if ((k >= 3U) && (k < (3U + NMEA_GSA_SATELLITES)))
+      {
+        gsa->Prn[k - 3U] = (uint16_t)Nmea_ParseUInt(p, n);
+        break;
+      }
+      switch (k)
+      {
+        case 1U:  gsa->SelectionMode = c;                         break;
+        case 2U:  gsa->FixType = (uint8_t)Nmea_ParseUInt(p, n);   break;
+        case 15U: Nmea_ParseDecimal(p, n, &gsa->Pdop);            break;
+        case 16U: Nmea_ParseDecimal(p, n, &gsa->Hdop);            break;
+        case 17U: Nmea_ParseDecimal(p, n, &gsa->Vdop);            break;
+        case 18U: gsa->SystemId = (uint8_t)Nmea_ParseUInt(p, n);  break;
+        default:                                                  break;
+      }
+      break;
+    }
+
+    case NMEA_SENTENCE_GSV:
+    {
+      Nmea_GSVTypeDef *gsv = &hnmea->Sentence.Data.GSV;
+      if (k < 4U)
+      {
+        switch (k)
+        {
+          case 1U:  gsv->NumMessages = (uint8_t)Nmea_ParseUInt(p, n);      break;
+          case 2U:  gsv->MessageNumber = (uint8_t)Nmea_ParseUInt(p, n);    break;
+          default:  gsv->SatellitesInView = (uint8_t)Nmea_ParseUInt(p, n); break;
+        }
+        break;
+      }
+      if (((k - 4U) / 4U) >= NMEA_GSV_SATELLITES)
+      {
+        /* Signal ID following a full set of satellites */
+        gsv->SignalId = (uint8_t)Nmea_ParseUInt(p, n);
+        break;
+      }
+      sat = &gsv->Satellite[(k - 4U) / 4U];
+      switch ((k - 4U) % 4U)
+      {
+        case 0U:  sat->Prn = (uint16_t)Nmea_ParseUInt(p, n);                   break;
+        case 1U:  sat->Elevation = (n != 0U) ? (int8_t)Nmea_ParseUInt(p, n) : (int8_t)-128; break;
+        case 2U:  sat->Azimuth = (uint16_t)Nmea_ParseUInt(p, n);               break;
+        default:  sat->Snr = (n != 0U) ? (int8_t)Nmea_ParseUInt(p, n) : (int8_t)-1; break;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief  Complete the record once all fields are known.
+  * @param  hnmea Parser handle.
+  * @retval None
+  */
+static void Nmea_Finalize(Nmea_HandleTypeDef *hnmea)
+{
+  Nmea_GSVTypeDef *gsv;
+  uint32_t fields;
+
+  if (hnmea->Sentence.Id != NMEA_SENTENCE_GSV)
+  {
+    return;
+  }
+
+  /* Fields after the header are groups of 4, plus an optional signal ID */
+  gsv = &hnmea->Sentence.Data.GSV;
+  fields = (hnmea->FieldIndex >= 4U) ? (hnmea->FieldIndex - 3U) : 0U;
+  gsv->NumSatellites = (uint8_t)(fields / 4U);
+  if (gsv->NumSatellites > NMEA_GSV_SATELLITES)
+  {
+    gsv->NumSatellites = NMEA_GSV_SATELLITES;
+  }
+  else if (((fields % 4U) == 1U) && (gsv->NumSatellites < NMEA_GSV_SATELLITES))
+  {
+    gsv->SignalId = (uint8_t)gsv->Satellite[gsv->NumSatellites].Prn;
+    gsv->Satellite[gsv->NumSatellites].Prn = 0U;
+  }
+}
+
+/**
+  * @brief  Decode a decimal field, e.g. "-12.340" into {-12340, 3}.
+  * @note   Fraction digits that do not fit in 31 bits are dropped.
+  * @param  p        Field characters.
+  * @param  n        Number of characters.
+  * @param  pDecimal Decoded value, Scale NMEA_DECIMAL_EMPTY if null or malformed.
+  * @retval None
+  */
+static void Nmea_ParseDecimal(const char *p, uint32_t n, Nmea_DecimalTypeDef *pDecimal)
+{
+  uint32_t i = 0U;
+  uint32_t value = 0U;
+  uint32_t scale = 0U;
+  uint32_t fraction = 0U;
+  uint32_t negative = 0U;
+  uint32_t digit;
+
+  pDecimal->Value = 0;
+  pDecimal->Scale = NMEA_DECIMAL_EMPTY;
+
+  if ((n != 0U) && (p[0] == '-'))
+  {
+    negative = 1U;
+    i = 1U;
+  }
+  if (i == n)
+  {
+    return;
+  }
+
+  for (; i < n; i++)
+  {
+    if ((p[i] == '.') && (fraction == 0U))
+    {
+      fraction = 1U;
+      continue;
+    }
+    digit = (uint32_t)p[i] - (uint32_t)'0';
+    if (digit > 9U)
+    {
+      return;
+    }
+    if (value > ((0x7FFFFFFFU - 9U) / 10U))
+    {
+      if (fraction == 0U)
+      {
+        return;
+      }
+      break;
+    }
+    value = (value * 10U) + digit;
+    scale += fraction;
+  }
+
+  pDecimal->Value = (negative != 0U) ? -(int32_t)value : (int32_t)value;
+  pDecimal->Scale = (uint8_t)scale;
+}
+
+/**
+  * @brief  Decode an unsigned integer field, stopping at the first non digit.
+  * @param  p Field characters.
+  * @param  n Number of characters.
+  * @retval Value, 0 if null
+  */
+static uint32_t Nmea_ParseUInt(const char *p, uint32_t n)
+{
+  uint32_t i;
+  uint32_t value = 0U;
+  uint32_t digit;
+
+  for (i = 0U; i < n; i++)
+  {
+    digit = (uint32_t)p[i] - (uint32_t)'0';
+    if (digit > 9U)
+    {
+      break;
+    }
+    value = (value * 10U) + digit;
+  }
+  return value;
+}
+
+/**
+  * @brief  Convert a hexadecimal digit.
+  * @param  c Character.
+  * @retval Digit value, -1 if c is not a hexadecimal digit
+  */
+static int32_t Nmea_HexDigit(uint8_t c)
+{
+  if ((c >= (uint8_t)'0') && (c <= (uint8_t)'9'))
+  {
+    return (int32_t)c - (int32_t)'0';
+  }
+  c |= 0x20U;
+  if ((c >= (uint8_t)'a') && (c <= (uint8_t)'f'))
+  {
+    return (int32_t)c - (int32_t)'a' + 10;
+  }
+  return -1;
+}
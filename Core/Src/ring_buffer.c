@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @file           : ring_buffer.c
+  * @brief          : Lock-free single-producer/single-consumer byte ring.
+  ******************************************************************************
+  * @attention
+  *
+  * Indexes are free-running 32-bit counters; the fill level is always
+  * (Head - Tail), which stays correct across the 2^32 wrap because Size is a
+  * power of two. The producer never touches Tail and the consumer never
+  * touches Head, so no interrupt masking is required on a single core.
+  * When the ring is full the producer truncates the write (drop newest) and
+  * accounts the loss in OverflowCount / DroppedBytes.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "ring_buffer.h"
+#include <string.h>
+
+/* Private macro -------------------------------------------------------------*/
+#define RINGBUF_LOAD_ACQUIRE(__IDX__)         __atomic_load_n(&(__IDX__), __ATOMIC_ACQUIRE)
+#define RINGBUF_LOAD_RELAXED(__IDX__)         __atomic_load_n(&(__IDX__), __ATOMIC_RELAXED)
+#define RINGBUF_STORE_RELEASE(__IDX__, __V__) __atomic_store_n(&(__IDX__), (__V__), __ATOMIC_RELEASE)
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a ring buffer on top of a caller provided storage.
+  * @param  hring   Ring buffer handle.
+  * @param  pBuffer Storage area.
+  * @param  Size    Storage size in bytes, must be a non-zero power of two.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef RingBuf_Init(RingBuf_HandleTypeDef *hring, uint8_t *pBuffer, uint32_t Size)
+{
+  if ((hring == NULL) || (pBuffer == NULL) || (Size == 0U) || ((Size & (Size - 1U)) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  hring->pBuffer       = pBuffer;
+  hring->Size          = Size;
+  hring->Mask          = Size - 1U;
+  hring->Head          = 0U;
+  hring->Tail          = 0U;
+  hring->HighWater     = 0U;
+  hring->OverflowCount = 0U;
+  hring->DroppedBytes  = 0U;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Append bytes to the ring (producer side).
+  * @note   If there is not enough room, only the bytes that fit are written and
+  *         the remainder is accounted as dropped.
+  * @param  hring Ring buffer handle.
+  * @param  pData Bytes to append.
+  * @param  Len   Number of bytes to append.
+  * @retval Number of bytes actually written.
+  */
+uint32_t RingBuf_Write(RingBuf_HandleTypeDef *hring, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t head = RINGBUF_LOAD_RELAXED(hring->Head);
+  uint32_t tail = RINGBUF_LOAD_ACQUIRE(hring->Tail);
+  uint32_t room = hring->Size - (head - tail);
+  uint32_t offset;
+  uint32_t first;
+  uint32_t fill;
+
+  if (Len > room)
+  {
+    hring->OverflowCount++;
+    hring->DroppedBytes += Len - room;
+    Len = room;
+  }
+
+  if (Len != 0U)
+  {
+    offset = head & hring->Mask;
+    first  = hring->Size - offset;
+    if (first > Len)
+    {
+      first = Len;
+    }
+    memcpy(&hring->pBuffer[offset], pData, first);
+    memcpy(hring->pBuffer, &pData[first], Len - first);
+
+    /* Publish the bytes: stores above must be visible before the new Head */
+    RINGBUF_STORE_RELEASE(hring->Head, head + Len);
+  }
+
+  fill = (head + Len) - tail;
+  if (fill > hring->HighWater)
+  {
+    hring->HighWater = fill;
+  }
+
+  return Len;
+}
+
+/**
+  * @brief  Return the number of bytes that can be written without truncation.
+  * @param  hring Ring buffer handle.
+  * @retval Free space in bytes.
+  */
+uint32_t RingBuf_GetFree(const RingBuf_HandleTypeDef *hring)
+{
+  return hring->Size - (RINGBUF_LOAD_RELAXED(hring->Head) - RINGBUF_LOAD_ACQUIRE(hring->Tail));
+}
+
+/**
+  * @brief  Return the free-running index the next written byte will get.
+  * @note   Producer side only. Bytes keep their index until they are read or
+  *         released, which allows referring to them by stream offset.
+  * @param  hring Ring buffer handle.
+  * @retval Write index.
+  */
+uint32_t RingBuf_GetWriteIndex(const RingBuf_HandleTypeDef *hring)
+{
+  return RINGBUF_LOAD_RELAXED(hring->Head);
+}
+
+/**
+  * @brief  Remove bytes from the ring (consumer side).
+  * @param  hring Ring buffer handle.
+  * @param  pData Destination buffer.
+  * @param  Len   Maximum number of bytes to read.
+  * @retval Number of bytes actually read.
+  */
+uint32_t RingBuf_Read(RingBuf_HandleTypeDef *hring, uint8_t *pData, uint32_t Len)
+{
+  uint32_t tail = RINGBUF_LOAD_RELAXED(hring->Tail);
+  uint32_t head = RINGBUF_LOAD_ACQUIRE(hring->Head);
+  uint32_t count = head - tail;
+  uint32_t offset;
+  uint32_t first;
+
+  if (Len > count)
+  {
+    Len = count;
+  }
+
+  if (Len != 0U)
+  {
+    offset = tail & hring->Mask;
+    first  = hring->Size - offset;
+    if (first > Len)
+    {
+      first = Len;
+    }
+    memcpy(pData, &hring->pBuffer[offset], first);
+    memcpy(&pData[first], hring->pBuffer, Len - first);
+
+    /* Release the slots: loads above must complete before the producer reuses them */
+    RINGBUF_STORE_RELEASE(hring->Tail, tail + Len);
+  }
+
+  return Len;
+}
+
+/**
+  * @brief  Return the number of bytes available to the consumer.
+  * @param  hring Ring buffer handle.
+  * @retval Fill level in bytes.
+  */
+uint32_t RingBuf_GetCount(const RingBuf_HandleTypeDef *hring)
+{
+  return RINGBUF_LOAD_ACQUIRE(hring->Head) - RINGBUF_LOAD_RELAXED(hring->Tail);
+}
+
+/**
+  * @brief  Return the free-running index of the oldest unread byte.
+  * @note   Consumer side only.
+  * @param  hring Ring buffer handle.
+  * @retval Read index.
+  */
+uint32_t RingBuf_GetReadIndex(const RingBuf_HandleTypeDef *hring)
+{
+  return RINGBUF_LOAD_RELAXED(hring->Tail);
+}
+
+/**
+  * @brief  Access unread bytes in place, starting at a free-running index (consumer side).
+  * @param  hring  Ring buffer handle.
+  * @param  Index  Free-running index of the first byte, between the read and write indexes.
+  * @param  ppData Set to the location of the byte at Index.
+  * @retval Number of contiguous bytes available at *ppData, 0 if Index is not unread data.
+  */
+uint32_t RingBuf_Peek(const RingBuf_HandleTypeDef *hring, uint32_t Index, const uint8_t **ppData)
+{
+  uint32_t tail = RINGBUF_LOAD_RELAXED(hring->Tail);
+  uint32_t head = RINGBUF_LOAD_ACQUIRE(hring->Head);
+  uint32_t offset = Index & hring->Mask;
+  uint32_t count;
+
+  if ((Index - tail) >= (head - tail))
+  {
+    return 0U;
+  }
+
+  count = head - Index;
+  if (count > (hring->Size - offset))
+  {
+    count = hring->Size - offset;
+  }
+  *ppData = &hring->pBuffer[offset];
+
+  return count;
+}
+
+/**
+  * @brief  Release all bytes located before a free-running index (consumer side).
+  * @note   Indexes at or behind the read index are ignored, indexes beyond the
+  *         write index release all unread data.
+  * @param  hring Ring buffer handle.
+  * @param  Index Free-running index of the first byte to keep.
+  * @retval None
+  */
+void RingBuf_ReleaseTo(RingBuf_HandleTypeDef *hring, uint32_t Index)
+{
+  uint32_t tail = RINGBUF_LOAD_RELAXED(hring->Tail);
+  uint32_t head = RINGBUF_LOAD_ACQUIRE(hring->Head);
+
+  if ((int32_t)(Index - tail) <= 0)
+  {
+    return;
+  }
+  if ((Index - tail) > (head - tail))
+  {
+    Index = head;
+  }
+
+  RINGBUF_STORE_RELEASE(hring->Tail, Index);
+}
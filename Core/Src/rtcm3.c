@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file           : rtcm3.c
+  * @brief          : RTCM 3 frame parser with CRC-24Q.
+  ******************************************************************************
+  * @attention
+  *
+  * The CRC-24Q (polynomial 0x864CFB, initial value 0, no final XOR) is run
+  * over the whole frame, CRC bytes included, so a valid frame leaves a zero
+  * remainder and the CRC never has to be extracted. It is computed with
+  * slicing-by-4 tables: four 256-entry tables, built on first use and kept in
+  * RAM to avoid flash wait states, let four bytes be folded per step.
+  * A preamble whose reserved bits are set or whose CRC does not match is
+  * treated as a false sync and scanning resumes at the byte that follows it.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rtcm3.h"
+#include "mem_sections.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define RTCM3_STATE_SYNC              0U
+#define RTCM3_STATE_LENGTH1           1U
+#define RTCM3_STATE_LENGTH2           2U
+#define RTCM3_STATE_BODY              3U
+
+#define RTCM3_CRC24Q_POLY             0x864CFBU
+
+/* Private variables ---------------------------------------------------------*/
+/* Rtcm3_CrcTable[k][b]: CRC of byte b followed by k zero bytes, in the upper 24 bits */
+static uint32_t Rtcm3_CrcTable[4][256] __CCMRAM;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Rtcm3_CrcInit(void);
+static uint32_t Rtcm3_CrcUpdate(uint32_t Crc, const uint8_t *pData, uint32_t Len);
+static void Rtcm3_Resync(Rtcm3_HandleTypeDef *hrtcm);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a parser.
+  * @param  hrtcm  Parser handle.
+  * @param  Offset Stream offset of the first byte to scan.
+  * @retval None
+  */
+void Rtcm3_Init(Rtcm3_HandleTypeDef *hrtcm, uint32_t Offset)
+{
+  if (Rtcm3_CrcTable[0][1] == 0U)
+  {
+    Rtcm3_CrcInit();
+  }
+
+  hrtcm->State        = RTCM3_STATE_SYNC;
+  hrtcm->ScanOffset   = Offset;
+  hrtcm->FrameStart   = Offset;
+  hrtcm->Remaining    = 0U;
+  hrtcm->Crc          = 0U;
+  hrtcm->FrameCount   = 0U;
+  hrtcm->CrcErrors    = 0U;
+  hrtcm->HeaderErrors = 0U;
+}
+
+/**
+  * @brief  Scan stream bytes.
+  * @note   pData must hold the bytes found at Rtcm3_GetScanOffset(). The scan
+  *         stops early after a false sync; the caller then feeds again from
+  *         the new scan offset, which moved back into already scanned data.
+  *         Rtcm3_FrameCallback() is called from this function.
+  * @param  hrtcm Parser handle.
+  * @param  pData Stream bytes.
+  * @param  Len   Number of bytes.
+  * @retval None
+  */
+void Rtcm3_Parse(Rtcm3_HandleTypeDef *hrtcm, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t i = 0U;
+  uint32_t n;
+  uint8_t c;
+  const uint8_t *p;
+
+  while (i < Len)
+  {
+    switch (hrtcm->State)
+    {
+      case RTCM3_STATE_SYNC:
+        p = memchr(&pData[i], RTCM3_PREAMBLE, Len - i);
+        if (p == NULL)
+        {
+          hrtcm->ScanOffset += Len - i;
+          hrtcm->FrameStart = hrtcm->ScanOffset;
+          return;
+        }
+        n = (uint32_t)(p - &pData[i]);
+        hrtcm->FrameStart = hrtcm->ScanOffset + n;
+        hrtcm->ScanOffset += n + 1U;
+        i += n + 1U;
+        hrtcm->Crc = Rtcm3_CrcUpdate(0U, p, 1U);
+        hrtcm->State = RTCM3_STATE_LENGTH1;
+        break;
+
+      case RTCM3_STATE_LENGTH1:
+        c = pData[i];
+        if ((c & 0xFCU) != 0U)
+        {
+          hrtcm->HeaderErrors++;
+          Rtcm3_Resync(hrtcm);
+          return;
+        }
+        hrtcm->Remaining = (uint32_t)c << 8;
+        hrtcm->Crc = Rtcm3_CrcUpdate(hrtcm->Crc, &pData[i], 1U);
+        hrtcm->ScanOffset++;
+        i++;
+        hrtcm->State = RTCM3_STATE_LENGTH2;
+        break;
+
+      case RTCM3_STATE_LENGTH2:
+        hrtcm->Remaining |= pData[i];
+        hrtcm->Remaining += RTCM3_CRC_LENGTH;
+        hrtcm->Crc = Rtcm3_CrcUpdate(hrtcm->Crc, &pData[i], 1U);
+        hrtcm->ScanOffset++;
+        i++;
+        hrtcm->State = RTCM3_STATE_BODY;
+        break;
+
+      default:
+        /* RTCM3_STATE_BODY: payload and CRC, folded in bulk */
+        n = (hrtcm->Remaining < (Len - i)) ? hrtcm->Remaining : (Len - i);
+        hrtcm->Crc = Rtcm3_CrcUpdate(hrtcm->Crc, &pData[i], n);
+        hrtcm->Remaining -= n;
+        hrtcm->ScanOffset += n;
+        i += n;
+        if (hrtcm->Remaining != 0U)
+        {
+          break;
+        }
+        if (hrtcm->Crc != 0U)
+        {
+          hrtcm->CrcErrors++;
+          Rtcm3_Resync(hrtcm);
+          return;
+        }
+        hrtcm->FrameCount++;
+        hrtcm->State = RTCM3_STATE_SYNC;
+        Rtcm3_FrameCallback(hrtcm, hrtcm->FrameStart, hrtcm->ScanOffset - hrtcm->FrameStart);
+        hrtcm->FrameStart = hrtcm->ScanOffset;
+        break;
+    }
+  }
+}
+
+/**
+  * @brief  Stream offset of the next byte the parser expects.
+  * @param  hrtcm Parser handle.
+  * @retval Offset
+  */
+uint32_t Rtcm3_GetScanOffset(const Rtcm3_HandleTypeDef *hrtcm)
+{
+  return hrtcm->ScanOffset;
+}
+
+/**
+  * @brief  Stream offset of the oldest byte the parser may still need.
+  * @note   Bytes before this offset may be released by the owner.
+  * @param  hrtcm Parser handle.
+  * @retval Offset
+  */
+uint32_t Rtcm3_GetSyncOffset(const Rtcm3_HandleTypeDef *hrtcm)
+{
+  return hrtcm->FrameStart;
+}
+
+/**
+  * @brief  Compute or continue a CRC-24Q.
+  * @param  Crc   CRC of the preceding bytes, 0 to start.
+  * @param  pData Bytes.
+  * @param  Len   Number of bytes.
+  * @retval CRC, 24 bits
+  */
+uint32_t Rtcm3_Crc24q(uint32_t Crc, const uint8_t *pData, uint32_t Len)
+{
+  if (Rtcm3_CrcTable[0][1] == 0U)
+  {
+    Rtcm3_CrcInit();
+  }
+
+  return Rtcm3_CrcUpdate(Crc, pData, Len);
+}
+
+/**
+  * @brief  Validated frame callback.
+  * @note   The frame, preamble to CRC included, lies at stream offsets
+  *         [Offset, Offset + Length) and is only guaranteed to be available
+  *         during the call; an owner that keeps the bytes from being released
+  *         may read them later, e.g. through a Tx DMA.
+  * @param  hrtcm  Parser handle.
+  * @param  Offset Stream offset of the preamble.
+  * @param  Length Frame length.
+  * @retval None
+  */
+__weak void Rtcm3_FrameCallback(Rtcm3_HandleTypeDef *hrtcm, uint32_t Offset, uint32_t Length)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hrtcm);
+  UNUSED(Offset);
+  UNUSED(Length);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the Rtcm3_FrameCallback can be implemented in the user file.
+   */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Build the slicing-by-4 tables.
+  * @retval None
+  */
+static void Rtcm3_CrcInit(void)
+{
+  uint32_t b;
+  uint32_t k;
+  uint32_t c;
+
+  for (b = 0U; b < 256U; b++)
+  {
+    c = b << 16;
+    for (k = 0U; k < 8U; k++)
+    {
+      c <<= 1;
+      if ((c & 0x1000000U) != 0U)
+      {
+        c ^= RTCM3_CRC24Q_POLY;
+      }
+    }
+    Rtcm3_CrcTable[0][b] = (c & 0xFFFFFFU) << 8;
+  }
+
+  for (b = 0U; b < 256U; b++)
+  {
+    for (k = 1U; k < 4U; k++)
+    {
+      c = Rtcm3_CrcTable[k - 1U][b];
+      Rtcm3_CrcTable[k][b] = (c << 8) ^ Rtcm3_CrcTable[0][c >> 24];
+    }
+  }
+}
+
+/**
+  * @brief  Fold bytes into a CRC-24Q, four at a time.
+  * @param  Crc   CRC of the preceding bytes, 24 bits.
+  * @param  pData Bytes.
+  * @param  Len   Number of bytes.
+  * @retval CRC, 24 bits
+  */
+static uint32_t Rtcm3_CrcUpdate(uint32_t Crc, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t c = Crc << 8;
+  uint32_t w;
+
+  while (Len >= 4U)
+  {
+    w = c ^ (((uint32_t)pData[0] << 24) | ((uint32_t)pData[1] << 16)
+             | ((uint32_t)pData[2] << 8) | (uint32_t)pData[3]);
+    c = Rtcm3_CrcTable[3][w >> 24] ^ Rtcm3_CrcTable[2][(w >> 16) & 0xFFU]
+        ^ Rtcm3_CrcTable[1][(w >> 8) & 0xFFU] ^ Rtcm3_CrcTable[0][w & 0xFFU];
+    pData += 4;
+    Len -= 4U;
+  }
+
+  while (Len > 0U)
+  {
+    c = (c << 8) ^ Rtcm3_CrcTable[0][(c >> 24) ^ *pData];
+    pData++;
+    Len--;
+  }
+
+  return c >> 8;
+}
+
+/**
+  * @brief  Drop a false sync and scan again from the byte after its preamble.
+  * @param  hrtcm Parser handle.
+  * @retval None
+  */
+static void Rtcm3_Resync(Rtcm3_HandleTypeDef *hrtcm)
+{
+  hrtcm->ScanOffset = hrtcm->FrameStart + 1U;
+  hrtcm->FrameStart = hrtcm->ScanOffset;
+  hrtcm->State = RTCM3_STATE_SYNC;
+}
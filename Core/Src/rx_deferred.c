@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file           : rx_deferred.c
+  * @brief          : Defers Rx Event processing from the USART/DMA ISRs to PendSV.
+  ******************************************************************************
+  * @attention
+  *
+  * The event queue is single-producer/single-consumer: all producers run at the
+  * same (highest) NVIC priority and therefore never preempt each other, and the
+  * only consumer is PendSV. When the queue is full the event is dropped and
+  * counted; since Rx Event positions are cumulative, the next event still
+  * covers the missed bytes as long as the DMA has not lapped the buffer.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rx_deferred.h"
+#include "mem_sections.h"
+
+/* Private variables ---------------------------------------------------------*/
+static RxDeferred_EventTypeDef RxDeferredQueue[RX_DEFERRED_QUEUE_SIZE] __CCMRAM;
+static uint32_t RxDeferredHead __CCMRAM;
+static uint32_t RxDeferredTail __CCMRAM;
+static uint32_t RxDeferredDropped __CCMRAM;
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Record an Rx event and pend PendSV. Intended to be called from the
+  *         Rx Event callback, i.e. in USART or DMA interrupt context.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  Pos Position reported by the Rx Event callback.
+  * @retval None
+  */
+void RxDeferred_Post(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos)
+{
+  RxDeferred_PostEvent(hDMAIdleReciever, Pos, HAL_DMAIdleRecieverEx_GetRxEventType(hDMAIdleReciever));
+}
+
+/**
+  * @brief  Record an event of a given type and pend PendSV. Must be called at the
+  *         same interrupt priority as RxDeferred_Post().
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  Pos Position reported by the Rx Event callback, or application value.
+  * @param  EventType Rx event type or RX_DEFERRED_EVENT_TIMEOUT.
+  * @retval None
+  */
+void RxDeferred_PostEvent(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos,
+                          HAL_DMAIdleReciever_RxEventTypeTypeDef EventType)
+{
+  uint32_t head = RxDeferredHead;
+  RxDeferred_EventTypeDef *event;
+
+  if ((head - __atomic_load_n(&RxDeferredTail, __ATOMIC_ACQUIRE)) < RX_DEFERRED_QUEUE_SIZE)
+  {
+    event = &RxDeferredQueue[head & (RX_DEFERRED_QUEUE_SIZE - 1U)];
+    event->hDMAIdleReciever = hDMAIdleReciever;
+    event->pBuffer = HAL_DMAIdleRecieverEx_GetRxEventBuffer(hDMAIdleReciever);
+    event->Pos = Pos;
+    event->EventType = EventType;
+    __atomic_store_n(&RxDeferredHead, head + 1U, __ATOMIC_RELEASE);
+  }
+  else
+  {
+    RxDeferredDropped++;
+  }
+
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/**
+  * @brief  Dispatch all recorded Rx events. To be called from PendSV_Handler().
+  * @retval None
+  */
+void RxDeferred_Process(void)
+{
+  uint32_t tail = RxDeferredTail;
+  RxDeferred_EventTypeDef event;
+
+  while (tail != __atomic_load_n(&RxDeferredHead, __ATOMIC_ACQUIRE))
+  {
+    event = RxDeferredQueue[tail & (RX_DEFERRED_QUEUE_SIZE - 1U)];
+    tail++;
+    __atomic_store_n(&RxDeferredTail, tail, __ATOMIC_RELEASE);
+
+    RxDeferred_EventCallback(event.hDMAIdleReciever, event.pBuffer, event.Pos, event.EventType);
+  }
+}
+
+/**
+  * @brief  Return the number of events dropped because the queue was full.
+  * @retval Dropped event count
+  */
+uint32_t RxDeferred_GetDroppedEvents(void)
+{
+  return RxDeferredDropped;
+}
+
+/**
+  * @brief  Deferred Rx event callback, executed in PendSV context.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  pBuffer Reception buffer Pos refers to (see HAL_DMAIdleRecieverEx_GetRxEventBuffer()).
+  * @param  Pos Position reported by the Rx Event callback.
+  * @param  EventType Rx event type (@ref DMAIdleReciever_RxEvent_Type_Values) or RX_DEFERRED_EVENT_TIMEOUT.
+  * @retval None
+  */
+__weak void RxDeferred_EventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pBuffer,
+                                     uint16_t Pos, HAL_DMAIdleReciever_RxEventTypeTypeDef EventType)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hDMAIdleReciever);
+  UNUSED(pBuffer);
+  UNUSED(Pos);
+  UNUSED(EventType);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the RxDeferred_EventCallback can be implemented in the user file.
+   */
+}
@@ -0,0 +1,309 @@
+/**
+  ******************************************************************************
+  * @file           : rx_framer.c
+  * @brief          : Streaming delimiter / fixed length frame extractor.
+  ******************************************************************************
+  * @attention
+  *
+  * The delimiter is matched incrementally (Knuth-Morris-Pratt), so a
+  * terminator split across two fragments, a DMA wrap point or two IDLE events
+  * is still recognised. While no delimiter byte is pending, the scan for its
+  * first byte uses memchr() rather than a byte loop.
+  * Stream offsets are free-running 32-bit counters supplied by the caller; a
+  * discontinuity between two pushes discards the frame being assembled.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rx_framer.h"
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static void RxFramer_Emit(RxFramer_HandleTypeDef *hframer, uint32_t Offset, uint32_t Length);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a framer according to hframer->Init.
+  * @param  hframer   Framer handle, Init field filled by the caller.
+  * @param  pQueue    Descriptor queue storage.
+  * @param  QueueSize Number of descriptors, must be a non-zero power of two.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef RxFramer_Init(RxFramer_HandleTypeDef *hframer, RxFramer_FrameTypeDef *pQueue, uint32_t QueueSize)
+{
+  uint32_t q;
+  uint32_t k = 0U;
+
+  if ((hframer == NULL) || (pQueue == NULL) || (QueueSize == 0U) || ((QueueSize & (QueueSize - 1U)) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  if (hframer->Init.DelimiterLength == 0U)
+  {
+    if (hframer->Init.FrameLength == 0U)
+    {
+      return HAL_ERROR;
+    }
+  }
+  else if ((hframer->Init.DelimiterLength > RXFRAMER_MAX_DELIMITER)
+           || ((hframer->Init.MaxLength != 0U) && (hframer->Init.MaxLength < hframer->Init.DelimiterLength)))
+  {
+    return HAL_ERROR;
+  }
+
+  /* Border[q] = length of the longest proper prefix of Delimiter[0..q] that is also its suffix */
+  hframer->Border[0] = 0U;
+  for (q = 1U; q < hframer->Init.DelimiterLength; q++)
+  {
+    while ((k > 0U) && (hframer->Init.Delimiter[q] != hframer->Init.Delimiter[k]))
+    {
+      k = hframer->Border[k - 1U];
+    }
+    if (hframer->Init.Delimiter[q] == hframer->Init.Delimiter[k])
+    {
+      k++;
+    }
+    hframer->Border[q] = (uint8_t)k;
+  }
+
+  hframer->Match          = 0U;
+  hframer->Skip           = 0U;
+  hframer->NextOffset     = 0U;
+  hframer->FrameStart     = 0U;
+  hframer->FrameTimestamp = 0U;
+  hframer->pQueue         = pQueue;
+  hframer->QueueSize      = QueueSize;
+  hframer->QueueHead      = 0U;
+  hframer->QueueTail      = 0U;
+  hframer->FrameCount     = 0U;
+  hframer->DroppedFrames  = 0U;
+  hframer->OversizeCount  = 0U;
+  hframer->ResyncCount    = 0U;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Scan a fragment of the received stream (producer side).
+  * @note   The framer only reads pData during the call; the frame bytes must be
+  *         kept by the caller (e.g. in a ring buffer indexed by stream offset)
+  *         until the corresponding descriptors have been consumed.
+  * @param  hframer   Framer handle.
+  * @param  pData     Fragment bytes.
+  * @param  Len       Fragment length.
+  * @param  Offset    Stream offset of pData[0].
+  * @param  Timestamp Time the fragment was received, copied into the descriptors
+  *                   of frames starting in this fragment.
+  * @retval None
+  */
+void RxFramer_Push(RxFramer_HandleTypeDef *hframer, const uint8_t *pData, uint32_t Len, uint32_t Offset,
+                   uint32_t Timestamp)
+{
+  const uint8_t *delim = hframer->Init.Delimiter;
+  uint32_t delim_len = hframer->Init.DelimiterLength;
+  uint32_t max_len = (hframer->Init.MaxLength != 0U) ? hframer->Init.MaxLength : 0xFFFFU;
+  uint32_t start = hframer->FrameStart;
+  uint32_t match = hframer->Match;
+  uint32_t skip = hframer->Skip;
+  uint32_t i = 0U;
+  uint32_t avail;
+  uint32_t room;
+  const uint8_t *p;
+  uint8_t c;
+
+  if (Offset != hframer->NextOffset)
+  {
+    /* Bytes are missing from the stream: the frame being assembled is incomplete */
+    if (hframer->NextOffset != start)
+    {
+      hframer->ResyncCount++;
+    }
+    start = Offset;
+    match = 0U;
+    skip = 0U;
+  }
+  hframer->NextOffset = Offset + Len;
+
+  while (i < Len)
+  {
+    if ((Offset + i) == start)
+    {
+      hframer->FrameTimestamp = Timestamp;
+    }
+
+    if (delim_len == 0U)
+    {
+      /* Fixed length frames */
+      room = (uint32_t)hframer->Init.FrameLength - ((Offset + i) - start);
+      if (room > (Len - i))
+      {
+        break;
+      }
+      i += room;
+      RxFramer_Emit(hframer, start, hframer->Init.FrameLength);
+      start = Offset + i;
+      continue;
+    }
+
+    if (match == 0U)
+    {
+      /* Nothing matched yet: jump to the next occurrence of the first delimiter byte */
+      avail = Len - i;
+      room = max_len - ((Offset + i) - start);
+      if (avail > room)
+      {
+        avail = room;
+      }
+      p = memchr(&pData[i], delim[0], avail);
+      if (p == NULL)
+      {
+        i += avail;
+      }
+      else
+      {
+        i = (uint32_t)(p - pData) + 1U;
+        match = 1U;
+      }
+    }
+    else
+    {
+      c = pData[i];
+      i++;
+      while ((match > 0U) && (c != delim[match]))
+      {
+        match = hframer->Border[match - 1U];
+      }
+      if (c == delim[match])
+      {
+        match++;
+      }
+    }
+
+    if (match == delim_len)
+    {
+      /* The terminator of an oversize line ends the skip, nothing is emitted */
+      if (skip == 0U)
+      {
+        RxFramer_Emit(hframer, start, (Offset + i) - start);
+      }
+      skip = 0U;
+      start = Offset + i;
+      match = 0U;
+    }
+    else if (skip != 0U)
+    {
+      /* Rest of an oversize line: released as it is scanned */
+      start = Offset + i;
+    }
+    else if (((Offset + i) - start) >= max_len)
+    {
+      /* No terminator within MaxLength: drop the line up to its terminator, whose
+         first bytes may already be matched */
+      hframer->OversizeCount++;
+      skip = 1U;
+      start = Offset + i;
+    }
+  }
+
+  hframer->Match = (uint8_t)match;
+  hframer->Skip = (uint8_t)skip;
+  __atomic_store_n(&hframer->FrameStart, start, __ATOMIC_RELEASE);
+}
+
+/**
+  * @brief  Drop the frame being assembled (producer side), e.g. after bytes
+  *         were lost on the way to the framer or on an end-of-frame timeout.
+  * @param  hframer Framer handle.
+  * @retval None
+  */
+void RxFramer_Discard(RxFramer_HandleTypeDef *hframer)
+{
+  if (hframer->NextOffset != hframer->FrameStart)
+  {
+    hframer->ResyncCount++;
+  }
+  hframer->Match = 0U;
+  hframer->Skip = 0U;
+  __atomic_store_n(&hframer->FrameStart, hframer->NextOffset, __ATOMIC_RELEASE);
+}
+
+/**
+  * @brief  Terminate the frame being assembled (producer side), for protocols
+  *         delimited by line silence, e.g. on an end-of-frame timeout.
+  * @param  hframer Framer handle.
+  * @retval None
+  */
+void RxFramer_Flush(RxFramer_HandleTypeDef *hframer)
+{
+  if (hframer->NextOffset != hframer->FrameStart)
+  {
+    RxFramer_Emit(hframer, hframer->FrameStart, hframer->NextOffset - hframer->FrameStart);
+  }
+  hframer->Match = 0U;
+  hframer->Skip = 0U;
+  __atomic_store_n(&hframer->FrameStart, hframer->NextOffset, __ATOMIC_RELEASE);
+}
+
+/**
+  * @brief  Dequeue the oldest frame descriptor (consumer side).
+  * @param  hframer Framer handle.
+  * @param  pFrame  Descriptor to fill.
+  * @retval 1 if a descriptor was returned, 0 if the queue is empty.
+  */
+uint32_t RxFramer_GetFrame(RxFramer_HandleTypeDef *hframer, RxFramer_FrameTypeDef *pFrame)
+{
+  uint32_t tail = hframer->QueueTail;
+
+  if (tail == __atomic_load_n(&hframer->QueueHead, __ATOMIC_ACQUIRE))
+  {
+    return 0U;
+  }
+
+  *pFrame = hframer->pQueue[tail & (hframer->QueueSize - 1U)];
+  __atomic_store_n(&hframer->QueueTail, tail + 1U, __ATOMIC_RELEASE);
+
+  return 1U;
+}
+
+/**
+  * @brief  Return the stream offset below which no frame is still being assembled.
+  * @note   Bytes before this offset belong either to queued descriptors or to
+  *         discarded data. Read it before draining the queue: frames completed
+  *         afterwards never start below the returned value.
+  * @param  hframer Framer handle.
+  * @retval Stream offset
+  */
+uint32_t RxFramer_GetSyncOffset(const RxFramer_HandleTypeDef *hframer)
+{
+  return __atomic_load_n(&hframer->FrameStart, __ATOMIC_ACQUIRE);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Queue a frame descriptor.
+  * @param  hframer Framer handle.
+  * @param  Offset  Stream offset of the frame.
+  * @param  Length  Frame length.
+  * @retval None
+  */
+static void RxFramer_Emit(RxFramer_HandleTypeDef *hframer, uint32_t Offset, uint32_t Length)
+{
+  uint32_t head = hframer->QueueHead;
+  RxFramer_FrameTypeDef *frame;
+
+  if ((head - __atomic_load_n(&hframer->QueueTail, __ATOMIC_ACQUIRE)) >= hframer->QueueSize)
+  {
+    hframer->DroppedFrames++;
+    return;
+  }
+
+  frame = &hframer->pQueue[head & (hframer->QueueSize - 1U)];
+  frame->Offset    = Offset;
+  frame->Length    = (uint16_t)Length;
+  frame->Timestamp = hframer->FrameTimestamp;
+  __atomic_store_n(&hframer->QueueHead, head + 1U, __ATOMIC_RELEASE);
+
+  hframer->FrameCount++;
+}
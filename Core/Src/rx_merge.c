@@ -0,0 +1,345 @@
+/**
+  ******************************************************************************
+  * @file           : rx_merge.c
+  * @brief          : Time-ordered merge of frames received on several ports.
+  ******************************************************************************
+  * @attention
+  *
+  * Records keep the same layout in the staging rings and in the output ring:
+  * an RXMERGE_HEADER_LENGTH byte header followed by the payload. A producer
+  * only writes a record when it fits as a whole, and a reader only takes a
+  * record once header and payload are both visible, so neither side needs
+  * to mask interrupts. Each frame is copied twice, into its staging ring
+  * and then into the output ring; nothing is allocated per frame.
+  * RxMerge_Poll() is a k-way merge on the oldest pending record of every
+  * source: the cost per merged record grows with the number of sources,
+  * not with the number of pending records.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rx_merge.h"
+
+/* Private define ------------------------------------------------------------*/
+#define RXMERGE_NO_SOURCE             0xFFFFFFFFU
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t RxMerge_PeekHeader(const RingBuf_HandleTypeDef *hring, uint8_t *pHeader);
+static void RxMerge_PackHeader(uint8_t *pHeader, uint32_t Timestamp, uint16_t Len, uint8_t Source, uint8_t Flags);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a merger.
+  * @note   Every source must then be set up with RxMerge_InitSource().
+  * @param  hmerge     Merger handle.
+  * @param  pSources   Source array.
+  * @param  NumSources Number of sources, 1 to 256.
+  * @param  pBuffer    Output ring storage.
+  * @param  Size       Output ring size in bytes, must be a power of two.
+  * @param  Window     Longest wait for a silent source, in timestamp ticks.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef RxMerge_Init(RxMerge_HandleTypeDef *hmerge, RxMerge_SourceTypeDef *pSources, uint32_t NumSources,
+                               uint8_t *pBuffer, uint32_t Size, uint32_t Window)
+{
+  if ((pSources == NULL) || (NumSources == 0U) || (NumSources > 256U) || ((int32_t)Window < 0))
+  {
+    return HAL_ERROR;
+  }
+
+  hmerge->pSources      = pSources;
+  hmerge->NumSources    = NumSources;
+  hmerge->Window        = Window;
+  hmerge->LastTimestamp = 0U;
+  hmerge->MergedCount   = 0U;
+  hmerge->LateCount     = 0U;
+
+  return RingBuf_Init(&hmerge->Output, pBuffer, Size);
+}
+
+/**
+  * @brief  Initialize a source.
+  * @param  hmerge  Merger handle.
+  * @param  Source  Source index.
+  * @param  pBuffer Staging ring storage.
+  * @param  Size    Staging ring size in bytes, must be a power of two.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef RxMerge_InitSource(RxMerge_HandleTypeDef *hmerge, uint32_t Source, uint8_t *pBuffer, uint32_t Size)
+{
+  RxMerge_SourceTypeDef *source;
+
+  if (Source >= hmerge->NumSources)
+  {
+    return HAL_ERROR;
+  }
+  source = &hmerge->pSources[Source];
+
+  source->Watermark     = 0U;
+  source->Started       = 0U;
+  source->DroppedFrames = 0U;
+
+  return RingBuf_Init(&source->Ring, pBuffer, Size);
+}
+
+/**
+  * @brief  Queue a complete frame of a source.
+  * @note   Source side. The frame is copied; pData may be reused on return.
+  * @param  hmerge    Merger handle.
+  * @param  Source    Source index.
+  * @param  pData     Frame bytes.
+  * @param  Len       Frame length.
+  * @param  Timestamp Arrival timestamp, not older than the previous one of this source.
+  * @retval HAL_ERROR if the staging ring is full; the frame is then dropped
+  */
+HAL_StatusTypeDef RxMerge_Push(RxMerge_HandleTypeDef *hmerge, uint32_t Source, const uint8_t *pData, uint16_t Len,
+                               uint32_t Timestamp)
+{
+  RxMerge_SourceTypeDef *source = &hmerge->pSources[Source];
+  uint8_t header[RXMERGE_HEADER_LENGTH];
+  HAL_StatusTypeDef status = HAL_OK;
+
+  if (RingBuf_GetFree(&source->Ring) < (RXMERGE_HEADER_LENGTH + (uint32_t)Len))
+  {
+    source->DroppedFrames++;
+    status = HAL_ERROR;
+  }
+  else
+  {
+    RxMerge_PackHeader(header, Timestamp, Len, (uint8_t)Source, 0U);
+    (void)RingBuf_Write(&source->Ring, header, RXMERGE_HEADER_LENGTH);
+    (void)RingBuf_Write(&source->Ring, pData, Len);
+  }
+
+  /* Nothing older can follow, dropped frame or not */
+  RxMerge_Advance(hmerge, Source, Timestamp);
+
+  return status;
+}
+
+/**
+  * @brief  Declare that a source will push no frame older than Timestamp.
+  * @note   Source side. Lets a source without traffic stop holding back the
+  *         others before Window elapses, e.g. on each idle line event.
+  * @param  hmerge    Merger handle.
+  * @param  Source    Source index.
+  * @param  Timestamp Watermark.
+  * @retval None
+  */
+void RxMerge_Advance(RxMerge_HandleTypeDef *hmerge, uint32_t Source, uint32_t Timestamp)
+{
+  RxMerge_SourceTypeDef *source = &hmerge->pSources[Source];
+
+  source->Watermark = Timestamp;
+  source->Started = 1U;
+}
+
+/**
+  * @brief  Move the staged records that are due to the output ring, oldest first.
+  * @note   Stops at the first record that must still wait or does not fit in the
+  *         output ring.
+  * @param  hmerge Merger handle.
+  * @param  Now    Current timestamp.
+  * @retval Number of records merged
+  */
+uint32_t RxMerge_Poll(RxMerge_HandleTypeDef *hmerge, uint32_t Now)
+{
+  RxMerge_SourceTypeDef *source;
+  uint8_t header[RXMERGE_HEADER_LENGTH];
+  uint32_t pending[8];        /* Sources with a complete record, one bit each */
+  const uint8_t *p;
+  uint32_t merged = 0U;
+  uint32_t best;
+  uint32_t best_ts = 0U;
+  uint32_t ts;
+  uint32_t i;
+  uint32_t index;
+  uint32_t left;
+  uint32_t n;
+  uint16_t len;
+  uint8_t waiting;
+  uint8_t flags;
+
+  for (;;)
+  {
+    /* Oldest complete record over all staging rings */
+    best = RXMERGE_NO_SOURCE;
+    for (i = 0U; i < hmerge->NumSources; i++)
+    {
+      if ((i & 31U) == 0U)
+      {
+        pending[i >> 5] = 0U;
+      }
+      if (RxMerge_PeekHeader(&hmerge->pSources[i].Ring, header) == 0U)
+      {
+        continue;
+      }
+      pending[i >> 5] |= 1UL << (i & 31U);
+      ts = (uint32_t)header[0] | ((uint32_t)header[1] << 8) | ((uint32_t)header[2] << 16)
+           | ((uint32_t)header[3] << 24);
+      if ((best == RXMERGE_NO_SOURCE) || ((int32_t)(ts - best_ts) < 0))
+      {
+        best = i;
+        best_ts = ts;
+      }
+    }
+    if (best == RXMERGE_NO_SOURCE)
+    {
+      break;
+    }
+
+    /* A source without a record at the scan may still deliver an older one, until Window */
+    waiting = 0U;
+    for (i = 0U; i < hmerge->NumSources; i++)
+    {
+      source = &hmerge->pSources[i];
+      if (((pending[i >> 5] & (1UL << (i & 31U))) == 0U)
+          && ((source->Started == 0U) || ((int32_t)(source->Watermark - best_ts) < 0)))
+      {
+        waiting = 1U;
+        break;
+      }
+    }
+    if ((waiting != 0U) && ((int32_t)(Now - best_ts) < (int32_t)hmerge->Window))
+    {
+      break;
+    }
+
+    source = &hmerge->pSources[best];
+    (void)RxMerge_PeekHeader(&source->Ring, header);
+    len = (uint16_t)((uint32_t)header[4] | ((uint32_t)header[5] << 8));
+    if (RingBuf_GetFree(&hmerge->Output) < (RXMERGE_HEADER_LENGTH + (uint32_t)len))
+    {
+      break;
+    }
+
+    flags = 0U;
+    if ((hmerge->MergedCount != 0U) && ((int32_t)(best_ts - hmerge->LastTimestamp) < 0))
+    {
+      flags = RXMERGE_FLAG_LATE;
+      hmerge->LateCount++;
+    }
+    else
+    {
+      hmerge->LastTimestamp = best_ts;
+    }
+    header[7] = flags;
+    (void)RingBuf_Write(&hmerge->Output, header, RXMERGE_HEADER_LENGTH);
+
+    /* Payload, in at most two segments of the staging ring */
+    index = RingBuf_GetReadIndex(&source->Ring) + RXMERGE_HEADER_LENGTH;
+    left = len;
+    while ((left > 0U) && ((n = RingBuf_Peek(&source->Ring, index, &p)) > 0U))
+    {
+      if (n > left)
+      {
+        n = left;
+      }
+      (void)RingBuf_Write(&hmerge->Output, p, n);
+      index += n;
+      left -= n;
+    }
+    RingBuf_ReleaseTo(&source->Ring, index);
+
+    hmerge->MergedCount++;
+    merged++;
+  }
+
+  return merged;
+}
+
+/**
+  * @brief  Get the oldest merged record.
+  * @note   The payload is read in place with RingBuf_Peek() on hmerge->Output,
+  *         from pRecord->Offset, then given back with RxMerge_Release().
+  * @param  hmerge  Merger handle.
+  * @param  pRecord Filled with the record descriptor.
+  * @retval 1 if a record was returned, 0 if none is available
+  */
+uint32_t RxMerge_GetRecord(RxMerge_HandleTypeDef *hmerge, RxMerge_RecordTypeDef *pRecord)
+{
+  uint8_t header[RXMERGE_HEADER_LENGTH];
+
+  if (RxMerge_PeekHeader(&hmerge->Output, header) == 0U)
+  {
+    return 0U;
+  }
+
+  pRecord->Timestamp = (uint32_t)header[0] | ((uint32_t)header[1] << 8) | ((uint32_t)header[2] << 16)
+                       | ((uint32_t)header[3] << 24);
+  pRecord->Length    = (uint16_t)((uint32_t)header[4] | ((uint32_t)header[5] << 8));
+  pRecord->Source    = header[6];
+  pRecord->Flags     = header[7];
+  pRecord->Offset    = RingBuf_GetReadIndex(&hmerge->Output) + RXMERGE_HEADER_LENGTH;
+
+  return 1U;
+}
+
+/**
+  * @brief  Give a record returned by RxMerge_GetRecord() back to the output ring.
+  * @param  hmerge  Merger handle.
+  * @param  pRecord Record descriptor.
+  * @retval None
+  */
+void RxMerge_Release(RxMerge_HandleTypeDef *hmerge, const RxMerge_RecordTypeDef *pRecord)
+{
+  RingBuf_ReleaseTo(&hmerge->Output, pRecord->Offset + pRecord->Length);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Copy the header of the oldest record of a ring, if the whole record is visible.
+  * @param  hring   Ring holding records.
+  * @param  pHeader Destination, RXMERGE_HEADER_LENGTH bytes.
+  * @retval 1 if a complete record is available, 0 otherwise
+  */
+static uint32_t RxMerge_PeekHeader(const RingBuf_HandleTypeDef *hring, uint8_t *pHeader)
+{
+  uint32_t count = RingBuf_GetCount(hring);
+  uint32_t index = RingBuf_GetReadIndex(hring);
+  const uint8_t *p;
+  uint32_t n;
+  uint32_t i = 0U;
+
+  if (count < RXMERGE_HEADER_LENGTH)
+  {
+    return 0U;
+  }
+
+  /* The header may cross the end of the ring storage */
+  while (i < RXMERGE_HEADER_LENGTH)
+  {
+    n = RingBuf_Peek(hring, index + i, &p);
+    while ((n > 0U) && (i < RXMERGE_HEADER_LENGTH))
+    {
+      pHeader[i] = *p;
+      p++;
+      n--;
+      i++;
+    }
+  }
+
+  return (count >= (RXMERGE_HEADER_LENGTH + ((uint32_t)pHeader[4] | ((uint32_t)pHeader[5] << 8)))) ? 1U : 0U;
+}
+
+/**
+  * @brief  Build a record header.
+  * @param  pHeader   Destination, RXMERGE_HEADER_LENGTH bytes.
+  * @param  Timestamp Arrival timestamp.
+  * @param  Len       Payload length.
+  * @param  Source    Source index.
+  * @param  Flags     RXMERGE_FLAG_xxx.
+  * @retval None
+  */
+static void RxMerge_PackHeader(uint8_t *pHeader, uint32_t Timestamp, uint16_t Len, uint8_t Source, uint8_t Flags)
+{
+  pHeader[0] = (uint8_t)Timestamp;
+  pHeader[1] = (uint8_t)(Timestamp >> 8);
+  pHeader[2] = (uint8_t)(Timestamp >> 16);
+  pHeader[3] = (uint8_t)(Timestamp >> 24);
+  pHeader[4] = (uint8_t)Len;
+  pHeader[5] = (uint8_t)(Len >> 8);
+  pHeader[6] = Source;
+  pHeader[7] = Flags;
+}
@@ -0,0 +1,179 @@
+/**
+  ******************************************************************************
+  * @file           : rx_timeout.c
+  * @brief          : End-of-frame timeout in character times on a hardware timer.
+  ******************************************************************************
+  * @attention
+  *
+  * The USART IDLE flag is raised after one idle character following the last
+  * stop bit, so RxTimeout_Start() is meant to be called on IDLE Rx events and
+  * only waits for the remaining (Timeout - 1 character). On expiry the Rx DMA
+  * counter is compared with the value sampled at start: if no byte arrived in
+  * between, the gap is reported through RxTimeout_ElapsedCallback().
+  * The timer interrupt should have the same priority as the USART and DMA
+  * interrupts of the monitored receiver.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rx_timeout.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Tenths of a character time already elapsed when IDLE is detected */
+#define RXTIMEOUT_IDLE_DETECTION      10U
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Configure the timer for the gap length given in htimeout->Timeout.
+  * @note   The timer clock must be enabled and its interrupt configured by the
+  *         caller. Must be called again if the receiver Init parameters or the
+  *         bus clocks change.
+  * @param  htimeout Timeout handle, Instance, hDMAIdleReciever and Timeout filled.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef RxTimeout_Init(RxTimeout_HandleTypeDef *htimeout)
+{
+  DMAIdleReciever_InitTypeDef *init;
+  uint32_t timclk;
+  uint32_t apb_div1;
+  uint32_t bits;
+  uint32_t max_arr;
+  uint32_t psc;
+  uint64_t ticks;
+
+  if ((htimeout == NULL) || (htimeout->Instance == NULL) || (htimeout->hDMAIdleReciever == NULL)
+      || (htimeout->hDMAIdleReciever->Init.BaudRate == 0U))
+  {
+    return HAL_ERROR;
+  }
+  init = &htimeout->hDMAIdleReciever->Init;
+
+  /* Timers run at twice the APB clock when the APB prescaler is not 1 */
+  if ((uint32_t)htimeout->Instance >= APB2PERIPH_BASE)
+  {
+    timclk = HAL_RCC_GetPCLK2Freq();
+    apb_div1 = ((RCC->CFGR & RCC_CFGR_PPRE2) == RCC_CFGR_PPRE2_DIV1);
+  }
+  else
+  {
+    timclk = HAL_RCC_GetPCLK1Freq();
+    apb_div1 = ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_CFGR_PPRE1_DIV1);
+  }
+  if (apb_div1 == 0U)
+  {
+    timclk *= 2U;
+  }
+
+  /* Start bit, data bits (parity included) and stop bits */
+  bits = 1U + ((init->WordLength == DMAIdleReciever_WORDLENGTH_9B) ? 9U : 8U)
+         + ((init->StopBits == DMAIdleReciever_STOPBITS_2) ? 2U : 1U);
+
+  htimeout->ArmedCount = 0U;
+  htimeout->ElapsedCount = 0U;
+  htimeout->Instance->CR1 = 0U;
+  htimeout->Instance->DIER = 0U;
+
+  if (htimeout->Timeout <= RXTIMEOUT_IDLE_DETECTION)
+  {
+    /* The IDLE event itself marks the end of frame */
+    htimeout->Ticks = 0U;
+    return HAL_OK;
+  }
+
+  ticks = ((uint64_t)timclk * bits * (htimeout->Timeout - RXTIMEOUT_IDLE_DETECTION))
+          / ((uint64_t)init->BaudRate * 10U);
+  if (ticks == 0U)
+  {
+    ticks = 1U;
+  }
+
+  max_arr = ((htimeout->Instance == TIM2) || (htimeout->Instance == TIM5)) ? 0xFFFFFFFFU : 0xFFFFU;
+  psc = (uint32_t)((ticks - 1U) / ((uint64_t)max_arr + 1U));
+  if (psc > 0xFFFFU)
+  {
+    return HAL_ERROR;
+  }
+  htimeout->Ticks = (uint32_t)(ticks / (psc + 1U));
+
+  /* One-pulse, update event on overflow only */
+  htimeout->Instance->CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+  htimeout->Instance->PSC = psc;
+  htimeout->Instance->ARR = htimeout->Ticks - 1U;
+  htimeout->Instance->EGR = TIM_EGR_UG;
+  htimeout->Instance->SR = 0U;
+  htimeout->Instance->DIER = TIM_DIER_UIE;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  (Re)start the gap measurement, to be called on each IDLE Rx event.
+  * @note   With a Timeout of 10 or less, IDLE already is the end of frame and
+  *         RxTimeout_ElapsedCallback() runs before this function returns: call it
+  *         after the bytes of the IDLE event are handed to the application.
+  * @param  htimeout Timeout handle.
+  * @retval None
+  */
+void RxTimeout_Start(RxTimeout_HandleTypeDef *htimeout)
+{
+  if (htimeout->Ticks == 0U)
+  {
+    htimeout->ElapsedCount++;
+    RxTimeout_ElapsedCallback(htimeout);
+    return;
+  }
+
+  htimeout->Instance->CR1 &= ~TIM_CR1_CEN;
+  htimeout->Instance->CNT = 0U;
+  htimeout->Instance->SR = (uint32_t)~TIM_SR_UIF;
+  htimeout->ArmedCount = __HAL_DMA_GET_COUNTER(htimeout->hDMAIdleReciever->hdmarx);
+  htimeout->Instance->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+  * @brief  Cancel a pending gap measurement.
+  * @param  htimeout Timeout handle.
+  * @retval None
+  */
+void RxTimeout_Stop(RxTimeout_HandleTypeDef *htimeout)
+{
+  htimeout->Instance->CR1 &= ~TIM_CR1_CEN;
+  htimeout->Instance->SR = (uint32_t)~TIM_SR_UIF;
+}
+
+/**
+  * @brief  Handle the timer update interrupt.
+  * @param  htimeout Timeout handle.
+  * @retval None
+  */
+void RxTimeout_IRQHandler(RxTimeout_HandleTypeDef *htimeout)
+{
+  if ((htimeout->Instance->SR & TIM_SR_UIF) == 0U)
+  {
+    return;
+  }
+  htimeout->Instance->SR = (uint32_t)~TIM_SR_UIF;
+
+  /* A byte received after IDLE means the gap was shorter than the timeout */
+  if (__HAL_DMA_GET_COUNTER(htimeout->hDMAIdleReciever->hdmarx) == htimeout->ArmedCount)
+  {
+    htimeout->ElapsedCount++;
+    RxTimeout_ElapsedCallback(htimeout);
+  }
+}
+
+/**
+  * @brief  End-of-frame timeout callback.
+  * @param  htimeout Timeout handle.
+  * @retval None
+  */
+__weak void RxTimeout_ElapsedCallback(RxTimeout_HandleTypeDef *htimeout)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(htimeout);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the RxTimeout_ElapsedCallback can be implemented in the user file.
+   */
+}
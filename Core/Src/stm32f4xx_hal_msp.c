@@ -21,9 +21,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 /* USER CODE BEGIN Includes */
-
+#include "uart_port.h"
 /* USER CODE END Includes */
-extern DMA_HandleTypeDef hdma_usart1_rx;
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN TD */
@@ -72,105 +71,40 @@ void HAL_MspInit(void)
   __HAL_RCC_PWR_CLK_ENABLE();
 
   /* System interrupt init*/
+  /* PendSV_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(PendSV_IRQn, 15, 0);
 
   /* USER CODE BEGIN MspInit 1 */
-
+  /* DWT cycle counter for Rx Event timestamps and auto-baud edge stamps */
+  HAL_DMAIdleRecieverEx_TimestampInit();
   /* USER CODE END MspInit 1 */
 }
 
+/* USER CODE BEGIN 1 */
+/* The U(S)ARTs are not configured in DMAIdleReciever.ioc, so CubeMX does not
+   generate their MSP: the port registry provides it for every port */
+
 /**
   * @brief DMAIdleReciever MSP Initialization
-  * This function configures the hardware resources used in this example
+  * This function configures the hardware resources of a registered port
   * @param hDMAIdleReciever: DMAIdleReciever handle pointer
   * @retval None
   */
 void HAL_DMAIdleReciever_MspInit(DMAIdleReciever_HandleTypeDef* hDMAIdleReciever)
 {
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
-  if(hDMAIdleReciever->Instance==USART1)
-  {
-    /* USER CODE BEGIN USART1_MspInit 0 */
-
-    /* USER CODE END USART1_MspInit 0 */
-    /* Peripheral clock enable */
-    __HAL_RCC_USART1_CLK_ENABLE();
-
-    __HAL_RCC_GPIOA_CLK_ENABLE();
-    /**USART1 GPIO Configuration
-    PA9     ------> USART1_TX
-    PA10     ------> USART1_RX
-    */
-    GPIO_InitStruct.Pin = GPIO_PIN_9|GPIO_PIN_10;
-    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-    GPIO_InitStruct.Alternate = GPIO_AF7_USART1;
-    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
-    /* USART1 DMA Init */
-    /* USART1_RX Init */
-    hdma_usart1_rx.Instance = DMA2_Stream2;
-    hdma_usart1_rx.Init.Channel = DMA_CHANNEL_4;
-    hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
-    hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
-    hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
-    hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
-    hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
-    hdma_usart1_rx.Init.Priority = DMA_PRIORITY_LOW;
-    hdma_usart1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
-    if (HAL_DMA_Init(&hdma_usart1_rx) != HAL_OK)
-    {
-      Error_Handler();
-    }
-
-    __HAL_LINKDMA(hDMAIdleReciever,hdmarx,hdma_usart1_rx);
-
-    /* USART1 interrupt Init */
-    HAL_NVIC_SetPriority(USART1_IRQn, 0, 0);
-    HAL_NVIC_EnableIRQ(USART1_IRQn);
-    /* USER CODE BEGIN USART1_MspInit 1 */
-
-    /* USER CODE END USART1_MspInit 1 */
-
-  }
-
+  /* Clock, GPIO, Rx DMA and NVIC of the ports registered with UartPort_Init() */
+  UartPort_MspInit(hDMAIdleReciever);
 }
 
 /**
   * @brief DMAIdleReciever MSP De-Initialization
-  * This function freeze the hardware resources used in this example
+  * This function freeze the hardware resources of a registered port
   * @param hDMAIdleReciever: DMAIdleReciever handle pointer
   * @retval None
   */
 void HAL_DMAIdleReciever_MspDeInit(DMAIdleReciever_HandleTypeDef* hDMAIdleReciever)
 {
-  if(hDMAIdleReciever->Instance==USART1)
-  {
-    /* USER CODE BEGIN USART1_MspDeInit 0 */
-
-    /* USER CODE END USART1_MspDeInit 0 */
-    /* Peripheral clock disable */
-    __HAL_RCC_USART1_CLK_DISABLE();
-
-    /**USART1 GPIO Configuration
-    PA9     ------> USART1_TX
-    PA10     ------> USART1_RX
-    */
-    HAL_GPIO_DeInit(GPIOA, GPIO_PIN_9|GPIO_PIN_10);
-
-    /* USART1 DMA DeInit */
-    HAL_DMA_DeInit(hDMAIdleReciever->hdmarx);
-
-    /* USART1 interrupt DeInit */
-    HAL_NVIC_DisableIRQ(USART1_IRQn);
-    /* USER CODE BEGIN USART1_MspDeInit 1 */
-
-    /* USER CODE END USART1_MspDeInit 1 */
-  }
-
+  UartPort_MspDeInit(hDMAIdleReciever);
 }
 
-/* USER CODE BEGIN 1 */
-
 /* USER CODE END 1 */
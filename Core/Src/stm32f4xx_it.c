@@ -22,6 +22,11 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "rx_deferred.h"
+#include "rx_timeout.h"
+#include "uart_port.h"
+#include "autobaud.h"
+#include "flash_log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -51,15 +56,18 @@
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-extern int enable_timer;
-extern uint16_t timer;
+
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
-extern DMA_HandleTypeDef hdma_usart1_rx;
-extern DMAIdleReciever_HandleTypeDef hDMAIdleReciever1;
 /* USER CODE BEGIN EV */
-
+extern RxTimeout_HandleTypeDef hRxTimeout;
+#if (RX_AUTOBAUD == 1)
+extern AutoBaud_HandleTypeDef hAutoBaud;
+#endif
+#if (FLASH_LOG == 1)
+extern FlashLog_HandleTypeDef hFlashLog;
+#endif
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -172,7 +180,9 @@ void DebugMon_Handler(void)
 void PendSV_Handler(void)
 {
   /* USER CODE BEGIN PendSV_IRQn 0 */
-
+#if (RX_DEFERRED_PROCESSING == 1)
+  RxDeferred_Process();
+#endif
   /* USER CODE END PendSV_IRQn 0 */
   /* USER CODE BEGIN PendSV_IRQn 1 */
 
@@ -189,7 +199,9 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
-  if (enable_timer==1) timer++;
+  /* Keep the 64-bit Rx timestamp clock exact across DWT->CYCCNT wraps */
+  (void)HAL_DMAIdleRecieverEx_GetCycles();
+
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -200,34 +212,39 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32f4xx.s).                    */
 /******************************************************************************/
 
+/* USER CODE BEGIN 1 */
+
+/* USART and Rx DMA stream handlers of every port, dispatched through the port registry */
+UARTPORT_TABLE(UARTPORT_DEFINE_IRQ_HANDLERS)
+
+/* Tx DMA stream handlers of the ports that transmit with DMA */
+UARTPORT_TX_TABLE(UARTPORT_DEFINE_TX_IRQ_HANDLER)
+
 /**
-  * @brief This function handles USART1 global interrupt.
+  * @brief This function handles TIM2 global interrupt (USART1 end-of-frame timeout).
   */
-void USART1_IRQHandler(void)
+void TIM2_IRQHandler(void)
 {
-  /* USER CODE BEGIN USART1_IRQn 0 */
-
-  /* USER CODE END USART1_IRQn 0 */
-  HAL_DMAIdleReciever_IRQHandler(&hDMAIdleReciever1);
-  /* USER CODE BEGIN USART1_IRQn 1 */
-
-  /* USER CODE END USART1_IRQn 1 */
+  RxTimeout_IRQHandler(&hRxTimeout);
 }
 
+#if (RX_AUTOBAUD == 1)
 /**
-  * @brief This function handles DMA2 stream2 global interrupt.
+  * @brief This function handles EXTI line[15:10] interrupts (USART1 RX edges on PA10).
   */
-void DMA2_Stream2_IRQHandler(void)
+void EXTI15_10_IRQHandler(void)
 {
-  /* USER CODE BEGIN DMA2_Stream2_IRQn 0 */
-
-  /* USER CODE END DMA2_Stream2_IRQn 0 */
-  HAL_DMA_IRQHandler(&hdma_usart1_rx);
-  /* USER CODE BEGIN DMA2_Stream2_IRQn 1 */
-
-  /* USER CODE END DMA2_Stream2_IRQn 1 */
+  AutoBaud_IRQHandler(&hAutoBaud);
 }
+#endif
 
-/* USER CODE BEGIN 1 */
-
+#if (FLASH_LOG == 1)
+/**
+  * @brief This function handles FLASH global interrupt (flash log programming and erase).
+  */
+void FLASH_IRQHandler(void)
+{
+  FlashLog_IRQHandler(&hFlashLog);
+}
+#endif
 /* USER CODE END 1 */
@@ -29,6 +29,7 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include "log_stream.h"
 
 
 /* Variables */
@@ -82,6 +83,12 @@ __attribute__((weak)) int _write(int file, char *ptr, int len)
   (void)file;
   int DataIdx;
 
+  /* Non-blocking, drained by the Tx DMA, once a stream is selected */
+  if (LogStream_WriteStdout(ptr, len) >= 0)
+  {
+    return len;
+  }
+
   for (DataIdx = 0; DataIdx < len; DataIdx++)
   {
     __io_putchar(*ptr++);
@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file           : tx_queue.c
+  * @brief          : Queue of buffers transmitted back-to-back by the Tx DMA.
+  ******************************************************************************
+  * @attention
+  *
+  * Descriptors [Tail, Head) are pending, the one at Tail being transmitted
+  * while Running is set. Producers only move Head, inside a short PRIMASK
+  * section so that several contexts may send. Tail is only moved from the
+  * port interrupts (Tx DMA stream and USART, at the same priority) or by the
+  * producer that finds the queue idle and starts it. Running is cleared
+  * under the same PRIMASK section that checks for a new descriptor, so a
+  * descriptor queued while the last transfer ends cannot be stranded.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "tx_queue.h"
+
+/* Private macro -------------------------------------------------------------*/
+#define TXQUEUE_LOAD_ACQUIRE(__IDX__)         __atomic_load_n(&(__IDX__), __ATOMIC_ACQUIRE)
+#define TXQUEUE_STORE_RELEASE(__IDX__, __V__) __atomic_store_n(&(__IDX__), (__V__), __ATOMIC_RELEASE)
+
+/* Private function prototypes -----------------------------------------------*/
+static void TxQueue_Start(TxQueue_HandleTypeDef *htxq);
+static void TxQueue_Drop(TxQueue_HandleTypeDef *htxq);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a transmit queue on top of a caller provided descriptor array.
+  * @param  htxq   Transmit queue handle.
+  * @param  hDMAIdleReciever Port, initialized, with its Tx DMA stream linked (hdmatx).
+  * @param  pDesc  Descriptor storage.
+  * @param  Size   Number of descriptors, must be a non-zero power of two.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef TxQueue_Init(TxQueue_HandleTypeDef *htxq, DMAIdleReciever_HandleTypeDef *hDMAIdleReciever,
+                               TxQueue_DescTypeDef *pDesc, uint32_t Size)
+{
+  if ((htxq == NULL) || (hDMAIdleReciever == NULL) || (hDMAIdleReciever->hdmatx == NULL) || (pDesc == NULL)
+      || (Size == 0U) || ((Size & (Size - 1U)) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  htxq->hDMAIdleReciever = hDMAIdleReciever;
+  htxq->pDesc            = pDesc;
+  htxq->Size             = Size;
+  htxq->Head             = 0U;
+  htxq->Tail             = 0U;
+  htxq->Running          = 0U;
+  htxq->HighWater        = 0U;
+  htxq->FullCount        = 0U;
+  htxq->SentBytes        = 0U;
+  htxq->ErrorCount       = 0U;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Queue a buffer for transmission and start the Tx DMA if it is idle.
+  * @note   Returns at once. The buffer is transmitted in place and must not change
+  *         until TxQueue_SentCallback() reports it; a string literal or const table
+  *         in flash needs no copy.
+  * @param  htxq  Transmit queue handle.
+  * @param  pData Buffer, in flash or SRAM.
+  * @param  Len   Number of bytes.
+  * @retval HAL_BUSY if the queue is full, HAL_ERROR for an empty buffer or a buffer
+  *         in CCM RAM, which the DMA cannot read
+  */
+HAL_StatusTypeDef TxQueue_Send(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len)
+{
+  TxQueue_DescTypeDef *desc;
+  uint32_t primask;
+  uint32_t head;
+  uint32_t used;
+  uint32_t idle;
+
+  if ((pData == NULL) || (Len == 0U) || !IS_DMAIdleReciever_DMA_BUFFER(pData))
+  {
+    return HAL_ERROR;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  head = htxq->Head;
+  used = head - htxq->Tail;
+  if (used >= htxq->Size)
+  {
+    htxq->FullCount++;
+    __set_PRIMASK(primask);
+    return HAL_BUSY;
+  }
+
+  desc = &htxq->pDesc[head & (htxq->Size - 1U)];
+  desc->pData = pData;
+  desc->Len = Len;
+  TXQUEUE_STORE_RELEASE(htxq->Head, head + 1U);
+  if ((used + 1U) > htxq->HighWater)
+  {
+    htxq->HighWater = used + 1U;
+  }
+
+  idle = (htxq->Running == 0U);
+  htxq->Running = 1U;
+
+  __set_PRIMASK(primask);
+
+  /* The port interrupts stay out of the queue until this transfer is started */
+  if (idle)
+  {
+    TxQueue_Start(htxq);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Number of descriptors queued or being transmitted.
+  * @param  htxq Transmit queue handle.
+  * @retval Pending descriptors
+  */
+uint32_t TxQueue_GetPending(const TxQueue_HandleTypeDef *htxq)
+{
+  return htxq->Head - htxq->Tail;
+}
+
+/**
+  * @brief  Chain the next descriptor. To be called from
+  *         HAL_DMAIdleRecieverEx_TxDmaCpltCallback() of the port.
+  * @note   The Tx DMA stream has read the whole buffer at Tail: it is reported as sent
+  *         and the next one, if any, is started while the USART still shifts out the
+  *         last bytes. Otherwise TxQueue_TxCpltCallback() follows once the line is idle.
+  * @param  htxq Transmit queue handle.
+  * @retval None
+  */
+void TxQueue_TxDmaCpltCallback(TxQueue_HandleTypeDef *htxq)
+{
+  const TxQueue_DescTypeDef *next;
+  TxQueue_DescTypeDef sent;
+  uint32_t tail = htxq->Tail;
+
+  if (htxq->Running == 0U)
+  {
+    return;
+  }
+
+  sent = htxq->pDesc[tail & (htxq->Size - 1U)];
+  tail++;
+  htxq->SentBytes += sent.Len;
+  TXQUEUE_STORE_RELEASE(htxq->Tail, tail);
+  TxQueue_SentCallback(htxq, sent.pData, sent.Len);
+
+  if (tail != TXQUEUE_LOAD_ACQUIRE(htxq->Head))
+  {
+    next = &htxq->pDesc[tail & (htxq->Size - 1U)];
+    /* On failure, the descriptor is started from TxQueue_TxCpltCallback() */
+    (void)HAL_DMAIdleRecieverEx_ContinueTransmit_DMA(htxq->hDMAIdleReciever, next->pData, next->Len);
+  }
+}
+
+/**
+  * @brief  Restart the queue once the line is idle. To be called from
+  *         HAL_DMAIdleReciever_TxCpltCallback() of the port.
+  * @note   Starts a descriptor queued after the last chaining opportunity, or marks the
+  *         queue idle.
+  * @param  htxq Transmit queue handle.
+  * @retval None
+  */
+void TxQueue_TxCpltCallback(TxQueue_HandleTypeDef *htxq)
+{
+  if (htxq->Running != 0U)
+  {
+    TxQueue_Start(htxq);
+  }
+}
+
+/**
+  * @brief  Recover from a transmission error. To be called from
+  *         HAL_DMAIdleReciever_ErrorCallback() of the port.
+  * @note   A Tx DMA error ends the transmission: the descriptor being transmitted is
+  *         dropped and the next one started. Reception errors, which leave the
+  *         transmission running, are ignored.
+  * @param  htxq Transmit queue handle.
+  * @retval None
+  */
+void TxQueue_ErrorCallback(TxQueue_HandleTypeDef *htxq)
+{
+  if ((htxq->Running != 0U) && (htxq->hDMAIdleReciever->gState == HAL_DMAIdleReciever_STATE_READY)
+      && (htxq->Tail != TXQUEUE_LOAD_ACQUIRE(htxq->Head)))
+  {
+    TxQueue_Drop(htxq);
+    TxQueue_Start(htxq);
+  }
+}
+
+/**
+  * @brief  Restart the queue after the transmission of its port was aborted, e.g. by
+  *         UartPort_SetBaudRate(), which reports nothing to the queue.
+  * @note   The descriptors pending at the call, including the one partly transmitted,
+  *         are dropped and reported through TxQueue_SentCallback(); descriptors queued
+  *         meanwhile, e.g. from that callback, are then started. To be called once the
+  *         port is ready again, before any other transmission on it.
+  * @param  htxq Transmit queue handle.
+  * @retval None
+  */
+void TxQueue_Abort(TxQueue_HandleTypeDef *htxq)
+{
+  uint32_t head = TXQUEUE_LOAD_ACQUIRE(htxq->Head);
+
+  if (htxq->Running == 0U)
+  {
+    return;
+  }
+
+  while (htxq->Tail != head)
+  {
+    TxQueue_Drop(htxq);
+  }
+  TxQueue_Start(htxq);
+}
+
+/**
+  * @brief  Buffer sent callback, executed in Tx DMA or USART interrupt context.
+  * @note   The buffer has been read by the DMA, or dropped on an error, and may be reused.
+  * @param  htxq  Transmit queue handle.
+  * @param  pData Buffer given to TxQueue_Send().
+  * @param  Len   Number of bytes given to TxQueue_Send().
+  * @retval None
+  */
+__weak void TxQueue_SentCallback(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(htxq);
+  UNUSED(pData);
+  UNUSED(Len);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the TxQueue_SentCallback can be implemented in the user file.
+   */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Start the descriptor at Tail with the port idle, or mark the queue idle.
+  * @note   A descriptor the driver refuses is dropped and the next one tried.
+  * @param  htxq Transmit queue handle.
+  * @retval None
+  */
+static void TxQueue_Start(TxQueue_HandleTypeDef *htxq)
+{
+  const TxQueue_DescTypeDef *desc;
+  uint32_t primask;
+
+  for (;;)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (htxq->Tail == htxq->Head)
+    {
+      htxq->Running = 0U;
+      __set_PRIMASK(primask);
+      return;
+    }
+    __set_PRIMASK(primask);
+
+    desc = &htxq->pDesc[htxq->Tail & (htxq->Size - 1U)];
+    if (HAL_DMAIdleReciever_Transmit_DMA(htxq->hDMAIdleReciever, desc->pData, desc->Len) == HAL_OK)
+    {
+      return;
+    }
+    TxQueue_Drop(htxq);
+  }
+}
+
+/**
+  * @brief  Drop the descriptor at Tail, which was not transmitted.
+  * @param  htxq Transmit queue handle.
+  * @retval None
+  */
+static void TxQueue_Drop(TxQueue_HandleTypeDef *htxq)
+{
+  TxQueue_DescTypeDef dropped = htxq->pDesc[htxq->Tail & (htxq->Size - 1U)];
+
+  htxq->ErrorCount++;
+  TXQUEUE_STORE_RELEASE(htxq->Tail, htxq->Tail + 1U);
+  TxQueue_SentCallback(htxq, dropped.pData, dropped.Len);
+}
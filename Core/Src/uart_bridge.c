@@ -0,0 +1,331 @@
+/**
+  ******************************************************************************
+  * @file           : uart_bridge.c
+  * @brief          : Forwarding of the bytes received on one port to another.
+  ******************************************************************************
+  * @attention
+  *
+  * Regions [RegionTail, RegionHead) are transmitted in place. They are added
+  * by UartBridge_Forward() and removed, in order, by UartBridge_SentCallback()
+  * in the egress Tx context; the ingress Rx view is only read and released by
+  * UartBridge_Forward(), up to the oldest region not yet sent. The staging
+  * ring is filled by UartBridge_Forward() and drained by one run at a time:
+  * StageBusy, taken under a short PRIMASK section, decides which context
+  * queues the next run. A region is only sent in place when the staging ring
+  * is empty, so bytes leave in reception order.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_bridge.h"
+
+/* Private macro -------------------------------------------------------------*/
+#define UARTBRIDGE_LOAD_ACQUIRE(__IDX__)         __atomic_load_n(&(__IDX__), __ATOMIC_ACQUIRE)
+#define UARTBRIDGE_STORE_RELEASE(__IDX__, __V__) __atomic_store_n(&(__IDX__), (__V__), __ATOMIC_RELEASE)
+
+/* Private function prototypes -----------------------------------------------*/
+static void UartBridge_Queue(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint32_t Len,
+                             uint32_t Timestamp);
+static void UartBridge_StageStart(UartBridge_HandleTypeDef *hbridge);
+static void UartBridge_Release(UartBridge_HandleTypeDef *hbridge);
+static void UartBridge_Latency(UartBridge_HandleTypeDef *hbridge, uint32_t Cycles);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a bridge between two ports.
+  * @param  hbridge   Bridge handle.
+  * @param  hIngress  Port whose received bytes are forwarded, received with a circular Rx DMA.
+  * @param  hEgress   Transmit queue of the port the bytes are forwarded to, initialized.
+  * @param  pStage    Staging ring storage, in SRAM1/SRAM2.
+  * @param  StageSize Staging ring size, must be a non-zero power of two.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef UartBridge_Init(UartBridge_HandleTypeDef *hbridge, DMAIdleReciever_HandleTypeDef *hIngress,
+                                  TxQueue_HandleTypeDef *hEgress, uint8_t *pStage, uint32_t StageSize)
+{
+  if ((hbridge == NULL) || (hIngress == NULL) || (hEgress == NULL) || (pStage == NULL)
+      || !IS_DMAIdleReciever_DMA_BUFFER(pStage))
+  {
+    return HAL_ERROR;
+  }
+
+  if (RingBuf_Init(&hbridge->Stage, pStage, StageSize) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  hbridge->hIngress          = hIngress;
+  hbridge->hEgress           = hEgress;
+  hbridge->RegionHead        = 0U;
+  hbridge->RegionTail        = 0U;
+  hbridge->Forwarded         = hIngress->RxConsumedCount;
+  hbridge->InPlaceQueued     = 0U;
+  hbridge->InPlaceSent       = 0U;
+  hbridge->StagedSent        = 0U;
+  hbridge->StageBusy         = 0U;
+  hbridge->pStageRun         = NULL;
+  hbridge->StageRunTimestamp = 0U;
+  hbridge->StageTimestamp    = 0U;
+  hbridge->LatencyLast       = 0U;
+  hbridge->LatencyMax        = 0U;
+  hbridge->BacklogMax        = 0U;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Forward the bytes received since the last call and release those already sent.
+  * @note   To be called from the Rx Event context of the ingress port, in place of
+  *         HAL_DMAIdleRecieverEx_ReleaseRxData(). Bytes the Rx DMA overwrote before they
+  *         were forwarded are skipped and counted by the driver (RxLostCount).
+  * @param  hbridge Bridge handle.
+  * @retval None
+  */
+void UartBridge_Forward(UartBridge_HandleTypeDef *hbridge)
+{
+  DMAIdleReciever_RxViewTypeDef view;
+  const uint8_t *seg[2];
+  uint32_t len[2];
+  uint32_t timestamp;
+  uint32_t skip;
+  uint32_t backlog;
+  uint32_t i;
+
+  if (HAL_DMAIdleRecieverEx_GetRxView(hbridge->hIngress, &view) != HAL_OK)
+  {
+    return;
+  }
+
+  timestamp = (uint32_t)HAL_DMAIdleRecieverEx_GetRxEventTimestamp(hbridge->hIngress);
+  seg[0] = view.pData1;
+  len[0] = view.Size1;
+  seg[1] = view.pData2;
+  len[1] = view.Size2;
+
+  /* The view starts at the oldest byte not released, the bytes already forwarded
+     are skipped. Outside of the view, reception was restarted or the Rx DMA
+     lapped the bytes held for the egress port: resynchronize on the view. */
+  skip = hbridge->Forwarded - hbridge->hIngress->RxConsumedCount;
+  if (skip > (len[0] + len[1]))
+  {
+    hbridge->Forwarded = hbridge->hIngress->RxConsumedCount;
+    skip = 0U;
+  }
+
+  for (i = 0U; i < 2U; i++)
+  {
+    if (skip >= len[i])
+    {
+      skip -= len[i];
+      continue;
+    }
+    UartBridge_RxCallback(hbridge, &seg[i][skip], len[i] - skip);
+    UartBridge_Queue(hbridge, &seg[i][skip], len[i] - skip, timestamp);
+    hbridge->Forwarded += len[i] - skip;
+    skip = 0U;
+  }
+
+  UartBridge_StageStart(hbridge);
+  UartBridge_Release(hbridge);
+
+  backlog = UartBridge_GetBacklog(hbridge);
+  if (backlog > hbridge->BacklogMax)
+  {
+    hbridge->BacklogMax = backlog;
+  }
+}
+
+/**
+  * @brief  Number of bytes forwarded and not yet read by the egress Tx DMA.
+  * @param  hbridge Bridge handle.
+  * @retval Bytes held in place in the ingress Rx DMA buffer and in the staging ring
+  */
+uint32_t UartBridge_GetBacklog(const UartBridge_HandleTypeDef *hbridge)
+{
+  return (hbridge->InPlaceQueued - UARTBRIDGE_LOAD_ACQUIRE(hbridge->InPlaceSent))
+         + RingBuf_GetCount(&hbridge->Stage);
+}
+
+/**
+  * @brief  Account for a buffer sent by the egress queue. To be called from
+  *         TxQueue_SentCallback() of the egress queue.
+  * @note   Buffers the bridge did not queue are ignored. A staging run that completes
+  *         is released and the next one queued.
+  * @param  hbridge Bridge handle.
+  * @param  pData   Buffer reported by TxQueue_SentCallback().
+  * @param  Len     Number of bytes reported by TxQueue_SentCallback().
+  * @retval None
+  */
+void UartBridge_SentCallback(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint16_t Len)
+{
+  const UartBridge_RegionTypeDef *region;
+  uint32_t tail = hbridge->RegionTail;
+  uint32_t now = (uint32_t)HAL_DMAIdleRecieverEx_GetCycles();
+
+  region = &hbridge->Region[tail & (UARTBRIDGE_MAX_REGIONS - 1U)];
+  if ((tail != UARTBRIDGE_LOAD_ACQUIRE(hbridge->RegionHead)) && (region->pData == pData))
+  {
+    /* Released to the Rx DMA by the next UartBridge_Forward() */
+    UartBridge_Latency(hbridge, now - region->Timestamp);
+    UARTBRIDGE_STORE_RELEASE(hbridge->InPlaceSent, hbridge->InPlaceSent + Len);
+    UARTBRIDGE_STORE_RELEASE(hbridge->RegionTail, tail + 1U);
+  }
+  else if ((hbridge->StageBusy != 0U) && (pData == hbridge->pStageRun))
+  {
+    UartBridge_Latency(hbridge, now - hbridge->StageRunTimestamp);
+    hbridge->StagedSent += Len;
+    RingBuf_ReleaseTo(&hbridge->Stage, RingBuf_GetReadIndex(&hbridge->Stage) + Len);
+    hbridge->StageBusy = 0U;
+  }
+
+  /* A descriptor of the egress queue is free again */
+  UartBridge_StageStart(hbridge);
+}
+
+/**
+  * @brief  Received region callback, executed in the context of UartBridge_Forward().
+  * @note   Each received byte is reported once, in order, in place in the ingress Rx DMA
+  *         buffer, before it is forwarded.
+  * @param  hbridge Bridge handle.
+  * @param  pData   First byte of the region.
+  * @param  Len     Number of bytes.
+  * @retval None
+  */
+__weak void UartBridge_RxCallback(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint32_t Len)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hbridge);
+  UNUSED(pData);
+  UNUSED(Len);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the UartBridge_RxCallback can be implemented in the user file.
+   */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Queue a received region in place, or copy it into the staging ring.
+  * @note   In place requires the egress port to drain the Rx DMA buffer at least as
+  *         fast as the ingress port refills it, and the regions held to stay within
+  *         half of that buffer, so that the Rx DMA cannot lap them.
+  * @param  hbridge   Bridge handle.
+  * @param  pData     First byte, in the ingress Rx DMA buffer.
+  * @param  Len       Number of bytes.
+  * @param  Timestamp DWT cycle count of the Rx Event that reported the region.
+  * @retval None
+  */
+static void UartBridge_Queue(UartBridge_HandleTypeDef *hbridge, const uint8_t *pData, uint32_t Len,
+                             uint32_t Timestamp)
+{
+  UartBridge_RegionTypeDef *region;
+  uint32_t head = hbridge->RegionHead;
+
+  if ((hbridge->hIngress->Init.BaudRate <= hbridge->hEgress->hDMAIdleReciever->Init.BaudRate)
+      && (RingBuf_GetCount(&hbridge->Stage) == 0U)
+      && ((head - UARTBRIDGE_LOAD_ACQUIRE(hbridge->RegionTail)) < UARTBRIDGE_MAX_REGIONS)
+      && (((hbridge->InPlaceQueued - UARTBRIDGE_LOAD_ACQUIRE(hbridge->InPlaceSent)) + Len)
+          <= (hbridge->hIngress->RxXferSize / 2U)))
+  {
+    /* Published first: the egress Tx DMA may complete it before TxQueue_Send() returns */
+    region = &hbridge->Region[head & (UARTBRIDGE_MAX_REGIONS - 1U)];
+    region->pData = pData;
+    region->Len = (uint16_t)Len;
+    region->End = hbridge->Forwarded + Len;
+    region->Timestamp = Timestamp;
+    hbridge->InPlaceQueued += Len;
+    UARTBRIDGE_STORE_RELEASE(hbridge->RegionHead, head + 1U);
+
+    if (TxQueue_Send(hbridge->hEgress, pData, (uint16_t)Len) == HAL_OK)
+    {
+      return;
+    }
+
+    /* Egress queue full: the region was never queued */
+    hbridge->InPlaceQueued -= Len;
+    UARTBRIDGE_STORE_RELEASE(hbridge->RegionHead, head);
+  }
+
+  /* Bytes that do not fit are counted by the ring (DroppedBytes) */
+  (void)RingBuf_Write(&hbridge->Stage, pData, Len);
+  hbridge->StageTimestamp = Timestamp;
+}
+
+/**
+  * @brief  Queue the oldest contiguous run of the staging ring, unless a run is queued.
+  * @note   On a full egress queue, the run is queued again when the queue sends a
+  *         buffer or on the next UartBridge_Forward().
+  * @param  hbridge Bridge handle.
+  * @retval None
+  */
+static void UartBridge_StageStart(UartBridge_HandleTypeDef *hbridge)
+{
+  const uint8_t *p;
+  uint32_t primask;
+  uint32_t n;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((hbridge->StageBusy != 0U) || (RingBuf_GetCount(&hbridge->Stage) == 0U))
+  {
+    __set_PRIMASK(primask);
+    return;
+  }
+  hbridge->StageBusy = 1U;
+  __set_PRIMASK(primask);
+
+  n = RingBuf_Peek(&hbridge->Stage, RingBuf_GetReadIndex(&hbridge->Stage), &p);
+  if (n > 0xFFFFU)
+  {
+    n = 0xFFFFU;
+  }
+  hbridge->pStageRun = p;
+  hbridge->StageRunTimestamp = hbridge->StageTimestamp;
+
+  if (TxQueue_Send(hbridge->hEgress, p, (uint16_t)n) != HAL_OK)
+  {
+    hbridge->StageBusy = 0U;
+  }
+}
+
+/**
+  * @brief  Release the ingress bytes up to the oldest region still transmitted in place.
+  * @param  hbridge Bridge handle.
+  * @retval None
+  */
+static void UartBridge_Release(UartBridge_HandleTypeDef *hbridge)
+{
+  const UartBridge_RegionTypeDef *region;
+  uint32_t tail = UARTBRIDGE_LOAD_ACQUIRE(hbridge->RegionTail);
+  uint32_t to = hbridge->Forwarded;
+  uint32_t n;
+
+  if (tail != hbridge->RegionHead)
+  {
+    region = &hbridge->Region[tail & (UARTBRIDGE_MAX_REGIONS - 1U)];
+    to = region->End - region->Len;
+  }
+
+  /* Behind the view after a resynchronization: nothing to release yet */
+  n = to - hbridge->hIngress->RxConsumedCount;
+  if ((n != 0U) && (n <= hbridge->hIngress->RxXferSize))
+  {
+    (void)HAL_DMAIdleRecieverEx_ReleaseRxData(hbridge->hIngress, (uint16_t)n);
+  }
+}
+
+/**
+  * @brief  Record the forwarding latency of a region.
+  * @param  hbridge Bridge handle.
+  * @param  Cycles  Rx Event to egress Tx DMA completion, in core clock cycles.
+  * @retval None
+  */
+static void UartBridge_Latency(UartBridge_HandleTypeDef *hbridge, uint32_t Cycles)
+{
+  hbridge->LatencyLast = Cycles;
+  if (Cycles > hbridge->LatencyMax)
+  {
+    hbridge->LatencyMax = Cycles;
+  }
+}
@@ -0,0 +1,450 @@
+/**
+  ******************************************************************************
+  * @file           : uart_port.c
+  * @brief          : Registry of the U(S)ART ports received with DMA.
+  ******************************************************************************
+  * @attention
+  *
+  * The port map lives in flash and is indexed by port identifier, so the
+  * interrupt handlers reach their handles without searching. The Rx and Tx DMA
+  * handles are owned by the registry, one per port; the DMAIdleReciever
+  * handles are owned by the application and referenced from its
+  * configuration array, which must stay valid while the port is in use.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "uart_port.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  USART_TypeDef          *Instance;
+  DMA_Stream_TypeDef     *RxStream;
+  uint32_t               RxChannel;
+  uint32_t               ClockMask;     /* Enable bit in RCC APB1ENR or APB2ENR */
+  uint32_t               DmaClockMask;  /* Enable bit in RCC AHB1ENR            */
+  IRQn_Type              IRQn;
+  IRQn_Type              RxDmaIRQn;
+  uint8_t                Apb;
+  uint8_t                Alternate;
+} UartPort_MapTypeDef;
+
+typedef struct
+{
+  DMA_Stream_TypeDef     *TxStream;     /* NULL for a port without Tx DMA       */
+  uint32_t               TxChannel;
+  uint32_t               DmaClockMask;  /* Enable bit in RCC AHB1ENR            */
+  IRQn_Type              TxDmaIRQn;
+} UartPort_TxMapTypeDef;
+
+/* Private macro -------------------------------------------------------------*/
+#define UARTPORT_MAP_ENTRY(__ID__, __PERIPH__, __AF__, __APB__, __DMA__, __STREAM__, __CHANNEL__) \
+  [UARTPORT_##__ID__] =                                                                          \
+  {                                                                                              \
+    .Instance     = __PERIPH__,                                                                  \
+    .RxStream     = DMA##__DMA__##_Stream##__STREAM__,                                           \
+    .RxChannel    = __CHANNEL__,                                                                 \
+    .ClockMask    = RCC_APB##__APB__##ENR_##__PERIPH__##EN,                                      \
+    .DmaClockMask = RCC_AHB1ENR_DMA##__DMA__##EN,                                                \
+    .IRQn         = __PERIPH__##_IRQn,                                                           \
+    .RxDmaIRQn    = DMA##__DMA__##_Stream##__STREAM__##_IRQn,                                    \
+    .Apb          = (__APB__),                                                                   \
+    .Alternate    = __AF__,                                                                      \
+  },
+#define UARTPORT_TX_MAP_ENTRY(__ID__, __DMA__, __STREAM__, __CHANNEL__)                           \
+  [UARTPORT_##__ID__] =                                                                          \
+  {                                                                                              \
+    .TxStream     = DMA##__DMA__##_Stream##__STREAM__,                                           \
+    .TxChannel    = __CHANNEL__,                                                                 \
+    .DmaClockMask = RCC_AHB1ENR_DMA##__DMA__##EN,                                                \
+    .TxDmaIRQn    = DMA##__DMA__##_Stream##__STREAM__##_IRQn,                                    \
+  },
+#define UARTPORT_STREAM_CASE(__ID__, __PERIPH__, __AF__, __APB__, __DMA__, __STREAM__, __CHANNEL__) \
+  case ((__DMA__) * 8U) + (__STREAM__):
+#define UARTPORT_TX_STREAM_CASE(__ID__, __DMA__, __STREAM__, __CHANNEL__)                          \
+  case ((__DMA__) * 8U) + (__STREAM__):
+
+/* Private variables ---------------------------------------------------------*/
+static const UartPort_MapTypeDef UartPort_Map[UARTPORT_COUNT] =
+{
+  UARTPORT_TABLE(UARTPORT_MAP_ENTRY)
+};
+
+static const UartPort_TxMapTypeDef UartPort_TxMap[UARTPORT_COUNT] =
+{
+  UARTPORT_TX_TABLE(UARTPORT_TX_MAP_ENTRY)
+};
+
+static const UartPort_ConfigTypeDef *UartPort_Config[UARTPORT_COUNT];
+static DMA_HandleTypeDef UartPort_DmaRx[UARTPORT_COUNT];
+static DMA_HandleTypeDef UartPort_DmaTx[UARTPORT_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static void UartPort_GpioInit(GPIO_TypeDef *GPIOx, uint16_t Pin, uint8_t Alternate);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Register and initialize ports.
+  * @note   Each handle is set to 8N1, TX and RX, no flow control, 16x oversampling,
+  *         then initialized with HAL_DMAIdleReciever_Init(). Reception is not started.
+  * @param  pConfig Port configurations, kept by reference.
+  * @param  Count   Number of configurations.
+  * @retval HAL_ERROR if a port is unknown, already registered or fails to initialize
+  */
+HAL_StatusTypeDef UartPort_Init(const UartPort_ConfigTypeDef *pConfig, uint32_t Count)
+{
+  DMAIdleReciever_HandleTypeDef *handle;
+  uint32_t i;
+
+  for (i = 0U; i < Count; i++)
+  {
+    if (((uint32_t)pConfig[i].Id >= (uint32_t)UARTPORT_COUNT) || (pConfig[i].hDMAIdleReciever == NULL)
+        || (UartPort_Config[pConfig[i].Id] != NULL))
+    {
+      return HAL_ERROR;
+    }
+    UartPort_Config[pConfig[i].Id] = &pConfig[i];
+
+    handle = pConfig[i].hDMAIdleReciever;
+    handle->Instance = UartPort_Map[pConfig[i].Id].Instance;
+    handle->Init.BaudRate = pConfig[i].BaudRate;
+    handle->Init.WordLength = DMAIdleReciever_WORDLENGTH_8B;
+    handle->Init.StopBits = DMAIdleReciever_STOPBITS_1;
+    handle->Init.Parity = DMAIdleReciever_PARITY_NONE;
+    handle->Init.Mode = DMAIdleReciever_MODE_TX_RX;
+    handle->Init.HwFlowCtl = DMAIdleReciever_HWCONTROL_NONE;
+    handle->Init.OverSampling = pConfig[i].OverSampling;
+    if (HAL_DMAIdleReciever_Init(handle) != HAL_OK)
+    {
+      UartPort_Config[pConfig[i].Id] = NULL;
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  De-initialize and unregister a port.
+  * @param  Id Port.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef UartPort_DeInit(UartPort_IdTypeDef Id)
+{
+  HAL_StatusTypeDef status;
+
+  if (((uint32_t)Id >= (uint32_t)UARTPORT_COUNT) || (UartPort_Config[Id] == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  status = HAL_DMAIdleReciever_DeInit(UartPort_Config[Id]->hDMAIdleReciever);
+  UartPort_Config[Id] = NULL;
+
+  return status;
+}
+
+/**
+  * @brief  Change the baud rate of a registered port.
+  * @note   Ongoing transfers are aborted without callbacks; reception must be
+  *         restarted by the caller, and a transmit queue of the port with
+  *         TxQueue_Abort(). The handle is re-initialized, which also restores
+  *         its default Rx event policy.
+  * @param  Id Port.
+  * @param  BaudRate New baud rate.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef UartPort_SetBaudRate(UartPort_IdTypeDef Id, uint32_t BaudRate)
+{
+  DMAIdleReciever_HandleTypeDef *handle = UartPort_GetHandle(Id);
+
+  if ((handle == NULL) || (BaudRate == 0U))
+  {
+    return HAL_ERROR;
+  }
+  if (HAL_DMAIdleReciever_Abort(handle) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  handle->Init.BaudRate = BaudRate;
+  return HAL_DMAIdleReciever_Init(handle);
+}
+
+/**
+  * @brief  Handle of a registered port.
+  * @param  Id Port.
+  * @retval Handle, NULL if the port is not registered
+  */
+DMAIdleReciever_HandleTypeDef *UartPort_GetHandle(UartPort_IdTypeDef Id)
+{
+  if (((uint32_t)Id >= (uint32_t)UARTPORT_COUNT) || (UartPort_Config[Id] == NULL))
+  {
+    return NULL;
+  }
+
+  return UartPort_Config[Id]->hDMAIdleReciever;
+}
+
+/**
+  * @brief  Port of a handle.
+  * @param  hDMAIdleReciever DMAIdleReciever handle, Instance set.
+  * @retval Port, UARTPORT_COUNT if the instance is not in the port map
+  */
+UartPort_IdTypeDef UartPort_GetId(const DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  uint32_t id;
+
+  for (id = 0U; id < (uint32_t)UARTPORT_COUNT; id++)
+  {
+    if (UartPort_Map[id].Instance == hDMAIdleReciever->Instance)
+    {
+      break;
+    }
+  }
+
+  return (UartPort_IdTypeDef)id;
+}
+
+/**
+  * @brief  Clock, GPIO, Rx and Tx DMA and NVIC setup of a registered port.
+  * @note   To be called from HAL_DMAIdleReciever_MspInit(). Handles of ports that are
+  *         not registered are left untouched. The Tx DMA stream, for ports listed in
+  *         UARTPORT_TX_TABLE(), transfers bytes in Normal mode, direct from flash or SRAM.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @retval None
+  */
+void UartPort_MspInit(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  UartPort_IdTypeDef id = UartPort_GetId(hDMAIdleReciever);
+  const UartPort_MapTypeDef *map;
+  const UartPort_TxMapTypeDef *txmap;
+  const UartPort_ConfigTypeDef *config;
+  DMA_HandleTypeDef *hdma;
+  __IO uint32_t tmpreg;
+
+  if ((id == UARTPORT_COUNT) || (UartPort_Config[id] == NULL))
+  {
+    return;
+  }
+  map = &UartPort_Map[id];
+  txmap = &UartPort_TxMap[id];
+  config = UartPort_Config[id];
+  hdma = &UartPort_DmaRx[id];
+
+  /* Peripheral and DMA controller clock enable, with a read back as a delay */
+  if (map->Apb == 2U)
+  {
+    SET_BIT(RCC->APB2ENR, map->ClockMask);
+    tmpreg = READ_BIT(RCC->APB2ENR, map->ClockMask);
+  }
+  else
+  {
+    SET_BIT(RCC->APB1ENR, map->ClockMask);
+    tmpreg = READ_BIT(RCC->APB1ENR, map->ClockMask);
+  }
+  SET_BIT(RCC->AHB1ENR, map->DmaClockMask);
+  tmpreg = READ_BIT(RCC->AHB1ENR, map->DmaClockMask);
+  UNUSED(tmpreg);
+
+  UartPort_GpioInit(config->TxPort, config->TxPin, map->Alternate);
+  UartPort_GpioInit(config->RxPort, config->RxPin, map->Alternate);
+
+  hdma->Instance = map->RxStream;
+  hdma->Init.Channel = map->RxChannel;
+  hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+  hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma->Init.MemInc = DMA_MINC_ENABLE;
+  hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma->Init.Priority = DMA_PRIORITY_LOW;
+  if (config->RxFifo != 0U)
+  {
+    /* Bytes packed into words, written 16 at a time in one INC4 burst */
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma->Init.Mode = DMA_NORMAL;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+    hdma->Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+    hdma->Init.MemBurst = DMA_MBURST_INC4;
+    hdma->Init.PeriphBurst = DMA_PBURST_SINGLE;
+  }
+  else
+  {
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma->Init.Mode = DMA_CIRCULAR;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+  }
+  if (HAL_DMA_Init(hdma) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  __HAL_LINKDMA(hDMAIdleReciever, hdmarx, *hdma);
+
+  if (txmap->TxStream != NULL)
+  {
+    SET_BIT(RCC->AHB1ENR, txmap->DmaClockMask);
+    tmpreg = READ_BIT(RCC->AHB1ENR, txmap->DmaClockMask);
+    UNUSED(tmpreg);
+
+    hdma = &UartPort_DmaTx[id];
+    hdma->Instance = txmap->TxStream;
+    hdma->Init.Channel = txmap->TxChannel;
+    hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma->Init.Mode = DMA_NORMAL;
+    hdma->Init.Priority = DMA_PRIORITY_LOW;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(hdma) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(hDMAIdleReciever, hdmatx, *hdma);
+
+    HAL_NVIC_SetPriority(txmap->TxDmaIRQn, config->Priority, 0);
+    HAL_NVIC_EnableIRQ(txmap->TxDmaIRQn);
+  }
+
+  /* The USART and its DMA streams must not preempt each other */
+  HAL_NVIC_SetPriority(map->RxDmaIRQn, config->Priority, 0);
+  HAL_NVIC_EnableIRQ(map->RxDmaIRQn);
+  HAL_NVIC_SetPriority(map->IRQn, config->Priority, 0);
+  HAL_NVIC_EnableIRQ(map->IRQn);
+}
+
+/**
+  * @brief  Undo UartPort_MspInit().
+  * @note   To be called from HAL_DMAIdleReciever_MspDeInit(). The DMA controller clock,
+  *         which may be shared, is left enabled.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @retval None
+  */
+void UartPort_MspDeInit(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  UartPort_IdTypeDef id = UartPort_GetId(hDMAIdleReciever);
+  const UartPort_MapTypeDef *map;
+  const UartPort_ConfigTypeDef *config;
+
+  if ((id == UARTPORT_COUNT) || (UartPort_Config[id] == NULL))
+  {
+    return;
+  }
+  map = &UartPort_Map[id];
+  config = UartPort_Config[id];
+
+  HAL_NVIC_DisableIRQ(map->IRQn);
+  HAL_NVIC_DisableIRQ(map->RxDmaIRQn);
+  if (UartPort_TxMap[id].TxStream != NULL)
+  {
+    HAL_NVIC_DisableIRQ(UartPort_TxMap[id].TxDmaIRQn);
+  }
+
+  if (map->Apb == 2U)
+  {
+    CLEAR_BIT(RCC->APB2ENR, map->ClockMask);
+  }
+  else
+  {
+    CLEAR_BIT(RCC->APB1ENR, map->ClockMask);
+  }
+
+  HAL_GPIO_DeInit(config->TxPort, config->TxPin);
+  HAL_GPIO_DeInit(config->RxPort, config->RxPin);
+
+  HAL_DMA_DeInit(hDMAIdleReciever->hdmarx);
+  if (hDMAIdleReciever->hdmatx != NULL)
+  {
+    HAL_DMA_DeInit(hDMAIdleReciever->hdmatx);
+  }
+}
+
+/**
+  * @brief  USART interrupt dispatch.
+  * @param  Id Port.
+  * @retval None
+  */
+void UartPort_IRQHandler(UartPort_IdTypeDef Id)
+{
+  const UartPort_ConfigTypeDef *config = UartPort_Config[Id];
+
+  if (config != NULL)
+  {
+    HAL_DMAIdleReciever_IRQHandler(config->hDMAIdleReciever);
+  }
+}
+
+/**
+  * @brief  Rx DMA stream interrupt dispatch.
+  * @param  Id Port.
+  * @retval None
+  */
+void UartPort_DMA_IRQHandler(UartPort_IdTypeDef Id)
+{
+  if (UartPort_Config[Id] != NULL)
+  {
+    HAL_DMA_IRQHandler(&UartPort_DmaRx[Id]);
+  }
+}
+
+/**
+  * @brief  Tx DMA stream interrupt dispatch.
+  * @param  Id Port.
+  * @retval None
+  */
+void UartPort_TxDMA_IRQHandler(UartPort_IdTypeDef Id)
+{
+  if (UartPort_Config[Id] != NULL)
+  {
+    HAL_DMA_IRQHandler(&UartPort_DmaTx[Id]);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Configure a pin for its U(S)ART alternate function, port clock included.
+  * @param  GPIOx     GPIO port.
+  * @param  Pin       GPIO_PIN_x.
+  * @param  Alternate Alternate function.
+  * @retval None
+  */
+static void UartPort_GpioInit(GPIO_TypeDef *GPIOx, uint16_t Pin, uint8_t Alternate)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  uint32_t enable = 1UL << (((uint32_t)GPIOx - AHB1PERIPH_BASE) >> 10U);
+  __IO uint32_t tmpreg;
+
+  /* GPIO ports are 1 KB apart on AHB1, in the order of their RCC enable bits */
+  SET_BIT(RCC->AHB1ENR, enable);
+  tmpreg = READ_BIT(RCC->AHB1ENR, enable);
+  UNUSED(tmpreg);
+
+  GPIO_InitStruct.Pin = Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+  GPIO_InitStruct.Alternate = Alternate;
+  HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
+}
+
+/**
+  * @brief  Compile time check of the Rx and Tx DMA streams, never called.
+  * @note   A stream used twice gives a duplicate case value error.
+  * @param  Stream Unused.
+  * @retval None
+  */
+static inline void UartPort_StreamCheck(uint32_t Stream)
+{
+  switch (Stream)
+  {
+    UARTPORT_TABLE(UARTPORT_STREAM_CASE)
+    UARTPORT_TX_TABLE(UARTPORT_TX_STREAM_CASE)
+    default:
+      break;
+  }
+}
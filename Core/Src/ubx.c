@@ -0,0 +1,427 @@
+/**
+  ******************************************************************************
+  * @file           : ubx.c
+  * @brief          : Incremental u-blox UBX binary protocol decoder.
+  ******************************************************************************
+  * @attention
+  *
+  * The payload is copied and checksummed a whole fragment at a time. The
+  * candidate frame is kept whole, from its B5, so that a false sync, whose
+  * checksum does not match or whose length exceeds UBX_MAX_PAYLOAD, is dropped
+  * by scanning its bytes again from the one after its B5: real frames it
+  * swallowed are found, as rtcm3.c does after a false preamble.
+  * Payload fields are little endian and read byte by byte, so no alignment is
+  * assumed.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "ubx.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define UBX_STATE_SYNC1               0U
+#define UBX_STATE_SYNC2               1U
+#define UBX_STATE_CLASS               2U
+#define UBX_STATE_ID                  3U
+#define UBX_STATE_LENGTH1             4U
+#define UBX_STATE_LENGTH2             5U
+#define UBX_STATE_PAYLOAD             6U
+#define UBX_STATE_CK_A                7U
+#define UBX_STATE_CK_B                8U
+#define UBX_STATE_RESCAN              9U
+
+/* Private macro -------------------------------------------------------------*/
+#define UBX_U1(__P__, __O__)          ((uint32_t)(__P__)[(__O__)])
+#define UBX_U2(__P__, __O__)          (UBX_U1(__P__, __O__) | (UBX_U1(__P__, (__O__) + 1U) << 8))
+#define UBX_U4(__P__, __O__)          (UBX_U2(__P__, __O__) | (UBX_U2(__P__, (__O__) + 2U) << 16))
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Ubx_Scan(Ubx_HandleTypeDef *hubx, const uint8_t *pData, uint32_t Len);
+static void Ubx_Rescan(Ubx_HandleTypeDef *hubx);
+static void Ubx_Dispatch(Ubx_HandleTypeDef *hubx);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a decoder.
+  * @param  hubx Decoder handle.
+  * @retval None
+  */
+void Ubx_Init(Ubx_HandleTypeDef *hubx)
+{
+  hubx->State          = UBX_STATE_SYNC1;
+  hubx->Index          = 0U;
+  hubx->FrameCount     = 0U;
+  hubx->ChecksumErrors = 0U;
+  hubx->LengthErrors   = 0U;
+}
+
+/**
+  * @brief  Feed received bytes to the decoder.
+  * @note   Callbacks are called from this function, once per valid frame.
+  * @param  hubx  Decoder handle.
+  * @param  pData Received bytes.
+  * @param  Len   Number of bytes.
+  * @retval None
+  */
+void Ubx_Parse(Ubx_HandleTypeDef *hubx, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t i = 0U;
+
+  while (i < Len)
+  {
+    i += Ubx_Scan(hubx, &pData[i], Len - i);
+    if (hubx->State == UBX_STATE_RESCAN)
+    {
+      Ubx_Rescan(hubx);
+    }
+  }
+}
+
+/**
+  * @brief  Decode one satellite block of a NAV-SAT message.
+  * @param  pNavSat NAV-SAT message given to Ubx_NavSatCallback().
+  * @param  Index   Block index, below pNavSat->NumSvs.
+  * @param  pSv     Decoded block.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Ubx_GetNavSatSv(const Ubx_NavSatTypeDef *pNavSat, uint32_t Index, Ubx_NavSatSvTypeDef *pSv)
+{
+  const uint8_t *b;
+
+  if (Index >= pNavSat->NumSvs)
+  {
+    return HAL_ERROR;
+  }
+
+  b = &pNavSat->pBlocks[Index * UBX_NAV_SAT_BLOCK_LENGTH];
+  pSv->GnssId = b[0];
+  pSv->SvId   = b[1];
+  pSv->Cno    = b[2];
+  pSv->Elev   = (int8_t)b[3];
+  pSv->Azim   = (int16_t)UBX_U2(b, 4U);
+  pSv->PrRes  = (int16_t)UBX_U2(b, 6U);
+  pSv->Flags  = UBX_U4(b, 8U);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  NAV-PVT message callback.
+  * @param  hubx    Decoder handle.
+  * @param  pNavPvt Decoded message, valid during the call only.
+  * @retval None
+  */
+__weak void Ubx_NavPvtCallback(Ubx_HandleTypeDef *hubx, const Ubx_NavPvtTypeDef *pNavPvt)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hubx);
+  UNUSED(pNavPvt);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the Ubx_NavPvtCallback can be implemented in the user file.
+   */
+}
+
+/**
+  * @brief  NAV-SAT message callback.
+  * @param  hubx    Decoder handle.
+  * @param  pNavSat Decoded header, blocks point into the decoder payload buffer
+  *                 and are valid during the call only.
+  * @retval None
+  */
+__weak void Ubx_NavSatCallback(Ubx_HandleTypeDef *hubx, const Ubx_NavSatTypeDef *pNavSat)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hubx);
+  UNUSED(pNavSat);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the Ubx_NavSatCallback can be implemented in the user file.
+   */
+}
+
+/**
+  * @brief  Callback for valid messages without a dedicated decoder.
+  * @param  hubx     Decoder handle.
+  * @param  Class    Message class.
+  * @param  Id       Message ID.
+  * @param  pPayload Payload, valid during the call only.
+  * @param  Length   Payload length.
+  * @retval None
+  */
+__weak void Ubx_MessageCallback(Ubx_HandleTypeDef *hubx, uint8_t Class, uint8_t Id, const uint8_t *pPayload, uint16_t Length)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hubx);
+  UNUSED(Class);
+  UNUSED(Id);
+  UNUSED(pPayload);
+  UNUSED(Length);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the Ubx_MessageCallback can be implemented in the user file.
+   */
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Run the decoder over bytes, keeping the candidate frame in hubx->Frame.
+  * @note   pData may point into hubx->Frame at or after the byte being written:
+  *         the frame is stored behind the bytes read.
+  * @param  hubx  Decoder handle.
+  * @param  pData Bytes.
+  * @param  Len   Number of bytes.
+  * @retval Bytes consumed, fewer than Len when a candidate frame was rejected
+  *         (state UBX_STATE_RESCAN)
+  */
+static uint32_t Ubx_Scan(Ubx_HandleTypeDef *hubx, const uint8_t *pData, uint32_t Len)
+{
+  uint32_t i = 0U;
+  uint32_t n;
+  uint32_t k;
+  uint8_t ck_a;
+  uint8_t ck_b;
+  uint8_t c;
+  const uint8_t *p;
+
+  while (i < Len)
+  {
+    switch (hubx->State)
+    {
+      case UBX_STATE_SYNC1:
+        /* Hunt for the first sync character */
+        p = memchr(&pData[i], UBX_SYNC_CHAR_1, Len - i);
+        if (p == NULL)
+        {
+          return Len;
+        }
+        i = (uint32_t)(p - pData) + 1U;
+        hubx->Frame[0] = UBX_SYNC_CHAR_1;
+        hubx->Index = 1U;
+        hubx->State = UBX_STATE_SYNC2;
+        break;
+
+      case UBX_STATE_PAYLOAD:
+        /* Bulk copy and checksum of the payload bytes available in this fragment */
+        n = (UBX_HEADER_LENGTH + (uint32_t)hubx->Length) - hubx->Index;
+        if (n > (Len - i))
+        {
+          n = Len - i;
+        }
+        ck_a = hubx->CkA;
+        ck_b = hubx->CkB;
+        p = &pData[i];
+        for (k = 0U; k < n; k++)
+        {
+          ck_a += p[k];
+          ck_b += ck_a;
+        }
+        hubx->CkA = ck_a;
+        hubx->CkB = ck_b;
+        memmove(&hubx->Frame[hubx->Index], p, n);
+        hubx->Index += (uint16_t)n;
+        i += n;
+        if (hubx->Index == (UBX_HEADER_LENGTH + hubx->Length))
+        {
+          hubx->State = UBX_STATE_CK_A;
+        }
+        break;
+
+      default:
+        c = pData[i];
+        i++;
+        hubx->Frame[hubx->Index] = c;
+        hubx->Index++;
+        switch (hubx->State)
+        {
+          case UBX_STATE_SYNC2:
+            if (c == UBX_SYNC_CHAR_2)
+            {
+              hubx->CkA = 0U;
+              hubx->CkB = 0U;
+              hubx->State = UBX_STATE_CLASS;
+            }
+            else if (c == UBX_SYNC_CHAR_1)
+            {
+              hubx->Index = 1U;
+            }
+            else
+            {
+              hubx->State = UBX_STATE_SYNC1;
+            }
+            break;
+
+          case UBX_STATE_CLASS:
+            hubx->Class = c;
+            hubx->CkA += c;
+            hubx->CkB += hubx->CkA;
+            hubx->State = UBX_STATE_ID;
+            break;
+
+          case UBX_STATE_ID:
+            hubx->Id = c;
+            hubx->CkA += c;
+            hubx->CkB += hubx->CkA;
+            hubx->State = UBX_STATE_LENGTH1;
+            break;
+
+          case UBX_STATE_LENGTH1:
+            hubx->Length = c;
+            hubx->CkA += c;
+            hubx->CkB += hubx->CkA;
+            hubx->State = UBX_STATE_LENGTH2;
+            break;
+
+          case UBX_STATE_LENGTH2:
+            hubx->Length |= (uint16_t)((uint16_t)c << 8);
+            hubx->CkA += c;
+            hubx->CkB += hubx->CkA;
+            if (hubx->Length > UBX_MAX_PAYLOAD)
+            {
+              /* Cannot be assembled, most likely a false sync */
+              hubx->LengthErrors++;
+              hubx->State = UBX_STATE_RESCAN;
+              return i;
+            }
+            hubx->State = (hubx->Length != 0U) ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+            break;
+
+          case UBX_STATE_CK_A:
+            if (c != hubx->CkA)
+            {
+              hubx->ChecksumErrors++;
+              hubx->State = UBX_STATE_RESCAN;
+              return i;
+            }
+            hubx->State = UBX_STATE_CK_B;
+            break;
+
+          default:
+            /* UBX_STATE_CK_B */
+            if (c != hubx->CkB)
+            {
+              hubx->ChecksumErrors++;
+              hubx->State = UBX_STATE_RESCAN;
+              return i;
+            }
+            hubx->State = UBX_STATE_SYNC1;
+            hubx->FrameCount++;
+            Ubx_Dispatch(hubx);
+            break;
+        }
+        break;
+    }
+  }
+
+  return i;
+}
+
+/**
+  * @brief  Drop a rejected candidate frame and scan its bytes again from the
+  *         one after its B5.
+  * @note   Candidates found among these bytes are validated or rejected in
+  *         turn; the decoder is left in the state reached after the last byte.
+  * @param  hubx Decoder handle, in state UBX_STATE_RESCAN.
+  * @retval None
+  */
+static void Ubx_Rescan(Ubx_HandleTypeDef *hubx)
+{
+  uint32_t n = hubx->Index;
+  uint32_t used;
+  const uint8_t *p;
+
+  while (hubx->State == UBX_STATE_RESCAN)
+  {
+    hubx->State = UBX_STATE_SYNC1;
+    p = memchr(&hubx->Frame[1], UBX_SYNC_CHAR_1, n - 1U);
+    if (p == NULL)
+    {
+      return;
+    }
+    n -= (uint32_t)(p - hubx->Frame);
+    memmove(hubx->Frame, p, n);
+    used = Ubx_Scan(hubx, hubx->Frame, n);
+    if (hubx->State == UBX_STATE_RESCAN)
+    {
+      /* Rejected again: the bytes not scanned yet follow the new candidate */
+      memmove(&hubx->Frame[hubx->Index], &hubx->Frame[used], n - used);
+      n = hubx->Index + (n - used);
+    }
+  }
+}
+
+/**
+  * @brief  Route a valid frame to its decoder by class and ID.
+  * @param  hubx Decoder handle.
+  * @retval None
+  */
+static void Ubx_Dispatch(Ubx_HandleTypeDef *hubx)
+{
+  const uint8_t *p = &hubx->Frame[UBX_HEADER_LENGTH];
+  Ubx_NavPvtTypeDef pvt;
+  Ubx_NavSatTypeDef sat;
+
+  switch (((uint32_t)hubx->Class << 8) | hubx->Id)
+  {
+    case ((UBX_CLASS_NAV << 8) | UBX_ID_NAV_PVT):
+      if (hubx->Length < UBX_NAV_PVT_LENGTH)
+      {
+        hubx->LengthErrors++;
+        break;
+      }
+      pvt.iTOW    = UBX_U4(p, 0U);
+      pvt.Year    = (uint16_t)UBX_U2(p, 4U);
+      pvt.Month   = p[6];
+      pvt.Day     = p[7];
+      pvt.Hour    = p[8];
+      pvt.Min     = p[9];
+      pvt.Sec     = p[10];
+      pvt.Valid   = p[11];
+      pvt.tAcc    = UBX_U4(p, 12U);
+      pvt.Nano    = (int32_t)UBX_U4(p, 16U);
+      pvt.FixType = p[20];
+      pvt.Flags   = p[21];
+      pvt.Flags2  = p[22];
+      pvt.NumSV   = p[23];
+      pvt.Lon     = (int32_t)UBX_U4(p, 24U);
+      pvt.Lat     = (int32_t)UBX_U4(p, 28U);
+      pvt.Height  = (int32_t)UBX_U4(p, 32U);
+      pvt.hMSL    = (int32_t)UBX_U4(p, 36U);
+      pvt.hAcc    = UBX_U4(p, 40U);
+      pvt.vAcc    = UBX_U4(p, 44U);
+      pvt.VelN    = (int32_t)UBX_U4(p, 48U);
+      pvt.VelE    = (int32_t)UBX_U4(p, 52U);
+      pvt.VelD    = (int32_t)UBX_U4(p, 56U);
+      pvt.gSpeed  = (int32_t)UBX_U4(p, 60U);
+      pvt.HeadMot = (int32_t)UBX_U4(p, 64U);
+      pvt.sAcc    = UBX_U4(p, 68U);
+      pvt.HeadAcc = UBX_U4(p, 72U);
+      pvt.pDOP    = (uint16_t)UBX_U2(p, 76U);
+      pvt.Flags3  = p[78];
+      pvt.HeadVeh = (int32_t)UBX_U4(p, 84U);
+      pvt.MagDec  = (int16_t)UBX_U2(p, 88U);
+      pvt.MagAcc  = (uint16_t)UBX_U2(p, 90U);
+      Ubx_NavPvtCallback(hubx, &pvt);
+      break;
+
+    case ((UBX_CLASS_NAV << 8) | UBX_ID_NAV_SAT):
+      if ((hubx->Length < UBX_NAV_SAT_HEADER_LENGTH)
+          || (hubx->Length < (UBX_NAV_SAT_HEADER_LENGTH + ((uint32_t)p[5] * UBX_NAV_SAT_BLOCK_LENGTH))))
+      {
+        hubx->LengthErrors++;
+        break;
+      }
+      sat.iTOW    = UBX_U4(p, 0U);
+      sat.Version = p[4];
+      sat.NumSvs  = p[5];
+      sat.pBlocks = &p[UBX_NAV_SAT_HEADER_LENGTH];
+      Ubx_NavSatCallback(hubx, &sat);
+      break;
+
+    default:
+      Ubx_MessageCallback(hubx, hubx->Class, hubx->Id, p, hubx->Length);
+      break;
+  }
+}
@@ -154,6 +154,23 @@ typedef uint32_t HAL_DMAIdleReciever_RxTypeTypeDef;
   */
 typedef uint32_t HAL_DMAIdleReciever_RxEventTypeTypeDef;
 
+/**
+  * @brief DMAIdleReciever zero-copy Rx view definition
+  * @note  Describes the received data not yet released by the application, as one or two
+  *        contiguous segments located inside the DMA reception buffer. Size2 is only non zero
+  *        when the unread data wraps around the end of a circular buffer.
+  */
+typedef struct
+{
+  uint8_t                       *pData1;          /*!< Start of the first segment (oldest unread byte)   */
+
+  uint16_t                      Size1;            /*!< Number of bytes in the first segment              */
+
+  uint8_t                       *pData2;          /*!< Start of the second segment (buffer start) or NULL */
+
+  uint16_t                      Size2;            /*!< Number of bytes in the second segment             */
+} DMAIdleReciever_RxViewTypeDef;
+
 /**
   * @brief  DMAIdleReciever handle Structure definition
   */
@@ -175,6 +192,43 @@ typedef struct __DMAIdleReciever_HandleTypeDef
 
   __IO uint16_t                 RxXferCount;      /*!< DMAIdleReciever Rx Transfer Counter           */
 
+  __IO uint16_t                 RxReadPos;        /*!< Zero-copy consumer position in Rx buffer      */
+
+  uint8_t                       *pRxBuffM1Ptr;    /*!< Pointer to second Rx buffer in double-buffer mode,
+                                                       NULL in single-buffer mode                    */
+
+  __IO uint8_t                  RxBufferIndex;    /*!< Rx buffer (0 or 1) the last Rx Event refers to */
+
+  __IO uint32_t                 RxProducedCount;  /*!< Bytes written by the Rx DMA since reception start, sampled on
+                                                       each HT/TC/IDLE event (single-buffer circular mode)   */
+
+  uint16_t                      RxLastWritePos;   /*!< DMA write position at the last sample                */
+
+  __IO uint32_t                 RxConsumedCount;  /*!< Bytes released by the consumer since reception start */
+
+  uint32_t                      RxLostCount;      /*!< Bytes overwritten by the DMA before being released   */
+
+  uint32_t                      RxLapCount;       /*!< Number of times the DMA lapped the consumer          */
+
+  uint16_t                      RxNearFullThreshold; /*!< Unread bytes raising the near-full warning, 0 disables it */
+
+  __IO uint8_t                  RxNearFull;       /*!< Set while the unread level is at or above the threshold */
+
+  uint8_t                       RxEventMask;      /*!< Rx Events reported in circular DMA mode,
+                                                       a combination of @ref DMAIdleReciever_RxEvent_Mask */
+
+  uint16_t                      RxEventCoalesce;  /*!< Minimum bytes between reported HT/TC events, 0 reports each one */
+
+  uint16_t                      RxEventLastPos;   /*!< Buffer position of the last Rx Event, reported or not */
+
+  uint32_t                      RxEventPending;   /*!< Bytes received since the last reported Rx Event      */
+
+  uint32_t                      RxCharCycles;     /*!< Character time in core clock cycles, from the programmed
+                                                       baud rate divider                                     */
+
+  uint64_t                      RxEventTimestamp; /*!< Core clock cycle count at the end of the last byte of the
+                                                       last Rx Event (DMA HT/TC, IDLE)                       */
+
   __IO HAL_DMAIdleReciever_RxTypeTypeDef ReceptionType;      /*!< Type of ongoing reception          */
 
   __IO HAL_DMAIdleReciever_RxEventTypeTypeDef RxEventType;   /*!< Type of Rx Event                   */
@@ -205,6 +259,8 @@ typedef struct __DMAIdleReciever_HandleTypeDef
   void (* AbortReceiveCpltCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);  /*!< DMAIdleReciever Abort Receive Complete Callback  */
   void (* WakeupCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);            /*!< DMAIdleReciever Wakeup Callback                  */
   void (* RxEventCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos); /*!< DMAIdleReciever Reception Event Callback     */
+  void (* RxNearFullCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t Unread); /*!< DMAIdleReciever Rx Near Full Callback */
+  void (* TxDmaCpltCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);         /*!< DMAIdleReciever Tx DMA Complete Callback         */
 
   void (* MspInitCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);           /*!< DMAIdleReciever Msp Init callback                */
   void (* MspDeInitCallback)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);         /*!< DMAIdleReciever Msp DeInit callback              */
@@ -227,6 +283,7 @@ typedef enum
   HAL_DMAIdleReciever_ABORT_TRANSMIT_COMPLETE_CB_ID = 0x06U,    /*!< DMAIdleReciever Abort Transmit Complete Callback ID */
   HAL_DMAIdleReciever_ABORT_RECEIVE_COMPLETE_CB_ID  = 0x07U,    /*!< DMAIdleReciever Abort Receive Complete Callback ID  */
   HAL_DMAIdleReciever_WAKEUP_CB_ID                  = 0x08U,    /*!< DMAIdleReciever Wakeup Callback ID                  */
+  HAL_DMAIdleReciever_TX_DMA_COMPLETE_CB_ID         = 0x09U,    /*!< DMAIdleReciever Tx DMA Complete Callback ID         */
 
   HAL_DMAIdleReciever_MSPINIT_CB_ID                 = 0x0BU,    /*!< DMAIdleReciever MspInit callback ID                 */
   HAL_DMAIdleReciever_MSPDEINIT_CB_ID               = 0x0CU     /*!< DMAIdleReciever MspDeInit callback ID               */
@@ -238,6 +295,7 @@ typedef enum
   */
 typedef  void (*pDMAIdleReciever_CallbackTypeDef)(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);  /*!< pointer to an DMAIdleReciever callback function */
 typedef  void (*pDMAIdleReciever_RxEventCallbackTypeDef)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos);   /*!< pointer to a DMAIdleReciever Rx Event specific callback function */
+typedef  void (*pDMAIdleReciever_RxNearFullCallbackTypeDef)(struct __DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t Unread);   /*!< pointer to a DMAIdleReciever Rx Near Full specific callback function */
 
 #endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
 
@@ -413,6 +471,18 @@ typedef  void (*pDMAIdleReciever_RxEventCallbackTypeDef)(struct __DMAIdleRecieve
   * @}
   */
 
+/** @defgroup DMAIdleReciever_RxEvent_Mask  DMAIdleReciever RxEvent mask values
+  * @{
+  */
+#define HAL_DMAIdleReciever_RXEVENT_MASK_TC             (1UL << HAL_DMAIdleReciever_RXEVENT_TC)   /*!< Report Transfer Complete events */
+#define HAL_DMAIdleReciever_RXEVENT_MASK_HT             (1UL << HAL_DMAIdleReciever_RXEVENT_HT)   /*!< Report Half Transfer events     */
+#define HAL_DMAIdleReciever_RXEVENT_MASK_IDLE           (1UL << HAL_DMAIdleReciever_RXEVENT_IDLE) /*!< Report Idle events              */
+#define HAL_DMAIdleReciever_RXEVENT_MASK_ALL            (HAL_DMAIdleReciever_RXEVENT_MASK_TC | HAL_DMAIdleReciever_RXEVENT_MASK_HT \
+                                                         | HAL_DMAIdleReciever_RXEVENT_MASK_IDLE)
+/**
+  * @}
+  */
+
 /**
   * @}
   */
@@ -731,6 +801,9 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_UnRegisterCallback(DMAIdleReciever_HandleT
 
 HAL_StatusTypeDef HAL_DMAIdleReciever_RegisterRxEventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, pDMAIdleReciever_RxEventCallbackTypeDef pCallback);
 HAL_StatusTypeDef HAL_DMAIdleReciever_UnRegisterRxEventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+
+HAL_StatusTypeDef HAL_DMAIdleReciever_RegisterRxNearFullCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, pDMAIdleReciever_RxNearFullCallbackTypeDef pCallback);
+HAL_StatusTypeDef HAL_DMAIdleReciever_UnRegisterRxNearFullCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
 #endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
 
 /**
@@ -751,13 +824,27 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_Receive_DMA(DMAIdleReciever_HandleTypeDef
 HAL_StatusTypeDef HAL_DMAIdleReciever_DMAPause(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
 HAL_StatusTypeDef HAL_DMAIdleReciever_DMAResume(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
 HAL_StatusTypeDef HAL_DMAIdleReciever_DMAStop(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ContinueTransmit_DMA(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, const uint8_t *pData,
+                                                           uint16_t Size);
 
 HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pData, uint16_t Size, uint16_t *RxLen,
                                            uint32_t Timeout);
 HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_IT(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pData, uint16_t Size);
 HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA_DoubleBuffer(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pData0,
+                                                                     uint8_t *pData1, uint16_t Size);
+uint8_t *HAL_DMAIdleRecieverEx_GetRxEventBuffer(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_GetRxView(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, DMAIdleReciever_RxViewTypeDef *pView);
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReleaseRxData(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Size);
 
 HAL_DMAIdleReciever_RxEventTypeTypeDef HAL_DMAIdleRecieverEx_GetRxEventType(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_SetRxEventPolicy(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t EventMask,
+                                                       uint16_t Coalesce);
+uint64_t HAL_DMAIdleRecieverEx_GetRxEventTimestamp(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+void HAL_DMAIdleRecieverEx_TimestampInit(void);
+uint64_t HAL_DMAIdleRecieverEx_GetCycles(void);
+uint64_t HAL_DMAIdleRecieverEx_CyclesToNs(uint64_t Cycles);
 
 /* Transfer Abort functions */
 HAL_StatusTypeDef HAL_DMAIdleReciever_Abort(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
@@ -778,6 +865,8 @@ void HAL_DMAIdleReciever_AbortTransmitCpltCallback(DMAIdleReciever_HandleTypeDef
 void HAL_DMAIdleReciever_AbortReceiveCpltCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
 
 void HAL_DMAIdleRecieverEx_RxEventCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Size);
+void HAL_DMAIdleRecieverEx_RxNearFullCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t Unread);
+void HAL_DMAIdleRecieverEx_TxDmaCpltCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
 
 /**
   * @}
@@ -856,6 +945,9 @@ uint32_t              HAL_DMAIdleReciever_GetError(const DMAIdleReciever_HandleT
                                       ((WAKEUP) == DMAIdleReciever_WAKEUPMETHOD_ADDRESSMARK))
 #define IS_DMAIdleReciever_BAUDRATE(BAUDRATE) ((BAUDRATE) <= 10500000U)
 #define IS_DMAIdleReciever_ADDRESS(ADDRESS) ((ADDRESS) <= 0x0FU)
+#define IS_DMAIdleReciever_RXEVENT_MASK(MASK) (((MASK) & ~HAL_DMAIdleReciever_RXEVENT_MASK_ALL) == 0U)
+/* The DMA controllers have no path to the CCM data RAM */
+#define IS_DMAIdleReciever_DMA_BUFFER(ADDRESS) ((((uint32_t)(ADDRESS)) & 0xFFFF0000U) != CCMDATARAM_BASE)
 
 #define DMAIdleReciever_DIV_SAMPLING16(_PCLK_, _BAUD_)            ((uint32_t)((((uint64_t)(_PCLK_))*25U)/(4U*((uint64_t)(_BAUD_)))))
 #define DMAIdleReciever_DIVMANT_SAMPLING16(_PCLK_, _BAUD_)        (DMAIdleReciever_DIV_SAMPLING16((_PCLK_), (_BAUD_))/100U)
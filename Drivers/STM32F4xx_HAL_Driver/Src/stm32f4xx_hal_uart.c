@@ -216,6 +216,50 @@
 
     (#) Non-Blocking mode API with DMA:
         (+) HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA()
+        (+) HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA_DoubleBuffer(): ping-pong reception in two
+            buffers; HAL_DMAIdleRecieverEx_GetRxEventBuffer() gives the buffer an Rx Event refers to.
+
+    (#) Zero-copy access to data received with HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA():
+        (+) HAL_DMAIdleRecieverEx_GetRxView() returns the unread data as one or two segments
+            located directly in the DMA reception buffer, computed from the DMA stream counter.
+        (+) HAL_DMAIdleRecieverEx_ReleaseRxData() hands the consumed bytes back to the DMA.
+        (+) In single-buffer circular mode, the DMA write position is sampled on each HT, TC and
+            IDLE event. Bytes overwritten before being released are skipped by the next
+            HAL_DMAIdleRecieverEx_GetRxView() and counted in RxLostCount / RxLapCount.
+        (+) A non zero RxNearFullThreshold makes HAL_DMAIdleRecieverEx_RxNearFullCallback() fire
+            when that many bytes are pending, e.g. to throttle the remote transmitter.
+        (+) HAL_DMAIdleRecieverEx_SetRxEventPolicy() masks HT, TC or IDLE events and coalesces
+            HT / TC events until a minimum number of bytes is pending, to cut interrupt-level work.
+
+    (#) Rx DMA stream FIFO (FIFOMode enabled in the DMA handle, e.g. word memory width and
+        INC4 bursts, so that 16 received bytes cost a single AHB burst):
+        (+) The stream must be in Normal mode: the DMA counter runs ahead of memory by the bytes
+            parked in the FIFO, which only reach memory when the FIFO threshold is reached, at the
+            end of the transfer or when the stream is disabled.
+        (+) On IDLE, the reception is ended by disabling the stream, which flushes the FIFO; the
+            Rx Event callback runs once the stream reads disabled, i.e. once the bytes are in memory.
+            HT events are not reported. The buffer must be aligned on the memory burst size and
+            Size must be a multiple of the memory data width.
+
+    (#) Rx Event timestamps:
+        (+) HAL_DMAIdleRecieverEx_TimestampInit() starts the DWT cycle counter; call it once at
+            start-up, e.g. from HAL_MspInit(). Initializing a handle does not touch the counter.
+        (+) HAL_DMAIdleRecieverEx_GetRxEventTimestamp() gives the DWT cycle count at the end of the
+            last byte of the last Rx Event, extended to 64 bits; HAL_DMAIdleRecieverEx_CyclesToNs()
+            converts it. HAL_DMAIdleRecieverEx_GetCycles() must be called at least once per 2^32
+            core clock cycles, e.g. from SysTick.
+
+    (#) Back-to-back DMA transmission:
+        (+) HAL_DMAIdleRecieverEx_TxDmaCpltCallback() runs when the Tx DMA stream of a
+            HAL_DMAIdleReciever_Transmit_DMA() transfer completes, while the USART still sends the
+            last bytes. HAL_DMAIdleRecieverEx_ContinueTransmit_DMA() called from there restarts the
+            stream on the next buffer without an idle gap on the line; HAL_DMAIdleReciever_TxCpltCallback()
+            then only follows the last buffer.
+
+    (#) DMA buffers:
+        (+) The DMA controllers cannot reach the 64 KB CCM data RAM (0x10000000): the DMA
+            transmit and receive functions return HAL_ERROR for a buffer located there,
+            including a buffer on a stack placed in CCM.
 
 
      *** DMAIdleReciever HAL driver macros list ***
@@ -277,6 +321,10 @@
   */
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+/* 64-bit extension of the DWT cycle counter, shared by all handles */
+static uint32_t DMAIdleReciever_CyclesHigh;
+static uint32_t DMAIdleReciever_CyclesLast;
+
 /* Private function prototypes -----------------------------------------------*/
 /** @addtogroup DMAIdleReciever_Private_Functions  DMAIdleReciever Private Functions
   * @{
@@ -291,6 +339,11 @@ static void DMAIdleReciever_DMATransmitCplt(DMA_HandleTypeDef *hdma);
 static void DMAIdleReciever_DMAReceiveCplt(DMA_HandleTypeDef *hdma);
 static void DMAIdleReciever_DMATxHalfCplt(DMA_HandleTypeDef *hdma);
 static void DMAIdleReciever_DMARxHalfCplt(DMA_HandleTypeDef *hdma);
+static void DMAIdleReciever_RxTrack(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever);
+static HAL_StatusTypeDef DMAIdleReciever_CheckRxFifo(const DMAIdleReciever_HandleTypeDef *hDMAIdleReciever,
+                                                     const uint8_t *pData, uint16_t Size);
+static void DMAIdleReciever_RxEventNotify(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos);
+static void DMAIdleReciever_RxTimestamp(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t Correction);
 static void DMAIdleReciever_DMAError(DMA_HandleTypeDef *hdma);
 static void DMAIdleReciever_DMAAbortOnError(DMA_HandleTypeDef *hdma);
 static void DMAIdleReciever_DMATxAbortCallback(DMA_HandleTypeDef *hdma);
@@ -421,6 +474,8 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_Init(DMAIdleReciever_HandleTypeDef *hDMAId
   hDMAIdleReciever->gState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_TC;
+  hDMAIdleReciever->RxEventMask = (uint8_t)HAL_DMAIdleReciever_RXEVENT_MASK_ALL;
+  hDMAIdleReciever->RxEventCoalesce = 0U;
 
   return HAL_OK;
 }
@@ -491,6 +546,8 @@ HAL_StatusTypeDef HAL_HalfDuplex_Init(DMAIdleReciever_HandleTypeDef *hDMAIdleRec
   hDMAIdleReciever->gState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_TC;
+  hDMAIdleReciever->RxEventMask = (uint8_t)HAL_DMAIdleReciever_RXEVENT_MASK_ALL;
+  hDMAIdleReciever->RxEventCoalesce = 0U;
 
   return HAL_OK;
 }
@@ -572,6 +629,8 @@ HAL_StatusTypeDef HAL_LIN_Init(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever,
   hDMAIdleReciever->gState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_TC;
+  hDMAIdleReciever->RxEventMask = (uint8_t)HAL_DMAIdleReciever_RXEVENT_MASK_ALL;
+  hDMAIdleReciever->RxEventCoalesce = 0U;
 
   return HAL_OK;
 }
@@ -656,6 +715,8 @@ HAL_StatusTypeDef HAL_MultiProcessor_Init(DMAIdleReciever_HandleTypeDef *hDMAIdl
   hDMAIdleReciever->gState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_READY;
   hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_TC;
+  hDMAIdleReciever->RxEventMask = (uint8_t)HAL_DMAIdleReciever_RXEVENT_MASK_ALL;
+  hDMAIdleReciever->RxEventCoalesce = 0U;
 
   return HAL_OK;
 }
@@ -753,6 +814,7 @@ __weak void HAL_DMAIdleReciever_MspDeInit(DMAIdleReciever_HandleTypeDef *hDMAIdl
   *           @arg @ref HAL_DMAIdleReciever_ABORT_COMPLETE_CB_ID Abort Complete Callback ID
   *           @arg @ref HAL_DMAIdleReciever_ABORT_TRANSMIT_COMPLETE_CB_ID Abort Transmit Complete Callback ID
   *           @arg @ref HAL_DMAIdleReciever_ABORT_RECEIVE_COMPLETE_CB_ID Abort Receive Complete Callback ID
+  *           @arg @ref HAL_DMAIdleReciever_TX_DMA_COMPLETE_CB_ID Tx DMA Complete Callback ID
   *           @arg @ref HAL_DMAIdleReciever_MSPINIT_CB_ID MspInit Callback ID
   *           @arg @ref HAL_DMAIdleReciever_MSPDEINIT_CB_ID MspDeInit Callback ID
   * @param  pCallback pointer to the Callback function
@@ -807,6 +869,10 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_RegisterCallback(DMAIdleReciever_HandleTyp
         hDMAIdleReciever->AbortReceiveCpltCallback = pCallback;
         break;
 
+      case HAL_DMAIdleReciever_TX_DMA_COMPLETE_CB_ID :
+        hDMAIdleReciever->TxDmaCpltCallback = pCallback;
+        break;
+
       case HAL_DMAIdleReciever_MSPINIT_CB_ID :
         hDMAIdleReciever->MspInitCallback = pCallback;
         break;
@@ -874,6 +940,7 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_RegisterCallback(DMAIdleReciever_HandleTyp
   *           @arg @ref HAL_DMAIdleReciever_ABORT_COMPLETE_CB_ID Abort Complete Callback ID
   *           @arg @ref HAL_DMAIdleReciever_ABORT_TRANSMIT_COMPLETE_CB_ID Abort Transmit Complete Callback ID
   *           @arg @ref HAL_DMAIdleReciever_ABORT_RECEIVE_COMPLETE_CB_ID Abort Receive Complete Callback ID
+  *           @arg @ref HAL_DMAIdleReciever_TX_DMA_COMPLETE_CB_ID Tx DMA Complete Callback ID
   *           @arg @ref HAL_DMAIdleReciever_MSPINIT_CB_ID MspInit Callback ID
   *           @arg @ref HAL_DMAIdleReciever_MSPDEINIT_CB_ID MspDeInit Callback ID
   * @retval HAL status
@@ -918,6 +985,10 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_UnRegisterCallback(DMAIdleReciever_HandleT
         hDMAIdleReciever->AbortReceiveCpltCallback = HAL_DMAIdleReciever_AbortReceiveCpltCallback;   /* Legacy weak AbortReceiveCpltCallback  */
         break;
 
+      case HAL_DMAIdleReciever_TX_DMA_COMPLETE_CB_ID :
+        hDMAIdleReciever->TxDmaCpltCallback = HAL_DMAIdleRecieverEx_TxDmaCpltCallback;            /* Legacy weak TxDmaCpltCallback         */
+        break;
+
       case HAL_DMAIdleReciever_MSPINIT_CB_ID :
         hDMAIdleReciever->MspInitCallback = HAL_DMAIdleReciever_MspInit;                             /* Legacy weak MspInitCallback           */
         break;
@@ -1034,6 +1105,73 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_UnRegisterRxEventCallback(DMAIdleReciever_
   __HAL_UNLOCK(hDMAIdleReciever);
   return status;
 }
+
+/**
+  * @brief  Register a User DMAIdleReciever Rx Near Full Callback
+  *         To be used instead of the weak predefined callback
+  * @param  hDMAIdleReciever     DMAIdleReciever handle
+  * @param  pCallback Pointer to the Rx Near Full Callback function
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_DMAIdleReciever_RegisterRxNearFullCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, pDMAIdleReciever_RxNearFullCallbackTypeDef pCallback)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+  if (pCallback == NULL)
+  {
+    hDMAIdleReciever->ErrorCode |= HAL_DMAIdleReciever_ERROR_INVALID_CALLBACK;
+
+    return HAL_ERROR;
+  }
+
+  /* Process locked */
+  __HAL_LOCK(hDMAIdleReciever);
+
+  if (hDMAIdleReciever->gState == HAL_DMAIdleReciever_STATE_READY)
+  {
+    hDMAIdleReciever->RxNearFullCallback = pCallback;
+  }
+  else
+  {
+    hDMAIdleReciever->ErrorCode |= HAL_DMAIdleReciever_ERROR_INVALID_CALLBACK;
+
+    status =  HAL_ERROR;
+  }
+
+  /* Release Lock */
+  __HAL_UNLOCK(hDMAIdleReciever);
+
+  return status;
+}
+
+/**
+  * @brief  UnRegister the DMAIdleReciever Rx Near Full Callback
+  *         DMAIdleReciever Rx Near Full Callback is redirected to the weak HAL_DMAIdleRecieverEx_RxNearFullCallback() predefined callback
+  * @param  hDMAIdleReciever     DMAIdleReciever handle
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_DMAIdleReciever_UnRegisterRxNearFullCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+  /* Process locked */
+  __HAL_LOCK(hDMAIdleReciever);
+
+  if (hDMAIdleReciever->gState == HAL_DMAIdleReciever_STATE_READY)
+  {
+    hDMAIdleReciever->RxNearFullCallback = HAL_DMAIdleRecieverEx_RxNearFullCallback; /* Legacy weak DMAIdleReciever Rx Near Full Callback  */
+  }
+  else
+  {
+    hDMAIdleReciever->ErrorCode |= HAL_DMAIdleReciever_ERROR_INVALID_CALLBACK;
+
+    status =  HAL_ERROR;
+  }
+
+  /* Release Lock */
+  __HAL_UNLOCK(hDMAIdleReciever);
+  return status;
+}
 #endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
 
 /**
@@ -1383,7 +1521,7 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_Transmit_DMA(DMAIdleReciever_HandleTypeDef
   /* Check that a Tx process is not already ongoing */
   if (hDMAIdleReciever->gState == HAL_DMAIdleReciever_STATE_READY)
   {
-    if ((pData == NULL) || (Size == 0U))
+    if ((pData == NULL) || (Size == 0U) || !IS_DMAIdleReciever_DMA_BUFFER(pData))
     {
       return HAL_ERROR;
     }
@@ -1434,6 +1572,50 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_Transmit_DMA(DMAIdleReciever_HandleTypeDef
   }
 }
 
+/**
+  * @brief  Chain the next buffer of a DMA transmission before the current one has left the USART.
+  * @note   Only valid from HAL_DMAIdleRecieverEx_TxDmaCpltCallback(). The Tx DMA stream is
+  *         restarted while the USART still shifts out the last one or two bytes of the previous
+  *         buffer, so the line does not go idle between buffers. HAL_DMAIdleReciever_TxCpltCallback()
+  *         is only called after a buffer that is not followed by another one.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  pData Pointer to data buffer (u8 or u16 data elements), in flash or SRAM.
+  * @param  Size  Amount of data elements (u8 or u16) to be sent.
+  * @retval HAL_ERROR outside HAL_DMAIdleRecieverEx_TxDmaCpltCallback() or for an empty or CCM RAM
+  *         buffer; HAL_OK otherwise
+  */
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ContinueTransmit_DMA(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, const uint8_t *pData,
+                                                           uint16_t Size)
+{
+  const uint32_t *tmp;
+
+  /* Between the Tx DMA transfer complete and the enabling of the USART TC interrupt */
+  if ((hDMAIdleReciever->gState != HAL_DMAIdleReciever_STATE_BUSY_TX) || (hDMAIdleReciever->hdmatx == NULL)
+      || (hDMAIdleReciever->hdmatx->State != HAL_DMA_STATE_READY) || (hDMAIdleReciever->TxXferCount != 0U)
+      || (READ_BIT(hDMAIdleReciever->Instance->CR1, USART_CR1_TCIE) != 0U))
+  {
+    return HAL_ERROR;
+  }
+  if ((pData == NULL) || (Size == 0U) || !IS_DMAIdleReciever_DMA_BUFFER(pData))
+  {
+    return HAL_ERROR;
+  }
+
+  hDMAIdleReciever->pTxBuffPtr = pData;
+  hDMAIdleReciever->TxXferSize = Size;
+  hDMAIdleReciever->TxXferCount = Size;
+
+  tmp = (const uint32_t *)&pData;
+  if (HAL_DMA_Start_IT(hDMAIdleReciever->hdmatx, *(const uint32_t *)tmp, (uint32_t)&hDMAIdleReciever->Instance->DR, Size) != HAL_OK)
+  {
+    hDMAIdleReciever->TxXferCount = 0U;
+    hDMAIdleReciever->ErrorCode |= HAL_DMAIdleReciever_ERROR_DMA;
+    return HAL_ERROR;
+  }
+
+  return HAL_OK;
+}
+
 /**
   * @brief  Receives an amount of data in DMA mode.
   * @note   When DMAIdleReciever parity is not enabled (PCE = 0), and Word Length is configured to 9 bits (M1-M0 = 01),
@@ -1451,7 +1633,7 @@ HAL_StatusTypeDef HAL_DMAIdleReciever_Receive_DMA(DMAIdleReciever_HandleTypeDef
   /* Check that a Rx process is not already ongoing */
   if (hDMAIdleReciever->RxState == HAL_DMAIdleReciever_STATE_READY)
   {
-    if ((pData == NULL) || (Size == 0U))
+    if ((pData == NULL) || (Size == 0U) || !IS_DMAIdleReciever_DMA_BUFFER(pData))
     {
       return HAL_ERROR;
     }
@@ -1773,6 +1955,9 @@ HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_IT(DMAIdleReciever_HandleT
   * @note   When DMAIdleReciever parity is not enabled (PCE = 0), and Word Length is configured to 9 bits (M = 01),
   *         the received data is handled as a set of uint16_t. In this case, Size must indicate the number
   *         of uint16_t available through pData.
+  * @note   With the Rx DMA stream FIFO enabled, the stream must be in Normal mode, pData aligned on
+  *         the memory burst size and Size a multiple of the memory data width. An IDLE event ends
+  *         the reception after flushing the FIFO; HT events are not reported.
   * @param hDMAIdleReciever DMAIdleReciever handle.
   * @param pData Pointer to data buffer (uint8_t or uint16_t data elements).
   * @param Size  Amount of data elements (uint8_t or uint16_t) to be received.
@@ -1785,7 +1970,12 @@ HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(DMAIdleReciever_Handle
   /* Check that a Rx process is not already ongoing */
   if (hDMAIdleReciever->RxState == HAL_DMAIdleReciever_STATE_READY)
   {
-    if ((pData == NULL) || (Size == 0U))
+    if ((pData == NULL) || (Size == 0U) || !IS_DMAIdleReciever_DMA_BUFFER(pData))
+    {
+      return HAL_ERROR;
+    }
+
+    if (DMAIdleReciever_CheckRxFifo(hDMAIdleReciever, pData, Size) != HAL_OK)
     {
       return HAL_ERROR;
     }
@@ -1819,6 +2009,269 @@ HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(DMAIdleReciever_Handle
   }
 }
 
+/**
+  * @brief Receive data in DMA double-buffer (ping-pong) mode, reporting IDLE events.
+  * @note   The DMA stream fills pData0 then pData1 alternately. When one buffer is full the
+  *         Rx Event callback is called with Size equal to the buffer size (event type TC) and the
+  *         application owns that buffer until the DMA has filled the other one.
+  *         HT and IDLE events report the number of data elements received so far in the buffer
+  *         currently being filled.
+  * @note   Within the Rx Event callback, HAL_DMAIdleRecieverEx_GetRxEventBuffer() returns the buffer
+  *         the reported Size refers to.
+  * @note   The Rx DMA stream must be configured in DMA_CIRCULAR mode, with its FIFO disabled.
+  * @note   When DMAIdleReciever parity is not enabled (PCE = 0), and Word Length is configured to 9 bits (M = 01),
+  *         the received data is handled as a set of uint16_t. In this case, Size must indicate the number
+  *         of uint16_t available through each buffer.
+  * @param hDMAIdleReciever DMAIdleReciever handle.
+  * @param pData0 Pointer to first data buffer (uint8_t or uint16_t data elements).
+  * @param pData1 Pointer to second data buffer (uint8_t or uint16_t data elements).
+  * @param Size  Amount of data elements (uint8_t or uint16_t) in each buffer.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA_DoubleBuffer(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint8_t *pData0,
+                                                                     uint8_t *pData1, uint16_t Size)
+{
+  uint32_t *tmp0;
+  uint32_t *tmp1;
+
+  /* Check that a Rx process is not already ongoing */
+  if (hDMAIdleReciever->RxState != HAL_DMAIdleReciever_STATE_READY)
+  {
+    return HAL_BUSY;
+  }
+
+  if ((pData0 == NULL) || (pData1 == NULL) || (Size == 0U)
+      || !IS_DMAIdleReciever_DMA_BUFFER(pData0) || !IS_DMAIdleReciever_DMA_BUFFER(pData1)
+      || (hDMAIdleReciever->hdmarx == NULL) || (hDMAIdleReciever->hdmarx->Init.Mode != DMA_CIRCULAR)
+      || (DMAIdleReciever_CheckRxFifo(hDMAIdleReciever, pData0, Size) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  /* Set Reception type to reception till IDLE Event*/
+  hDMAIdleReciever->ReceptionType = HAL_DMAIdleReciever_RECEPTION_TOIDLE;
+  hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_TC;
+
+  hDMAIdleReciever->pRxBuffPtr = pData0;
+  hDMAIdleReciever->pRxBuffM1Ptr = pData1;
+  hDMAIdleReciever->RxXferSize = Size;
+  hDMAIdleReciever->RxReadPos = 0U;
+  hDMAIdleReciever->RxBufferIndex = 0U;
+
+  hDMAIdleReciever->ErrorCode = HAL_DMAIdleReciever_ERROR_NONE;
+  hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_BUSY_RX;
+
+  /* Memory 0 and memory 1 share the same callbacks: the buffer is identified from the CT bit */
+  hDMAIdleReciever->hdmarx->XferCpltCallback = DMAIdleReciever_DMAReceiveCplt;
+  hDMAIdleReciever->hdmarx->XferM1CpltCallback = DMAIdleReciever_DMAReceiveCplt;
+  hDMAIdleReciever->hdmarx->XferHalfCpltCallback = DMAIdleReciever_DMARxHalfCplt;
+  hDMAIdleReciever->hdmarx->XferM1HalfCpltCallback = DMAIdleReciever_DMARxHalfCplt;
+
+  /* Set the DMA error callback */
+  hDMAIdleReciever->hdmarx->XferErrorCallback = DMAIdleReciever_DMAError;
+
+  /* Set the DMA abort callback */
+  hDMAIdleReciever->hdmarx->XferAbortCallback = NULL;
+
+  /* Enable the DMA stream in double buffer mode */
+  tmp0 = (uint32_t *)&pData0;
+  tmp1 = (uint32_t *)&pData1;
+  if (HAL_DMAEx_MultiBufferStart_IT(hDMAIdleReciever->hdmarx, (uint32_t)&hDMAIdleReciever->Instance->DR, *(uint32_t *)tmp0,
+                                    *(uint32_t *)tmp1, Size) != HAL_OK)
+  {
+    /* Set error code to DMA */
+    hDMAIdleReciever->ErrorCode = HAL_DMAIdleReciever_ERROR_DMA;
+
+    /* Restore hDMAIdleReciever->RxState to ready */
+    hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_READY;
+    hDMAIdleReciever->ReceptionType = HAL_DMAIdleReciever_RECEPTION_STANDARD;
+    hDMAIdleReciever->pRxBuffM1Ptr = NULL;
+
+    return HAL_ERROR;
+  }
+  /* Clear the Overrun flag just before enabling the DMA Rx request: can be mandatory for the second transfer */
+  __HAL_DMAIdleReciever_CLEAR_OREFLAG(hDMAIdleReciever);
+
+  if (hDMAIdleReciever->Init.Parity != DMAIdleReciever_PARITY_NONE)
+  {
+    /* Enable the DMAIdleReciever Parity Error Interrupt */
+    ATOMIC_SET_BIT(hDMAIdleReciever->Instance->CR1, USART_CR1_PEIE);
+  }
+
+  /* Enable the DMAIdleReciever Error Interrupt: (Frame error, noise error, overrun error) */
+  ATOMIC_SET_BIT(hDMAIdleReciever->Instance->CR3, USART_CR3_EIE);
+
+  /* Enable the DMA transfer for the receiver request by setting the DMAR bit
+  in the DMAIdleReciever CR3 register */
+  ATOMIC_SET_BIT(hDMAIdleReciever->Instance->CR3, USART_CR3_DMAR);
+
+  /* Check Rx process has been successfully started */
+  if (hDMAIdleReciever->ReceptionType != HAL_DMAIdleReciever_RECEPTION_TOIDLE)
+  {
+    /* Errors already pending when reception is started may have aborted it */
+    return HAL_ERROR;
+  }
+
+  __HAL_DMAIdleReciever_CLEAR_IDLEFLAG(hDMAIdleReciever);
+  ATOMIC_SET_BIT(hDMAIdleReciever->Instance->CR1, USART_CR1_IDLEIE);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief Provide the reception buffer the last Rx Event refers to.
+  * @note  In double-buffer mode, returns the buffer (first or second one given to
+  *        HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA_DoubleBuffer()) whose fill level was reported by the
+  *        last Rx Event callback. In other modes, returns the reception buffer.
+  * @note  This function is expected to be called within the user implementation of Rx Event Callback.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @retval Pointer to the reception buffer
+  */
+uint8_t *HAL_DMAIdleRecieverEx_GetRxEventBuffer(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  if ((hDMAIdleReciever->RxBufferIndex != 0U) && (hDMAIdleReciever->pRxBuffM1Ptr != NULL))
+  {
+    return hDMAIdleReciever->pRxBuffM1Ptr;
+  }
+  return hDMAIdleReciever->pRxBuffPtr;
+}
+
+/**
+  * @brief Provide the data received in DMA mode and not yet released, without copying it.
+  * @note   The returned segments point inside the reception buffer given to
+  *         HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA(). The producer position is read from the DMA
+  *         stream NDTR counter, so the view also covers bytes received since the last Rx Event;
+  *         in Circular mode they are added to the count sampled on that event, which assumes
+  *         less than a buffer length was received since.
+  * @note   Data stays valid until released with HAL_DMAIdleRecieverEx_ReleaseRxData(). In Circular mode
+  *         the application must release data before the DMA laps the read position, i.e. at least
+  *         once per buffer length of received data. Bytes overwritten before being released are
+  *         skipped by the next call and accounted in RxLostCount and RxLapCount.
+  * @note   This function can be called from the Rx Event callback or from thread context, but only
+  *         from one consumer context.
+  * @param hDMAIdleReciever DMAIdleReciever handle.
+  * @param pView Pointer to the view structure to fill.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_GetRxView(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, DMAIdleReciever_RxViewTypeDef *pView)
+{
+  uint16_t wr_pos;
+  uint16_t rd_pos;
+  uint16_t last_pos;
+  uint32_t produced;
+  uint32_t primask;
+  uint32_t unread;
+  uint32_t lost;
+
+  if (pView == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  pView->pData1 = NULL;
+  pView->Size1  = 0U;
+  pView->pData2 = NULL;
+  pView->Size2  = 0U;
+
+  /* Only single-buffer DMA based reception of 8 bits data elements can be viewed in place */
+  if ((hDMAIdleReciever->RxState != HAL_DMAIdleReciever_STATE_BUSY_RX)
+      || (hDMAIdleReciever->hdmarx == NULL)
+      || (HAL_IS_BIT_CLR(hDMAIdleReciever->Instance->CR3, USART_CR3_DMAR))
+      || (HAL_IS_BIT_SET(hDMAIdleReciever->hdmarx->Instance->CR, DMA_SxCR_DBM))
+      || ((hDMAIdleReciever->Init.WordLength == DMAIdleReciever_WORDLENGTH_9B) && (hDMAIdleReciever->Init.Parity == DMAIdleReciever_PARITY_NONE)))
+  {
+    return HAL_ERROR;
+  }
+
+  /* Current DMA write position, sampled together with the producer count of the last event */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  wr_pos = hDMAIdleReciever->RxXferSize - (uint16_t) __HAL_DMA_GET_COUNTER(hDMAIdleReciever->hdmarx);
+  produced = hDMAIdleReciever->RxProducedCount;
+  last_pos = hDMAIdleReciever->RxLastWritePos;
+  __set_PRIMASK(primask);
+
+  if (hDMAIdleReciever->hdmarx->Init.Mode == DMA_CIRCULAR)
+  {
+    /* NDTR reloads on wrap: a full count is position 0. Bytes written since the last event
+       are added to its count, so the lap check, the skip and the view use one snapshot */
+    if (wr_pos == hDMAIdleReciever->RxXferSize)
+    {
+      wr_pos = 0U;
+    }
+    produced += ((uint32_t)wr_pos + hDMAIdleReciever->RxXferSize - last_pos) % hDMAIdleReciever->RxXferSize;
+
+    /* None unread if the consumer already released every byte written; above the buffer
+       size, the DMA has lapped the read position and the oldest bytes were overwritten:
+       skip them and account for them */
+    unread = produced - hDMAIdleReciever->RxConsumedCount;
+    if ((int32_t)unread < 0)
+    {
+      unread = 0U;
+    }
+    if (unread > hDMAIdleReciever->RxXferSize)
+    {
+      lost = unread - hDMAIdleReciever->RxXferSize;
+      hDMAIdleReciever->RxLostCount += lost;
+      hDMAIdleReciever->RxLapCount++;
+      hDMAIdleReciever->RxConsumedCount += lost;
+      hDMAIdleReciever->RxReadPos = (uint16_t)((hDMAIdleReciever->RxReadPos + lost) % hDMAIdleReciever->RxXferSize);
+      unread = hDMAIdleReciever->RxXferSize;
+    }
+  }
+  else
+  {
+    /* Normal mode: the transfer never wraps, NDTR reads 0 at its end */
+    unread = (wr_pos > hDMAIdleReciever->RxReadPos) ? (uint32_t)(wr_pos - hDMAIdleReciever->RxReadPos) : 0U;
+  }
+  rd_pos = hDMAIdleReciever->RxReadPos;
+
+  /* Unread data may wrap around the end of the circular buffer */
+  pView->pData1 = &hDMAIdleReciever->pRxBuffPtr[rd_pos];
+  pView->Size1  = (uint16_t)unread;
+  if (unread > (uint32_t)(hDMAIdleReciever->RxXferSize - rd_pos))
+  {
+    pView->Size1  = hDMAIdleReciever->RxXferSize - rd_pos;
+    pView->pData2 = hDMAIdleReciever->pRxBuffPtr;
+    pView->Size2  = (uint16_t)(unread - pView->Size1);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief Release data previously obtained with HAL_DMAIdleRecieverEx_GetRxView().
+  * @note  Bytes are released in reception order, starting from pView->pData1.
+  * @param hDMAIdleReciever DMAIdleReciever handle.
+  * @param Size Number of bytes consumed by the application.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_ReleaseRxData(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Size)
+{
+  DMAIdleReciever_RxViewTypeDef view;
+  uint32_t rd_pos;
+
+  if (HAL_DMAIdleRecieverEx_GetRxView(hDMAIdleReciever, &view) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  if (Size > ((uint32_t)view.Size1 + view.Size2))
+  {
+    return HAL_ERROR;
+  }
+
+  rd_pos = (uint32_t)hDMAIdleReciever->RxReadPos + Size;
+  if (rd_pos >= hDMAIdleReciever->RxXferSize)
+  {
+    rd_pos -= hDMAIdleReciever->RxXferSize;
+  }
+  hDMAIdleReciever->RxReadPos = (uint16_t)rd_pos;
+  hDMAIdleReciever->RxConsumedCount += Size;
+
+  return HAL_OK;
+}
+
 /**
   * @brief Provide Rx Event type that has lead to RxEvent callback execution.
   * @note  When HAL_DMAIdleRecieverEx_ReceiveToIdle_IT() or HAL_DMAIdleRecieverEx_ReceiveToIdle_DMA() API are called, progress
@@ -1849,6 +2302,112 @@ HAL_DMAIdleReciever_RxEventTypeTypeDef HAL_DMAIdleRecieverEx_GetRxEventType(DMAI
   return(hDMAIdleReciever->RxEventType);
 }
 
+/**
+  * @brief  Select which Rx Events of a circular DMA reception reach the Rx Event callback.
+  * @note   EventMask is a combination of @ref DMAIdleReciever_RxEvent_Mask values. An event whose
+  *         type is masked does not call the callback; its bytes stay pending and are reported
+  *         by the next delivered event.
+  * @note   A non zero Coalesce also holds back HT and TC events until at least Coalesce bytes
+  *         have been received since the last delivered event. IDLE events, which end a burst,
+  *         are always delivered when enabled in EventMask.
+  * @note   The DMA write position is still sampled on every event, so lap detection and
+  *         HAL_DMAIdleRecieverEx_RxNearFullCallback() are not affected. With HT or TC masked
+  *         the consumer must however keep up on its own: Coalesce should not exceed half of
+  *         the reception buffer.
+  * @note   The policy only applies to circular DMA receptions; other receptions report every event.
+  *         The default policy, set by HAL_DMAIdleReciever_Init(), reports every event.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  EventMask Rx Events to report (HAL_DMAIdleReciever_RXEVENT_MASK_ALL for all).
+  * @param  Coalesce  Minimum number of bytes reported by an HT or TC event, 0 for no coalescing.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_DMAIdleRecieverEx_SetRxEventPolicy(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t EventMask,
+                                                         uint16_t Coalesce)
+{
+  /* Check the parameters */
+  assert_param(IS_DMAIdleReciever_RXEVENT_MASK(EventMask));
+
+  if (!IS_DMAIdleReciever_RXEVENT_MASK(EventMask))
+  {
+    return HAL_ERROR;
+  }
+
+  hDMAIdleReciever->RxEventMask = (uint8_t)EventMask;
+  hDMAIdleReciever->RxEventCoalesce = Coalesce;
+  hDMAIdleReciever->RxEventPending = 0U;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Provide the time of the last Rx Event.
+  * @note   The DWT cycle count is captured when the HT or TC interrupt of the Rx DMA or the IDLE
+  *         interrupt of the DMAIdleReciever is handled. For IDLE events, it is moved back by one
+  *         character time (RxCharCycles) so that it marks the end of the last received byte.
+  *         Interrupt latency is not compensated.
+  * @note   This function is expected to be called within the user implementation of Rx Event Callback.
+  *         Convert with HAL_DMAIdleRecieverEx_CyclesToNs().
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @retval Core clock cycles since the cycle counter was started
+  */
+uint64_t HAL_DMAIdleRecieverEx_GetRxEventTimestamp(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  return hDMAIdleReciever->RxEventTimestamp;
+}
+
+/**
+  * @brief  Start the DWT cycle counter used for Rx Event timestamps.
+  * @note   Call once at start-up, before the first reception; other users of the cycle
+  *         counter (e.g. the auto-baud detector) rely on it as well.
+  * @retval None
+  */
+void HAL_DMAIdleRecieverEx_TimestampInit(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+  * @brief  Read the DWT cycle counter, extended to 64 bits.
+  * @note   The 32-bit counter wraps every 2^32 core clock cycles (about 60 s at 72 MHz): this
+  *         function must run at least once per wrap period for the extension to stay exact,
+  *         e.g. from the SysTick interrupt. Rx Events call it on their own.
+  * @retval Core clock cycles since the cycle counter was started
+  */
+uint64_t HAL_DMAIdleRecieverEx_GetCycles(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  uint32_t now;
+  uint32_t high;
+
+  /* The extension is shared by interrupts of any priority */
+  __disable_irq();
+  now = DWT->CYCCNT;
+  if (now < DMAIdleReciever_CyclesLast)
+  {
+    DMAIdleReciever_CyclesHigh++;
+  }
+  DMAIdleReciever_CyclesLast = now;
+  high = DMAIdleReciever_CyclesHigh;
+  __set_PRIMASK(primask);
+
+  return ((uint64_t)high << 32U) | now;
+}
+
+/**
+  * @brief  Convert core clock cycles to nanoseconds, using SystemCoreClock.
+  * @param  Cycles Core clock cycles.
+  * @retval Nanoseconds
+  */
+uint64_t HAL_DMAIdleRecieverEx_CyclesToNs(uint64_t Cycles)
+{
+  uint64_t sec = Cycles / SystemCoreClock;
+  uint64_t rem = Cycles % SystemCoreClock;
+
+  /* Whole seconds apart, so that rem * 1e9 cannot overflow */
+  return (sec * 1000000000ULL) + ((rem * 1000000000ULL) / SystemCoreClock);
+}
+
 /**
   * @brief  Abort ongoing transfers (blocking mode).
   * @param  hDMAIdleReciever DMAIdleReciever handle.
@@ -2485,6 +3044,9 @@ void HAL_DMAIdleReciever_IRQHandler(DMAIdleReciever_HandleTypeDef *hDMAIdleRecie
       && ((isrflags & USART_SR_IDLE) != 0U)
       && ((cr1its & USART_CR1_IDLEIE) != 0U))
   {
+    /* IDLE is set one character time after the end of the last byte */
+    DMAIdleReciever_RxTimestamp(hDMAIdleReciever, hDMAIdleReciever->RxCharCycles);
+
     __HAL_DMAIdleReciever_CLEAR_IDLEFLAG(hDMAIdleReciever);
 
     /* Check if DMA mode is enabled in DMAIdleReciever */
@@ -2495,6 +3057,9 @@ void HAL_DMAIdleReciever_IRQHandler(DMAIdleReciever_HandleTypeDef *hDMAIdleRecie
          (DMA cplt callback will be called).
          Otherwise, if at least one data has already been received, IDLE event is to be notified to user */
       uint16_t nb_remaining_rx_data = (uint16_t) __HAL_DMA_GET_COUNTER(hDMAIdleReciever->hdmarx);
+
+      DMAIdleReciever_RxTrack(hDMAIdleReciever);
+
       if ((nb_remaining_rx_data > 0U)
           && (nb_remaining_rx_data < hDMAIdleReciever->RxXferSize))
       {
@@ -2518,21 +3083,25 @@ void HAL_DMAIdleReciever_IRQHandler(DMAIdleReciever_HandleTypeDef *hDMAIdleRecie
 
           ATOMIC_CLEAR_BIT(hDMAIdleReciever->Instance->CR1, USART_CR1_IDLEIE);
 
-          /* Last bytes received, so no need as the abort is immediate */
+          /* Last bytes received, so no need as the abort is immediate. Disabling the stream
+             flushes its FIFO: HAL_DMA_Abort() returns once EN reads 0, i.e. once the bytes
+             still parked in the FIFO are in memory, before the Rx Event callback below */
           (void)HAL_DMA_Abort(hDMAIdleReciever->hdmarx);
+          hDMAIdleReciever->RxXferCount = (uint16_t) __HAL_DMA_GET_COUNTER(hDMAIdleReciever->hdmarx);
+        }
+
+        /* In double-buffer mode, the partial fill refers to the buffer currently targeted by the DMA */
+        if (HAL_IS_BIT_SET(hDMAIdleReciever->hdmarx->Instance->CR, DMA_SxCR_DBM))
+        {
+          hDMAIdleReciever->RxBufferIndex = HAL_IS_BIT_SET(hDMAIdleReciever->hdmarx->Instance->CR, DMA_SxCR_CT) ? 1U : 0U;
         }
 
         /* Initialize type of RxEvent that correspond to RxEvent callback execution;
         In this case, Rx Event type is Idle Event */
         hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_IDLE;
 
-#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
-        /*Call registered Rx Event callback*/
-        hDMAIdleReciever->RxEventCallback(hDMAIdleReciever, (hDMAIdleReciever->RxXferSize - hDMAIdleReciever->RxXferCount));
-#else
-        /*Call legacy weak Rx Event callback*/
-        HAL_DMAIdleRecieverEx_RxEventCallback(hDMAIdleReciever, (hDMAIdleReciever->RxXferSize - hDMAIdleReciever->RxXferCount));
-#endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
+        /* Apply the reporting policy, then call the Rx Event callback */
+        DMAIdleReciever_RxEventNotify(hDMAIdleReciever, (hDMAIdleReciever->RxXferSize - hDMAIdleReciever->RxXferCount));
       }
       else
       {
@@ -2542,17 +3111,18 @@ void HAL_DMAIdleReciever_IRQHandler(DMAIdleReciever_HandleTypeDef *hDMAIdleRecie
         {
           if (hDMAIdleReciever->hdmarx->Init.Mode == DMA_CIRCULAR)
           {
+            /* In double-buffer mode, the full buffer is the one the DMA has just switched from */
+            if (HAL_IS_BIT_SET(hDMAIdleReciever->hdmarx->Instance->CR, DMA_SxCR_DBM))
+            {
+              hDMAIdleReciever->RxBufferIndex = HAL_IS_BIT_SET(hDMAIdleReciever->hdmarx->Instance->CR, DMA_SxCR_CT) ? 0U : 1U;
+            }
+
             /* Initialize type of RxEvent that correspond to RxEvent callback execution;
                In this case, Rx Event type is Idle Event */
             hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_IDLE;
 
-#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
-            /*Call registered Rx Event callback*/
-            hDMAIdleReciever->RxEventCallback(hDMAIdleReciever, hDMAIdleReciever->RxXferSize);
-#else
-            /*Call legacy weak Rx Event callback*/
-            HAL_DMAIdleRecieverEx_RxEventCallback(hDMAIdleReciever, hDMAIdleReciever->RxXferSize);
-#endif /* (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS) */
+            /* Apply the reporting policy, then call the Rx Event callback */
+            DMAIdleReciever_RxEventNotify(hDMAIdleReciever, hDMAIdleReciever->RxXferSize);
           }
         }
       }
@@ -2748,6 +3318,44 @@ __weak void HAL_DMAIdleRecieverEx_RxEventCallback(DMAIdleReciever_HandleTypeDef
    */
 }
 
+/**
+  * @brief  Reception near full callback.
+  * @note   Called from the Rx Event interrupt path when the unread data level reaches
+  *         RxNearFullThreshold, once per crossing, so the application can throttle the
+  *         remote transmitter before the DMA laps the read position.
+  * @param  hDMAIdleReciever DMAIdleReciever handle
+  * @param  Unread Number of bytes received and not yet released.
+  * @retval None
+  */
+__weak void HAL_DMAIdleRecieverEx_RxNearFullCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t Unread)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hDMAIdleReciever);
+  UNUSED(Unread);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the HAL_DMAIdleRecieverEx_RxNearFullCallback can be implemented in the user file.
+   */
+}
+
+/**
+  * @brief  Tx DMA transfer complete callback.
+  * @note   Called from the Tx DMA stream interrupt at the end of a Normal mode DMA
+  *         transmission, before the USART has sent the last bytes. The next buffer may be
+  *         chained from here with HAL_DMAIdleRecieverEx_ContinueTransmit_DMA().
+  * @param  hDMAIdleReciever DMAIdleReciever handle
+  * @retval None
+  */
+__weak void HAL_DMAIdleRecieverEx_TxDmaCpltCallback(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(hDMAIdleReciever);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the HAL_DMAIdleRecieverEx_TxDmaCpltCallback can be implemented in the user file.
+   */
+}
+
 /**
   * @}
   */
@@ -3002,6 +3610,8 @@ void DMAIdleReciever_InitCallbacksToDefault(DMAIdleReciever_HandleTypeDef *hDMAI
   hDMAIdleReciever->AbortTransmitCpltCallback = HAL_DMAIdleReciever_AbortTransmitCpltCallback; /* Legacy weak AbortTransmitCpltCallback */
   hDMAIdleReciever->AbortReceiveCpltCallback  = HAL_DMAIdleReciever_AbortReceiveCpltCallback;  /* Legacy weak AbortReceiveCpltCallback  */
   hDMAIdleReciever->RxEventCallback           = HAL_DMAIdleRecieverEx_RxEventCallback;         /* Legacy weak RxEventCallback           */
+  hDMAIdleReciever->RxNearFullCallback        = HAL_DMAIdleRecieverEx_RxNearFullCallback;      /* Legacy weak RxNearFullCallback        */
+  hDMAIdleReciever->TxDmaCpltCallback         = HAL_DMAIdleRecieverEx_TxDmaCpltCallback;       /* Legacy weak TxDmaCpltCallback         */
 
 }
 #endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
@@ -3020,6 +3630,18 @@ static void DMAIdleReciever_DMATransmitCplt(DMA_HandleTypeDef *hdma)
   {
     hDMAIdleReciever->TxXferCount = 0x00U;
 
+    /* The USART still holds the last bytes: the next buffer may be chained now */
+#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
+    hDMAIdleReciever->TxDmaCpltCallback(hDMAIdleReciever);
+#else
+    HAL_DMAIdleRecieverEx_TxDmaCpltCallback(hDMAIdleReciever);
+#endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
+    if (hdma->State == HAL_DMA_STATE_BUSY)
+    {
+      /* Restarted by HAL_DMAIdleRecieverEx_ContinueTransmit_DMA(), DMAT stays set */
+      return;
+    }
+
     /* Disable the DMA transfer for transmit request by setting the DMAT bit
        in the DMAIdleReciever CR3 register */
     ATOMIC_CLEAR_BIT(hDMAIdleReciever->Instance->CR3, USART_CR3_DMAT);
@@ -3070,6 +3692,9 @@ static void DMAIdleReciever_DMAReceiveCplt(DMA_HandleTypeDef *hdma)
 {
   DMAIdleReciever_HandleTypeDef *hDMAIdleReciever = (DMAIdleReciever_HandleTypeDef *)((DMA_HandleTypeDef *)hdma)->Parent;
 
+  /* The DMA request follows the stop bit of the last byte by a few cycles only */
+  DMAIdleReciever_RxTimestamp(hDMAIdleReciever, 0U);
+
   /* DMA Normal mode*/
   if ((hdma->Instance->CR & DMA_SxCR_CIRC) == 0U)
   {
@@ -3093,6 +3718,14 @@ static void DMAIdleReciever_DMAReceiveCplt(DMA_HandleTypeDef *hdma)
     }
   }
 
+  DMAIdleReciever_RxTrack(hDMAIdleReciever);
+
+  /* In double-buffer mode, CT already points to the next buffer: the completed one is the other */
+  if ((hdma->Instance->CR & DMA_SxCR_DBM) != 0U)
+  {
+    hDMAIdleReciever->RxBufferIndex = ((hdma->Instance->CR & DMA_SxCR_CT) != 0U) ? 0U : 1U;
+  }
+
   /* Initialize type of RxEvent that correspond to RxEvent callback execution;
    In this case, Rx Event type is Transfer Complete */
   hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_TC;
@@ -3101,13 +3734,8 @@ static void DMAIdleReciever_DMAReceiveCplt(DMA_HandleTypeDef *hdma)
      If Reception till IDLE event has been selected : use Rx Event callback */
   if (hDMAIdleReciever->ReceptionType == HAL_DMAIdleReciever_RECEPTION_TOIDLE)
   {
-#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
-    /*Call registered Rx Event callback*/
-    hDMAIdleReciever->RxEventCallback(hDMAIdleReciever, hDMAIdleReciever->RxXferSize);
-#else
-    /*Call legacy weak Rx Event callback*/
-    HAL_DMAIdleRecieverEx_RxEventCallback(hDMAIdleReciever, hDMAIdleReciever->RxXferSize);
-#endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
+    /* Apply the reporting policy, then call the Rx Event callback */
+    DMAIdleReciever_RxEventNotify(hDMAIdleReciever, hDMAIdleReciever->RxXferSize);
   }
   else
   {
@@ -3132,6 +3760,16 @@ static void DMAIdleReciever_DMARxHalfCplt(DMA_HandleTypeDef *hdma)
 {
   DMAIdleReciever_HandleTypeDef *hDMAIdleReciever = (DMAIdleReciever_HandleTypeDef *)((DMA_HandleTypeDef *)hdma)->Parent;
 
+  DMAIdleReciever_RxTimestamp(hDMAIdleReciever, 0U);
+
+  DMAIdleReciever_RxTrack(hDMAIdleReciever);
+
+  /* In double-buffer mode, the half filled buffer is the one currently targeted by the DMA */
+  if ((hdma->Instance->CR & DMA_SxCR_DBM) != 0U)
+  {
+    hDMAIdleReciever->RxBufferIndex = ((hdma->Instance->CR & DMA_SxCR_CT) != 0U) ? 1U : 0U;
+  }
+
   /* Initialize type of RxEvent that correspond to RxEvent callback execution;
      In this case, Rx Event type is Half Transfer */
   hDMAIdleReciever->RxEventType = HAL_DMAIdleReciever_RXEVENT_HT;
@@ -3140,13 +3778,8 @@ static void DMAIdleReciever_DMARxHalfCplt(DMA_HandleTypeDef *hdma)
      If Reception till IDLE event has been selected : use Rx Event callback */
   if (hDMAIdleReciever->ReceptionType == HAL_DMAIdleReciever_RECEPTION_TOIDLE)
   {
-#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
-    /*Call registered Rx Event callback*/
-    hDMAIdleReciever->RxEventCallback(hDMAIdleReciever, hDMAIdleReciever->RxXferSize / 2U);
-#else
-    /*Call legacy weak Rx Event callback*/
-    HAL_DMAIdleRecieverEx_RxEventCallback(hDMAIdleReciever, hDMAIdleReciever->RxXferSize / 2U);
-#endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
+    /* Apply the reporting policy, then call the Rx Event callback */
+    DMAIdleReciever_RxEventNotify(hDMAIdleReciever, hDMAIdleReciever->RxXferSize / 2U);
   }
   else
   {
@@ -3161,6 +3794,168 @@ static void DMAIdleReciever_DMARxHalfCplt(DMA_HandleTypeDef *hdma)
   }
 }
 
+/**
+  * @brief  Check a reception buffer against the Rx DMA stream FIFO constraints.
+  * @note   Nothing to check when the stream FIFO is disabled (direct mode).
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  pData Reception buffer.
+  * @param  Size  Amount of data elements to be received.
+  * @retval HAL_ERROR if the stream is circular, the buffer is not aligned on a memory
+  *         burst (which must not cross a 1 KB boundary) or Size is not a whole number of
+  *         memory data items; HAL_OK otherwise
+  */
+static HAL_StatusTypeDef DMAIdleReciever_CheckRxFifo(const DMAIdleReciever_HandleTypeDef *hDMAIdleReciever,
+                                                     const uint8_t *pData, uint16_t Size)
+{
+  const DMA_InitTypeDef *init;
+  uint32_t width;
+  uint32_t beats;
+
+  if ((hDMAIdleReciever->hdmarx == NULL) || (hDMAIdleReciever->hdmarx->Init.FIFOMode != DMA_FIFOMODE_ENABLE))
+  {
+    return HAL_OK;
+  }
+  init = &hDMAIdleReciever->hdmarx->Init;
+
+  if (init->Mode == DMA_CIRCULAR)
+  {
+    return HAL_ERROR;
+  }
+
+  width = (init->MemDataAlignment == DMA_MDATAALIGN_WORD) ? 4U
+          : ((init->MemDataAlignment == DMA_MDATAALIGN_HALFWORD) ? 2U : 1U);
+  beats = (init->MemBurst == DMA_MBURST_INC16) ? 16U
+          : ((init->MemBurst == DMA_MBURST_INC8) ? 8U
+             : ((init->MemBurst == DMA_MBURST_INC4) ? 4U : 1U));
+
+  if (((uint32_t)pData & ((width * beats) - 1U)) != 0U)
+  {
+    return HAL_ERROR;
+  }
+  if ((((uint32_t)Size * ((init->PeriphDataAlignment == DMA_PDATAALIGN_HALFWORD) ? 2U : 1U)) % width) != 0U)
+  {
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief  Sample the Rx DMA write position and update the producer side lap accounting.
+  * @note   Called on each HT, TC and IDLE event of a single-buffer circular DMA reception.
+  *         These events occur at least every half buffer, so the write position cannot move by
+  *         a full buffer between two samples. The USART and DMA stream interrupts must have the
+  *         same priority. Laps themselves are accounted by the consumer in
+  *         HAL_DMAIdleRecieverEx_GetRxView().
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @retval None
+  */
+static void DMAIdleReciever_RxTrack(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever)
+{
+  DMA_Stream_TypeDef *stream = (DMA_Stream_TypeDef *)hDMAIdleReciever->hdmarx->Instance;
+  uint32_t wr_pos;
+  uint32_t unread;
+
+  if ((stream->CR & (DMA_SxCR_CIRC | DMA_SxCR_DBM)) != DMA_SxCR_CIRC)
+  {
+    return;
+  }
+
+  wr_pos = (uint32_t)hDMAIdleReciever->RxXferSize - stream->NDTR;
+  if (wr_pos >= hDMAIdleReciever->RxXferSize)
+  {
+    wr_pos = 0U;
+  }
+  if (wr_pos < hDMAIdleReciever->RxLastWritePos)
+  {
+    wr_pos += hDMAIdleReciever->RxXferSize;
+  }
+  hDMAIdleReciever->RxProducedCount += wr_pos - hDMAIdleReciever->RxLastWritePos;
+  hDMAIdleReciever->RxLastWritePos = (uint16_t)(wr_pos % hDMAIdleReciever->RxXferSize);
+
+  if (hDMAIdleReciever->RxNearFullThreshold == 0U)
+  {
+    return;
+  }
+
+  /* The consumer may have released bytes received after the sample: nothing pending then */
+  unread = hDMAIdleReciever->RxProducedCount - hDMAIdleReciever->RxConsumedCount;
+  if ((int32_t)unread < (int32_t)hDMAIdleReciever->RxNearFullThreshold)
+  {
+    hDMAIdleReciever->RxNearFull = 0U;
+  }
+  else if (hDMAIdleReciever->RxNearFull == 0U)
+  {
+    hDMAIdleReciever->RxNearFull = 1U;
+#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
+    /*Call registered Rx Near Full callback*/
+    hDMAIdleReciever->RxNearFullCallback(hDMAIdleReciever, unread);
+#else
+    /*Call legacy weak Rx Near Full callback*/
+    HAL_DMAIdleRecieverEx_RxNearFullCallback(hDMAIdleReciever, unread);
+#endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
+  }
+}
+
+/**
+  * @brief  Apply the Rx Event reporting policy and call the Rx Event callback.
+  * @note   Pos is the fill level of the reception buffer, as passed to the callback. In circular
+  *         mode, the bytes received since the previous event are added to RxEventPending; the
+  *         callback is called when the event type is enabled in RxEventMask and, for HT and TC
+  *         events, when at least RxEventCoalesce bytes are pending.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  Pos Reception buffer fill level.
+  * @retval None
+  */
+static void DMAIdleReciever_RxEventNotify(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint16_t Pos)
+{
+  uint32_t delta;
+
+  if (hDMAIdleReciever->hdmarx->Init.Mode == DMA_CIRCULAR)
+  {
+    /* An IDLE event right after TC reports the same position: nothing new then */
+    if (Pos >= hDMAIdleReciever->RxEventLastPos)
+    {
+      delta = (uint32_t)Pos - hDMAIdleReciever->RxEventLastPos;
+    }
+    else
+    {
+      delta = (uint32_t)Pos + hDMAIdleReciever->RxXferSize - hDMAIdleReciever->RxEventLastPos;
+    }
+    hDMAIdleReciever->RxEventLastPos = Pos;
+    hDMAIdleReciever->RxEventPending += delta;
+
+    if ((hDMAIdleReciever->RxEventMask & (1UL << (uint32_t)hDMAIdleReciever->RxEventType)) == 0U)
+    {
+      return;
+    }
+    if ((hDMAIdleReciever->RxEventType != HAL_DMAIdleReciever_RXEVENT_IDLE)
+        && (hDMAIdleReciever->RxEventPending < hDMAIdleReciever->RxEventCoalesce))
+    {
+      return;
+    }
+    hDMAIdleReciever->RxEventPending = 0U;
+  }
+
+#if (USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS == 1)
+  /*Call registered Rx Event callback*/
+  hDMAIdleReciever->RxEventCallback(hDMAIdleReciever, Pos);
+#else
+  /*Call legacy weak Rx Event callback*/
+  HAL_DMAIdleRecieverEx_RxEventCallback(hDMAIdleReciever, Pos);
+#endif /* USE_HAL_DMAIdleReciever_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Record the time of an Rx Event.
+  * @param  hDMAIdleReciever DMAIdleReciever handle.
+  * @param  Correction Core clock cycles between the end of the last byte and the event.
+  * @retval None
+  */
+static void DMAIdleReciever_RxTimestamp(DMAIdleReciever_HandleTypeDef *hDMAIdleReciever, uint32_t Correction)
+{
+  hDMAIdleReciever->RxEventTimestamp = HAL_DMAIdleRecieverEx_GetCycles() - Correction;
+}
+
 /**
   * @brief  DMA DMAIdleReciever communication error callback.
   * @param  hdma  Pointer to a DMA_HandleTypeDef structure that contains
@@ -3265,6 +4060,8 @@ HAL_StatusTypeDef DMAIdleReciever_Start_Receive_IT(DMAIdleReciever_HandleTypeDef
   hDMAIdleReciever->pRxBuffPtr = pData;
   hDMAIdleReciever->RxXferSize = Size;
   hDMAIdleReciever->RxXferCount = Size;
+  hDMAIdleReciever->pRxBuffM1Ptr = NULL;
+  hDMAIdleReciever->RxBufferIndex = 0U;
 
   hDMAIdleReciever->ErrorCode = HAL_DMAIdleReciever_ERROR_NONE;
   hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_BUSY_RX;
@@ -3301,6 +4098,17 @@ HAL_StatusTypeDef DMAIdleReciever_Start_Receive_DMA(DMAIdleReciever_HandleTypeDe
 
   hDMAIdleReciever->pRxBuffPtr = pData;
   hDMAIdleReciever->RxXferSize = Size;
+  hDMAIdleReciever->RxReadPos = 0U;
+  hDMAIdleReciever->pRxBuffM1Ptr = NULL;
+  hDMAIdleReciever->RxBufferIndex = 0U;
+  hDMAIdleReciever->RxProducedCount = 0U;
+  hDMAIdleReciever->RxLastWritePos = 0U;
+  hDMAIdleReciever->RxConsumedCount = 0U;
+  hDMAIdleReciever->RxLostCount = 0U;
+  hDMAIdleReciever->RxLapCount = 0U;
+  hDMAIdleReciever->RxNearFull = 0U;
+  hDMAIdleReciever->RxEventLastPos = 0U;
+  hDMAIdleReciever->RxEventPending = 0U;
 
   hDMAIdleReciever->ErrorCode = HAL_DMAIdleReciever_ERROR_NONE;
   hDMAIdleReciever->RxState = HAL_DMAIdleReciever_STATE_BUSY_RX;
@@ -3308,8 +4116,16 @@ HAL_StatusTypeDef DMAIdleReciever_Start_Receive_DMA(DMAIdleReciever_HandleTypeDe
   /* Set the DMAIdleReciever DMA transfer complete callback */
   hDMAIdleReciever->hdmarx->XferCpltCallback = DMAIdleReciever_DMAReceiveCplt;
 
-  /* Set the DMAIdleReciever DMA Half transfer complete callback */
-  hDMAIdleReciever->hdmarx->XferHalfCpltCallback = DMAIdleReciever_DMARxHalfCplt;
+  /* Set the DMAIdleReciever DMA Half transfer complete callback; with the stream FIFO enabled,
+     the first half may still be partly in the FIFO when the counter reaches it */
+  if (hDMAIdleReciever->hdmarx->Init.FIFOMode == DMA_FIFOMODE_ENABLE)
+  {
+    hDMAIdleReciever->hdmarx->XferHalfCpltCallback = NULL;
+  }
+  else
+  {
+    hDMAIdleReciever->hdmarx->XferHalfCpltCallback = DMAIdleReciever_DMARxHalfCplt;
+  }
 
   /* Set the DMA error callback */
   hDMAIdleReciever->hdmarx->XferErrorCallback = DMAIdleReciever_DMAError;
@@ -3732,6 +4548,8 @@ static void DMAIdleReciever_SetConfig(DMAIdleReciever_HandleTypeDef *hDMAIdleRec
 {
   uint32_t tmpreg;
   uint32_t pclk;
+  uint32_t bit_cycles;
+  uint32_t bits;
 
   /* Check the parameters */
   assert_param(IS_DMAIdleReciever_BAUDRATE(hDMAIdleReciever->Init.BaudRate));
@@ -3790,6 +4608,23 @@ static void DMAIdleReciever_SetConfig(DMAIdleReciever_HandleTypeDef *hDMAIdleRec
   {
     hDMAIdleReciever->Instance->BRR = DMAIdleReciever_BRR_SAMPLING16(pclk, hDMAIdleReciever->Init.BaudRate);
   }
+
+  /*-------------------------- Rx timestamps ---------------------------------*/
+  /* Bit time in APB clock cycles is 16 (or 8) times USARTDIV, as programmed in BRR */
+  tmpreg = hDMAIdleReciever->Instance->BRR;
+  if (hDMAIdleReciever->Init.OverSampling == DMAIdleReciever_OVERSAMPLING_8)
+  {
+    bit_cycles = ((tmpreg >> 4U) << 3U) + (tmpreg & 0x7U);
+  }
+  else
+  {
+    bit_cycles = tmpreg;
+  }
+  /* Start bit, data bits (parity included) and stop bits */
+  bits = 1U + ((hDMAIdleReciever->Init.WordLength == DMAIdleReciever_WORDLENGTH_9B) ? 9U : 8U)
+         + ((hDMAIdleReciever->Init.StopBits == DMAIdleReciever_STOPBITS_2) ? 2U : 1U);
+  /* Scaled in 64 bits before dividing, exact without assuming SystemCoreClock is a multiple of pclk */
+  hDMAIdleReciever->RxCharCycles = (uint32_t)(((uint64_t)bit_cycles * bits * SystemCoreClock) / pclk);
 }
 
 /**
@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file           : stm32f4xx_hal.h
+  * @brief          : Host stand-in for the STM32F4 HAL header.
+  ******************************************************************************
+  * @attention
+  *
+  * Provides the HAL types, macros and registers used by the hardware
+  * independent modules of Core/Src, so that they build unchanged for the
+  * host test programs of this directory. Interrupt masking does nothing:
+  * the programs run in a single thread, except test_ring_buffer whose ring
+  * relies on atomics only. Registers are plain structures, defined in
+  * hal_host.c; the FLASH HAL functions are provided by sim_flash_log.c.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F4xx_HAL_H
+#define __STM32F4xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+  volatile uint32_t MODER;
+} GPIO_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+  volatile uint32_t IMR;
+  volatile uint32_t EMR;
+  volatile uint32_t RTSR;
+  volatile uint32_t FTSR;
+  volatile uint32_t SWIER;
+  volatile uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t MEMRMP;
+  volatile uint32_t PMC;
+  volatile uint32_t EXTICR[4];
+} SYSCFG_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t SR;
+} FLASH_TypeDef;
+
+typedef struct
+{
+  uint32_t TypeErase;
+  uint32_t Banks;
+  uint32_t Sector;
+  uint32_t NbSectors;
+  uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define GPIO_PIN_10                   ((uint16_t)0x0400)
+
+#define FLASH_BASE                    0x08000000UL
+#define FLASH_SECTOR_12               12U
+#define FLASH_SECTOR_20               20U
+#define FLASH_SECTOR_TOTAL            24U
+#define FLASH_BANK_2                  2U
+#define FLASH_TYPEERASE_SECTORS       0x00U
+#define FLASH_TYPEPROGRAM_WORD        0x02U
+#define FLASH_VOLTAGE_RANGE_3         0x02U
+#define FLASH_FLAG_EOP                0x00000001U
+#define FLASH_FLAG_OPERR              0x00000002U
+#define FLASH_FLAG_WRPERR             0x00000010U
+#define FLASH_FLAG_PGAERR             0x00000020U
+#define FLASH_FLAG_PGPERR             0x00000040U
+#define FLASH_FLAG_PGSERR             0x00000080U
+#define FLASH_FLAG_RDERR              0x00000100U
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t       SystemCoreClock;
+extern GPIO_TypeDef   HostGpio[11];
+extern DWT_Type       HostDwt;
+extern EXTI_TypeDef   HostExti;
+extern SYSCFG_TypeDef HostSyscfg;
+extern FLASH_TypeDef  HostFlash;
+
+#define GPIOA                         (&HostGpio[0])
+#define DWT                           (&HostDwt)
+#define EXTI                          (&HostExti)
+#define SYSCFG                        (&HostSyscfg)
+#define FLASH                         (&HostFlash)
+
+/* Exported macro ------------------------------------------------------------*/
+#define __IO                          volatile
+#define __weak                        __attribute__((weak))
+#define UNUSED(X)                     (void)X
+
+#define POSITION_VAL(VAL)             ((uint32_t)__builtin_ctz(VAL))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+#define GPIO_GET_INDEX(__GPIOx__)     ((uint8_t)((__GPIOx__) - HostGpio))
+
+#define __HAL_RCC_SYSCFG_CLK_ENABLE() do { } while (0)
+#define __HAL_FLASH_CLEAR_FLAG(__FLAG__) (FLASH->SR &= ~(uint32_t)(__FLAG__))
+
+static inline uint32_t __get_PRIMASK(void)
+{
+  return 0U;
+}
+
+static inline void __set_PRIMASK(uint32_t priMask)
+{
+  (void)priMask;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Program_IT(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase_IT(FLASH_EraseInitTypeDef *pEraseInit);
+void              HAL_FLASH_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F4xx_HAL_H */
@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file           : cmsis_host.h
+  * @brief          : Host replacement for the CMSIS-Core compiler intrinsics.
+  ******************************************************************************
+  * @attention
+  *
+  * Forced ahead of every target world source (-include), it takes the place
+  * of cmsis_gcc.h, whose intrinsics are Arm assembly, so that the device
+  * header, core_cm4.h and the HAL build unchanged for the host. PRIMASK and
+  * IPSR are variables of the simulator (target_sim.c): interrupts are only
+  * dispatched by the simulator, between firmware calls, and PRIMASK holds
+  * them back. Exclusive accesses always succeed, barriers are compiler and
+  * host memory barriers.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CMSIS_HOST_H
+#define __CMSIS_HOST_H
+
+/* cmsis_compiler.h includes cmsis_gcc.h for GCC: keep it out */
+#define __CMSIS_GCC_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+#define __ASM                         __asm
+#define __INLINE                      inline
+#define __STATIC_INLINE               static inline
+#define __STATIC_FORCEINLINE          __attribute__((always_inline)) static inline
+#define __NO_RETURN                   __attribute__((__noreturn__))
+#define __USED                        __attribute__((used))
+#define __WEAK                        __attribute__((weak))
+#define __PACKED                      __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT               struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION                union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)                  __attribute__((aligned(x)))
+#define __RESTRICT                    __restrict
+#define __COMPILER_BARRIER()          __ASM volatile("" ::: "memory")
+
+/* Exported variables --------------------------------------------------------*/
+extern volatile uint32_t HostPrimask;
+extern volatile uint32_t HostIpsr;
+
+/* Exported functions --------------------------------------------------------*/
+__STATIC_FORCEINLINE void __enable_irq(void)
+{
+  __COMPILER_BARRIER();
+  HostPrimask = 0U;
+}
+
+__STATIC_FORCEINLINE void __disable_irq(void)
+{
+  HostPrimask = 1U;
+  __COMPILER_BARRIER();
+}
+
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)
+{
+  return HostPrimask;
+}
+
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)
+{
+  __COMPILER_BARRIER();
+  HostPrimask = priMask & 1U;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void)
+{
+  return HostIpsr;
+}
+
+__STATIC_FORCEINLINE void __DSB(void)
+{
+  __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE void __ISB(void)
+{
+  __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE void __DMB(void)
+{
+  __sync_synchronize();
+}
+
+#define __NOP()                       __COMPILER_BARRIER()
+#define __WFI()                       __COMPILER_BARRIER()
+#define __WFE()                       __COMPILER_BARRIER()
+#define __SEV()                       __COMPILER_BARRIER()
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+  uint32_t result = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < 32U; i++)
+  {
+    result = (result << 1) | ((value >> i) & 1U);
+  }
+  return result;
+}
+
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value)
+{
+  return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+#define __REV(value)                  __builtin_bswap32(value)
+
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr)
+{
+  return *addr;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+  *addr = value;
+  return 0U;
+}
+
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *addr)
+{
+  return *addr;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t *addr)
+{
+  *addr = value;
+  return 0U;
+}
+
+#define __CLREX()                     __COMPILER_BARRIER()
+
+#endif /* __CMSIS_HOST_H */
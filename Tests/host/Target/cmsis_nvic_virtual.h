@@ -0,0 +1,39 @@
+/**
+  ******************************************************************************
+  * @file           : cmsis_nvic_virtual.h
+  * @brief          : NVIC access of the target world, through the simulator.
+  ******************************************************************************
+  * @attention
+  *
+  * Included by core_cm4.h with CMSIS_NVIC_VIRTUAL. ISER and ICER are write
+  * one to set or clear: in plain memory a write would lose the lines enabled
+  * before it, so enabling and disabling go to target_sim.c, which keeps the
+  * enable bits. Everything else is the CMSIS implementation.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CMSIS_NVIC_VIRTUAL_H
+#define __CMSIS_NVIC_VIRTUAL_H
+
+/* Exported functions prototypes ---------------------------------------------*/
+void     TargetSim_NVIC_EnableIRQ(IRQn_Type IRQn);
+void     TargetSim_NVIC_DisableIRQ(IRQn_Type IRQn);
+uint32_t TargetSim_NVIC_GetEnableIRQ(IRQn_Type IRQn);
+
+/* Exported macro ------------------------------------------------------------*/
+#define NVIC_SetPriorityGrouping      __NVIC_SetPriorityGrouping
+#define NVIC_GetPriorityGrouping      __NVIC_GetPriorityGrouping
+#define NVIC_EnableIRQ                TargetSim_NVIC_EnableIRQ
+#define NVIC_GetEnableIRQ             TargetSim_NVIC_GetEnableIRQ
+#define NVIC_DisableIRQ               TargetSim_NVIC_DisableIRQ
+#define NVIC_GetPendingIRQ            __NVIC_GetPendingIRQ
+#define NVIC_SetPendingIRQ            __NVIC_SetPendingIRQ
+#define NVIC_ClearPendingIRQ          __NVIC_ClearPendingIRQ
+#define NVIC_GetActive                __NVIC_GetActive
+#define NVIC_SetPriority              __NVIC_SetPriority
+#define NVIC_GetPriority              __NVIC_GetPriority
+#define NVIC_SystemReset              __NVIC_SystemReset
+
+#endif /* __CMSIS_NVIC_VIRTUAL_H */
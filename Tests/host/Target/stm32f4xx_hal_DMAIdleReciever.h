@@ -0,0 +1,14 @@
+/**
+  ******************************************************************************
+  * @file           : stm32f4xx_hal_DMAIdleReciever.h
+  * @brief          : Name stm32f4xx_hal_conf.h includes the driver header by.
+  ******************************************************************************
+  * @attention
+  *
+  * The driver header is stm32f4xx_hal_uart.h in Drivers/, the HAL
+  * configuration includes it under the name of the module.
+  *
+  ******************************************************************************
+  */
+
+#include "stm32f4xx_hal_uart.h"
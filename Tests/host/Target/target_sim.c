@@ -0,0 +1,768 @@
+/**
+  ******************************************************************************
+  * @file           : target_sim.c
+  * @brief          : Register level simulation of the STM32F429 for the firmware.
+  ******************************************************************************
+  * @attention
+  *
+  * Registers live in anonymous mappings at the peripheral (0x40000000) and
+  * private peripheral bus (0xE0000000) addresses; programs are linked
+  * without PIE so that the firmware buffers, whose addresses the DMA
+  * registers hold, are below 4 GB.
+  *
+  * Register semantics plain memory lacks are restored at each step: status
+  * flags that are cleared by writing 0 (USART and TIM SR) are and-ed into a
+  * copy kept here, DMA flags written to LIFCR/HIFCR are cleared, a stream
+  * disabled by software sets TCIF, and a stream whose NDTR or M0AR changed
+  * while enabled is taken as restarted. Interrupt handlers clear the flags
+  * they were entered for, as the HAL handlers do.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "main.h"
+#include "stm32f4xx_it.h"
+#include "target_sim.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_PPB_BASE                  0xE0000000UL
+#define SIM_PERIPH_SIZE               0x00080000UL
+#define SIM_PPB_SIZE                  0x00100000UL
+
+/* Bytes queued on the line of each port */
+#define SIM_LINE_SIZE                 (1UL << 16)
+
+/* DMA1 and DMA2 streams, indexed ((DMA - 1) * 8) + Stream */
+#define SIM_NUM_STREAMS               16U
+#define SIM_NUM_IRQ                   96U
+
+/* Interrupts taken in a row before a handler is considered stuck */
+#define SIM_MAX_DISPATCH              100000U
+
+/* Stream flags, at the stream position of LISR/HISR */
+#define SIM_DMA_FE                    0x01U
+#define SIM_DMA_DME                   0x04U
+#define SIM_DMA_TE                    0x08U
+#define SIM_DMA_HT                    0x10U
+#define SIM_DMA_TC                    0x20U
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  DMA_TypeDef        *Dma;
+  DMA_Stream_TypeDef *Instance;
+  uint32_t           Index;      /* Stream number in its controller                */
+  IRQn_Type          IRQn;
+  void               (*IRQHandler)(void);
+  uint32_t           Active;     /* Enabled, as last seen                          */
+  uint32_t           Size;       /* NDTR when enabled                              */
+  uint32_t           Pos;        /* Items transferred since the start or reload    */
+  uint32_t           Ndtr;       /* NDTR and M0AR as last written here             */
+  uint32_t           M0ar;
+} SimStream;
+
+typedef struct
+{
+  USART_TypeDef      *Instance;
+  IRQn_Type          IRQn;
+  void               (*IRQHandler)(void);
+  uint32_t           Apb;
+  SimStream          *Rx;
+  SimStream          *Tx;        /* NULL for a port without Tx DMA                 */
+  uint32_t           Sr;         /* Status flags, cleared by writing 0             */
+  uint8_t            Line[SIM_LINE_SIZE];
+  uint32_t           LineHead;
+  uint32_t           LineTail;
+  uint64_t           RxAt;       /* End of the next byte on the line, 0: none      */
+  uint64_t           IdleAt;     /* IDLE detection, 0: none                        */
+  uint64_t           TxFree;     /* End of the last byte sent                      */
+  uint32_t           TcArmed;    /* TC to be set once the line is done             */
+  TargetSim_PortStatsTypeDef Stats;
+} SimPort;
+
+typedef struct
+{
+  TIM_TypeDef        *Instance;
+  IRQn_Type          IRQn;
+  void               (*IRQHandler)(void);
+  uint32_t           Running;
+  uint64_t           UpdateAt;
+  uint32_t           Sr;
+} SimTimer;
+
+/* Private macro -------------------------------------------------------------*/
+#define SIM_HANDLER_DECL(__ID__, __PERIPH__, __AF__, __APB__, __DMA__, __STREAM__, __CHANNEL__) \
+  void __PERIPH__##_IRQHandler(void);                                                         \
+  void DMA##__DMA__##_Stream##__STREAM__##_IRQHandler(void);
+
+#define SIM_TX_HANDLER_DECL(__ID__, __DMA__, __STREAM__, __CHANNEL__)                           \
+  void DMA##__DMA__##_Stream##__STREAM__##_IRQHandler(void);
+
+#define SIM_STREAM_INIT(__DMA__, __STREAM__)                                                    \
+  Streams[(((__DMA__) - 1U) * 8U) + (__STREAM__)] = (SimStream)                                  \
+  {                                                                                             \
+    .Dma        = DMA##__DMA__,                                                                 \
+    .Instance   = DMA##__DMA__##_Stream##__STREAM__,                                            \
+    .Index      = (__STREAM__),                                                                 \
+    .IRQn       = DMA##__DMA__##_Stream##__STREAM__##_IRQn,                                     \
+    .IRQHandler = DMA##__DMA__##_Stream##__STREAM__##_IRQHandler,                               \
+  }
+
+#define SIM_PORT_INIT(__ID__, __PERIPH__, __AF__, __APB__, __DMA__, __STREAM__, __CHANNEL__)    \
+  SIM_STREAM_INIT(__DMA__, __STREAM__);                                                         \
+  Ports[UARTPORT_##__ID__].Instance = __PERIPH__;                                               \
+  Ports[UARTPORT_##__ID__].IRQn = __PERIPH__##_IRQn;                                            \
+  Ports[UARTPORT_##__ID__].IRQHandler = __PERIPH__##_IRQHandler;                                \
+  Ports[UARTPORT_##__ID__].Apb = (__APB__);                                                     \
+  Ports[UARTPORT_##__ID__].Rx = &Streams[(((__DMA__) - 1U) * 8U) + (__STREAM__)];
+
+#define SIM_TX_PORT_INIT(__ID__, __DMA__, __STREAM__, __CHANNEL__)                              \
+  SIM_STREAM_INIT(__DMA__, __STREAM__);                                                         \
+  Ports[UARTPORT_##__ID__].Tx = &Streams[(((__DMA__) - 1U) * 8U) + (__STREAM__)];
+
+/* Private variables ---------------------------------------------------------*/
+volatile uint32_t HostPrimask;
+volatile uint32_t HostIpsr;
+
+UARTPORT_TABLE(SIM_HANDLER_DECL)
+UARTPORT_TX_TABLE(SIM_TX_HANDLER_DECL)
+
+static SimStream Streams[SIM_NUM_STREAMS];
+static SimPort Ports[UARTPORT_COUNT];
+static SimTimer Timer;
+static uint32_t NvicEnabled[SIM_NUM_IRQ / 32U];
+static uint64_t Now;
+static uint64_t TickAt;
+static uint32_t TickPending;
+static uint64_t PendSVHeldUntil;
+static uint64_t WakeAt = UINT64_MAX;
+
+/* Private functions ---------------------------------------------------------*/
+static void Map(uintptr_t Base, size_t Size)
+{
+  if (mmap((void *)Base, Size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void *)Base)
+  {
+    perror("mmap");
+    exit(1);
+  }
+}
+
+static volatile uint32_t *StreamIsr(const SimStream *s)
+{
+  return (s->Index < 4U) ? &s->Dma->LISR : &s->Dma->HISR;
+}
+
+static uint32_t StreamShift(const SimStream *s)
+{
+  static const uint8_t Shift[4] = { 0U, 6U, 16U, 22U };
+
+  return Shift[s->Index & 3U];
+}
+
+static void StreamFlag(SimStream *s, uint32_t Flag)
+{
+  *StreamIsr(s) |= Flag << StreamShift(s);
+}
+
+/* Flags of the stream whose interrupt is enabled */
+static uint32_t StreamPending(const SimStream *s)
+{
+  uint32_t cr = s->Instance->CR;
+  uint32_t enabled = (((cr & DMA_SxCR_TCIE) != 0U) ? SIM_DMA_TC : 0U)
+                     | (((cr & DMA_SxCR_HTIE) != 0U) ? SIM_DMA_HT : 0U)
+                     | (((cr & DMA_SxCR_TEIE) != 0U) ? SIM_DMA_TE : 0U)
+                     | (((cr & DMA_SxCR_DMEIE) != 0U) ? SIM_DMA_DME : 0U)
+                     | (((s->Instance->FCR & DMA_SxFCR_FEIE) != 0U) ? SIM_DMA_FE : 0U);
+
+  return (*StreamIsr(s) >> StreamShift(s)) & enabled;
+}
+
+static void StreamStart(SimStream *s)
+{
+  s->Size = s->Instance->NDTR;
+  s->Pos = 0U;
+  s->Ndtr = s->Size;
+  s->M0ar = s->Instance->M0AR;
+  s->Active = (s->Size != 0U);
+}
+
+/* One item transferred: count down, flag and reload or stop */
+static void StreamAdvance(SimStream *s)
+{
+  s->Pos++;
+  s->Ndtr--;
+  s->Instance->NDTR = s->Ndtr;
+  if ((s->Size >= 2U) && (s->Ndtr == (s->Size / 2U)))
+  {
+    StreamFlag(s, SIM_DMA_HT);
+  }
+  if (s->Ndtr != 0U)
+  {
+    return;
+  }
+
+  StreamFlag(s, SIM_DMA_TC);
+  if ((s->Instance->CR & DMA_SxCR_CIRC) != 0U)
+  {
+    s->Pos = 0U;
+    s->Ndtr = s->Size;
+    s->Instance->NDTR = s->Size;
+    if ((s->Instance->CR & DMA_SxCR_DBM) != 0U)
+    {
+      s->Instance->CR ^= DMA_SxCR_CT;
+    }
+  }
+  else
+  {
+    s->Instance->CR &= ~DMA_SxCR_EN;
+    s->Active = 0U;
+  }
+}
+
+static uint8_t *StreamMemory(const SimStream *s)
+{
+  uint32_t cr = s->Instance->CR;
+  uint32_t m = (((cr & DMA_SxCR_DBM) != 0U) && ((cr & DMA_SxCR_CT) != 0U)) ? s->Instance->M1AR
+                                                                             : s->Instance->M0AR;
+
+  return (uint8_t *)(uintptr_t)m + (((cr & DMA_SxCR_MINC) != 0U) ? s->Pos : 0U);
+}
+
+/* Transferring between the USART data register and memory, in the direction given */
+static uint32_t StreamServes(const SimPort *p, const SimStream *s, uint32_t Dir, uint32_t Request)
+{
+  return (s != NULL) && (s->Active != 0U) && ((s->Instance->CR & DMA_SxCR_DIR) == Dir)
+         && (s->Instance->PAR == (uint32_t)(uintptr_t)&p->Instance->DR)
+         && ((p->Instance->CR3 & Request) != 0U) && ((p->Instance->CR1 & USART_CR1_UE) != 0U);
+}
+
+/* Core cycles of one character at the rate and frame format programmed */
+static uint64_t CharCycles(const SimPort *p)
+{
+  USART_TypeDef *usart = p->Instance;
+  uint32_t pclk = (p->Apb == 2U) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+  uint32_t brr = usart->BRR;
+  uint32_t div = ((usart->CR1 & USART_CR1_OVER8) != 0U) ? (((brr >> 4) << 3) | (brr & 7U)) : brr;
+  uint32_t bits = 1U + (((usart->CR1 & USART_CR1_M) != 0U) ? 9U : 8U)
+                  + (((usart->CR2 & USART_CR2_STOP_1) != 0U) ? 2U : 1U);
+  uint64_t cycles = ((uint64_t)bits * div * SystemCoreClock) / pclk;
+
+  return (cycles != 0U) ? cycles : 1U;
+}
+
+/* Time the Tx DMA stream hands the USART its next byte, UINT64_MAX if none */
+static uint64_t TxTakeAt(const SimPort *p)
+{
+  uint64_t c;
+
+  if (!StreamServes(p, p->Tx, DMA_MEMORY_TO_PERIPH, USART_CR3_DMAT)
+      || ((p->Instance->CR1 & USART_CR1_TE) == 0U))
+  {
+    return UINT64_MAX;
+  }
+  /* The data register empties as the previous byte starts shifting out */
+  c = CharCycles(p);
+  return ((p->TxFree > (Now + c)) ? (p->TxFree - c) : Now);
+}
+
+static void RxByte(SimPort *p)
+{
+  uint8_t byte = p->Line[p->LineTail++ & (SIM_LINE_SIZE - 1U)];
+
+  p->Stats.RxBytes++;
+  if (StreamServes(p, p->Rx, DMA_PERIPH_TO_MEMORY, USART_CR3_DMAR) && ((p->Instance->CR1 & USART_CR1_RE) != 0U))
+  {
+    *StreamMemory(p->Rx) = byte;
+    StreamAdvance(p->Rx);
+  }
+  else
+  {
+    p->Stats.RxMissed++;
+  }
+
+  if (p->LineTail != p->LineHead)
+  {
+    p->RxAt += CharCycles(p);
+  }
+  else
+  {
+    /* IDLE is detected one character after the end of the burst */
+    p->RxAt = 0U;
+    p->IdleAt = Now + CharCycles(p);
+  }
+}
+
+static void TxByte(SimPort *p)
+{
+  uint8_t byte = *StreamMemory(p->Tx);
+
+  StreamAdvance(p->Tx);
+  p->Sr &= ~USART_SR_TC;
+  p->TxFree = ((p->TxFree > Now) ? p->TxFree : Now) + CharCycles(p);
+  p->TcArmed = 1U;
+  p->Stats.TxBytes++;
+  TargetSim_TxCallback((UartPort_IdTypeDef)(p - Ports), byte);
+}
+
+static uint64_t TimerPeriod(const SimTimer *t)
+{
+  uint32_t timclk = HAL_RCC_GetPCLK1Freq();
+
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+  {
+    timclk *= 2U;
+  }
+  return ((((uint64_t)t->Instance->ARR + 1U) * (t->Instance->PSC + 1U) * SystemCoreClock) + timclk - 1U) / timclk;
+}
+
+/* Bring the state kept here and the registers the firmware wrote together */
+static void Sync(void)
+{
+  SimStream *s;
+  SimPort *p;
+  uint32_t en;
+  uint32_t i;
+
+  for (i = 0U; i < SIM_NUM_STREAMS; i++)
+  {
+    s = &Streams[i];
+    if (s->Instance == NULL)
+    {
+      continue;
+    }
+    en = s->Instance->CR & DMA_SxCR_EN;
+    if ((s->Active != 0U) && (en == 0U))
+    {
+      /* Disabled by software: TCIF is set once the stream has stopped */
+      s->Active = 0U;
+      StreamFlag(s, SIM_DMA_TC);
+    }
+    else if ((en != 0U) && ((s->Active == 0U) || (s->Instance->NDTR != s->Ndtr) || (s->Instance->M0AR != s->M0ar)))
+    {
+      StreamStart(s);
+    }
+  }
+  DMA1->LISR &= ~DMA1->LIFCR;
+  DMA1->HISR &= ~DMA1->HIFCR;
+  DMA2->LISR &= ~DMA2->LIFCR;
+  DMA2->HISR &= ~DMA2->HIFCR;
+  DMA1->LIFCR = 0U;
+  DMA1->HIFCR = 0U;
+  DMA2->LIFCR = 0U;
+  DMA2->HIFCR = 0U;
+
+  for (i = 0U; i < UARTPORT_COUNT; i++)
+  {
+    p = &Ports[i];
+    p->Sr &= p->Instance->SR;
+    p->Instance->SR = p->Sr;
+  }
+
+  Timer.Sr &= Timer.Instance->SR;
+  Timer.Instance->SR = Timer.Sr;
+  Timer.Instance->EGR = 0U;
+  en = Timer.Instance->CR1 & TIM_CR1_CEN;
+  if ((en != 0U) && ((Timer.Running == 0U) || (Timer.Instance->CNT == 0U)))
+  {
+    /* Started, or restarted from 0: CNT reads non-zero while it runs */
+    Timer.Running = 1U;
+    Timer.Instance->CNT = 1U;
+    Timer.UpdateAt = Now + TimerPeriod(&Timer);
+  }
+  else if (en == 0U)
+  {
+    Timer.Running = 0U;
+  }
+
+  if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0U)
+  {
+    TickAt = 0U;
+  }
+  else if (TickAt == 0U)
+  {
+    TickAt = Now + SysTick->LOAD + 1U;
+  }
+}
+
+static void Call(uint32_t Exception, void (*Handler)(void))
+{
+  DWT->CYCCNT = (uint32_t)Now;
+  HostIpsr = Exception;
+  Handler();
+  HostIpsr = 0U;
+}
+
+/* Take the pending interrupts, PendSV last */
+static void Dispatch(void)
+{
+  uint32_t n;
+  uint32_t i;
+  uint32_t flags;
+  SimPort *p;
+  SimStream *s;
+
+  for (n = 0U; n < SIM_MAX_DISPATCH; n++)
+  {
+    Sync();
+    if ((HostPrimask != 0U) || (HostIpsr != 0U))
+    {
+      return;
+    }
+
+    for (i = 0U; i < UARTPORT_COUNT; i++)
+    {
+      p = &Ports[i];
+      flags = p->Sr & ((((p->Instance->CR1 & USART_CR1_IDLEIE) != 0U) ? USART_SR_IDLE : 0U)
+                       | (((p->Instance->CR1 & USART_CR1_TCIE) != 0U) ? USART_SR_TC : 0U)
+                       | (((p->Instance->CR1 & USART_CR1_TXEIE) != 0U) ? USART_SR_TXE : 0U));
+      if ((flags != 0U) && (TargetSim_NVIC_GetEnableIRQ(p->IRQn) != 0U))
+      {
+        Call((uint32_t)p->IRQn + 16U, p->IRQHandler);
+        /* Cleared by the SR then DR read of the handler */
+        p->Sr &= ~USART_SR_IDLE;
+        p->Instance->SR = p->Sr;
+        break;
+      }
+    }
+    if (i < UARTPORT_COUNT)
+    {
+      continue;
+    }
+
+    for (i = 0U; i < SIM_NUM_STREAMS; i++)
+    {
+      s = &Streams[i];
+      if ((s->Instance != NULL) && ((flags = StreamPending(s)) != 0U) && (TargetSim_NVIC_GetEnableIRQ(s->IRQn) != 0U))
+      {
+        Call((uint32_t)s->IRQn + 16U, s->IRQHandler);
+        *StreamIsr(s) &= ~(flags << StreamShift(s));
+        break;
+      }
+    }
+    if (i < SIM_NUM_STREAMS)
+    {
+      continue;
+    }
+
+    if (((Timer.Sr & TIM_SR_UIF) != 0U) && ((Timer.Instance->DIER & TIM_DIER_UIE) != 0U)
+        && (TargetSim_NVIC_GetEnableIRQ(Timer.IRQn) != 0U))
+    {
+      Call((uint32_t)Timer.IRQn + 16U, Timer.IRQHandler);
+      continue;
+    }
+
+    if ((TickPending != 0U) && ((SysTick->CTRL & SysTick_CTRL_TICKINT_Msk) != 0U))
+    {
+      TickPending = 0U;
+      Call(15U, SysTick_Handler);
+      continue;
+    }
+
+    if (((SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) != 0U) && (Now >= PendSVHeldUntil))
+    {
+      SCB->ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+      Call(14U, PendSV_Handler);
+      continue;
+    }
+    return;
+  }
+
+  fprintf(stderr, "target_sim: interrupt storm at cycle %llu\n", (unsigned long long)Now);
+  exit(1);
+}
+
+static uint64_t NextEvent(void)
+{
+  uint64_t next = UINT64_MAX;
+  uint64_t t;
+  uint32_t i;
+  SimPort *p;
+
+#define SIM_EARLIEST(__T__) do { t = (__T__); next = (t < next) ? t : next; } while (0)
+  for (i = 0U; i < UARTPORT_COUNT; i++)
+  {
+    p = &Ports[i];
+    if (p->RxAt != 0U)
+    {
+      SIM_EARLIEST(p->RxAt);
+    }
+    if (p->IdleAt != 0U)
+    {
+      SIM_EARLIEST(p->IdleAt);
+    }
+    SIM_EARLIEST(TxTakeAt(p));
+    if (p->TcArmed != 0U)
+    {
+      SIM_EARLIEST(p->TxFree);
+    }
+  }
+  if (Timer.Running != 0U)
+  {
+    SIM_EARLIEST(Timer.UpdateAt);
+  }
+  if (TickAt != 0U)
+  {
+    SIM_EARLIEST(TickAt);
+  }
+  if (((SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) != 0U) && (PendSVHeldUntil > Now))
+  {
+    SIM_EARLIEST(PendSVHeldUntil);
+  }
+  SIM_EARLIEST(WakeAt);
+#undef SIM_EARLIEST
+
+  return next;
+}
+
+/* Everything due at Now */
+static void Step(void)
+{
+  uint32_t i;
+  SimPort *p;
+
+  for (i = 0U; i < UARTPORT_COUNT; i++)
+  {
+    p = &Ports[i];
+    if ((p->RxAt != 0U) && (p->RxAt <= Now))
+    {
+      RxByte(p);
+    }
+    if ((p->IdleAt != 0U) && (p->IdleAt <= Now))
+    {
+      p->IdleAt = 0U;
+      if ((p->Instance->CR1 & USART_CR1_IDLEIE) != 0U)
+      {
+        p->Sr |= USART_SR_IDLE;
+      }
+    }
+    if (TxTakeAt(p) <= Now)
+    {
+      TxByte(p);
+    }
+    if ((p->TcArmed != 0U) && (p->TxFree <= Now) && (TxTakeAt(p) == UINT64_MAX))
+    {
+      p->TcArmed = 0U;
+      p->Sr |= USART_SR_TC;
+    }
+    p->Instance->SR = p->Sr;
+  }
+
+  if ((Timer.Running != 0U) && (Timer.UpdateAt <= Now))
+  {
+    Timer.Sr |= TIM_SR_UIF;
+    Timer.Instance->SR = Timer.Sr;
+    if ((Timer.Instance->CR1 & TIM_CR1_OPM) != 0U)
+    {
+      Timer.Instance->CR1 &= ~TIM_CR1_CEN;
+      Timer.Running = 0U;
+    }
+    else
+    {
+      Timer.UpdateAt += TimerPeriod(&Timer);
+    }
+  }
+
+  if ((TickAt != 0U) && (TickAt <= Now))
+  {
+    TickAt += SysTick->LOAD + 1U;
+    TickPending = 1U;
+  }
+
+  if (WakeAt <= Now)
+  {
+    WakeAt = UINT64_MAX;
+    TargetSim_WakeCallback();
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Map the registers and set the reset state, with the clock tree the
+  *         SYSCLK_PROFILE of main.h runs on. HAL_Init() is left to the program.
+  * @retval None
+  */
+void TargetSim_Init(void)
+{
+  uint32_t i;
+
+  Map(PERIPH_BASE, SIM_PERIPH_SIZE);
+  Map(SIM_PPB_BASE, SIM_PPB_SIZE);
+
+  UARTPORT_TABLE(SIM_PORT_INIT)
+  UARTPORT_TX_TABLE(SIM_TX_PORT_INIT)
+  for (i = 0U; i < UARTPORT_COUNT; i++)
+  {
+    Ports[i].Sr = USART_SR_TXE | USART_SR_TC;
+    Ports[i].Instance->SR = Ports[i].Sr;
+  }
+  Timer.Instance = TIM2;
+  Timer.IRQn = TIM2_IRQn;
+  Timer.IRQHandler = TIM2_IRQHandler;
+
+  /* HSE 8 MHz / 4 * N / 2, as SystemClock_Config() leaves it */
+  RCC->CR = RCC_CR_HSION | RCC_CR_HSIRDY | RCC_CR_HSEON | RCC_CR_HSERDY | RCC_CR_PLLON | RCC_CR_PLLRDY;
+#if (SYSCLK_PROFILE == SYSCLK_PROFILE_180MHZ)
+  RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSE | 4U | (180U << RCC_PLLCFGR_PLLN_Pos) | (8U << RCC_PLLCFGR_PLLQ_Pos);
+  RCC->CFGR = RCC_CFGR_SW_PLL | RCC_CFGR_SWS_PLL | RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2;
+#else
+  RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSE | 4U | (72U << RCC_PLLCFGR_PLLN_Pos) | (3U << RCC_PLLCFGR_PLLQ_Pos);
+  RCC->CFGR = RCC_CFGR_SW_PLL | RCC_CFGR_SWS_PLL | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1;
+#endif
+  SystemCoreClock = HAL_RCC_GetSysClockFreq();
+}
+
+/**
+  * @brief  Advance the simulated time, taking the interrupts on the way.
+  * @param  Cycles Core clock cycles.
+  * @retval None
+  */
+void TargetSim_Run(uint64_t Cycles)
+{
+  uint64_t end = Now + Cycles;
+  uint64_t t;
+
+  Dispatch();
+  while ((t = NextEvent()) <= end)
+  {
+    Now = (t > Now) ? t : Now;
+    Step();
+    Dispatch();
+  }
+  Now = end;
+  DWT->CYCCNT = (uint32_t)Now;
+  Dispatch();
+}
+
+/**
+  * @brief  Simulated time.
+  * @retval Core clock cycles since TargetSim_Init()
+  */
+uint64_t TargetSim_GetTime(void)
+{
+  return Now;
+}
+
+/**
+  * @brief  Queue bytes on the RX line of a port, sent back to back after the
+  *         bytes already queued, or from now if the line is idle.
+  * @param  Id Port.
+  * @param  pData Bytes.
+  * @param  Len Number of bytes.
+  * @retval Number of bytes queued, less than Len if the queue is full
+  */
+uint32_t TargetSim_Receive(UartPort_IdTypeDef Id, const uint8_t *pData, uint32_t Len)
+{
+  SimPort *p = &Ports[Id];
+  uint32_t i;
+
+  for (i = 0U; (i < Len) && ((p->LineHead - p->LineTail) < SIM_LINE_SIZE); i++)
+  {
+    p->Line[p->LineHead++ & (SIM_LINE_SIZE - 1U)] = pData[i];
+  }
+  if ((i != 0U) && (p->RxAt == 0U))
+  {
+    p->RxAt = Now + CharCycles(p);
+    p->IdleAt = 0U;
+  }
+  return i;
+}
+
+/**
+  * @brief  Bytes still queued on the RX line of a port.
+  * @param  Id Port.
+  * @retval Number of bytes
+  */
+uint32_t TargetSim_GetRxQueued(UartPort_IdTypeDef Id)
+{
+  return Ports[Id].LineHead - Ports[Id].LineTail;
+}
+
+/**
+  * @brief  Line counters of a port.
+  * @param  Id Port.
+  * @retval Counters
+  */
+const TargetSim_PortStatsTypeDef *TargetSim_GetPortStats(UartPort_IdTypeDef Id)
+{
+  return &Ports[Id].Stats;
+}
+
+/**
+  * @brief  Keep PendSV from running for a while, as higher priority work would.
+  * @param  Cycles Core clock cycles from now.
+  * @retval None
+  */
+void TargetSim_HoldPendSV(uint64_t Cycles)
+{
+  PendSVHeldUntil = Now + Cycles;
+}
+
+/**
+  * @brief  Call TargetSim_WakeCallback() at a point in simulated time, e.g. to
+  *         queue line traffic on a schedule that does not depend on the main
+  *         loop. Replaces the wake-up set before; a time already past is
+  *         due at once.
+  * @param  Time Core clock cycles since TargetSim_Init().
+  * @retval None
+  */
+void TargetSim_WakeAt(uint64_t Time)
+{
+  WakeAt = (Time > Now) ? Time : Now;
+}
+
+/**
+  * @brief  Wake-up set with TargetSim_WakeAt(). Runs outside of any interrupt,
+  *         before the interrupts due at the same time.
+  * @retval None
+  */
+__weak void TargetSim_WakeCallback(void)
+{
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the TargetSim_WakeCallback can be implemented in the test program.
+   */
+}
+
+/**
+  * @brief  Byte sent on the TX line of a port.
+  * @param  Id Port.
+  * @param  Byte Byte.
+  * @retval None
+  */
+__weak void TargetSim_TxCallback(UartPort_IdTypeDef Id, uint8_t Byte)
+{
+  /* Prevent unused argument(s) compilation warning */
+  UNUSED(Id);
+  UNUSED(Byte);
+
+  /* NOTE : This function should not be modified, when the callback is needed,
+            the TargetSim_TxCallback can be implemented in the test program.
+   */
+}
+
+void TargetSim_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+  if ((int32_t)IRQn >= 0)
+  {
+    NvicEnabled[(uint32_t)IRQn >> 5] |= 1UL << ((uint32_t)IRQn & 0x1FU);
+    NVIC->ISER[(uint32_t)IRQn >> 5] = NvicEnabled[(uint32_t)IRQn >> 5];
+  }
+}
+
+void TargetSim_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+  if ((int32_t)IRQn >= 0)
+  {
+    NvicEnabled[(uint32_t)IRQn >> 5] &= ~(1UL << ((uint32_t)IRQn & 0x1FU));
+    NVIC->ISER[(uint32_t)IRQn >> 5] = NvicEnabled[(uint32_t)IRQn >> 5];
+  }
+}
+
+uint32_t TargetSim_NVIC_GetEnableIRQ(IRQn_Type IRQn)
+{
+  return ((int32_t)IRQn >= 0) ? ((NvicEnabled[(uint32_t)IRQn >> 5] >> ((uint32_t)IRQn & 0x1FU)) & 1UL) : 0U;
+}
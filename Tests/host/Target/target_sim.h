@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file           : target_sim.h
+  * @brief          : Register level simulation of the STM32F429 for the firmware.
+  ******************************************************************************
+  * @attention
+  *
+  * The target world programs build Core/Src, the startup-free part of the
+  * HAL and the DMAIdleReciever driver unchanged for the host. Peripheral and
+  * core registers are mapped at their addresses, and this simulator moves
+  * them in simulated time, counted in core clock cycles:
+  *
+  *  - the line of each port delivers queued bytes at the rate programmed in
+  *    BRR, written by its Rx DMA stream at M0AR/M1AR with NDTR counting down,
+  *    HT/TC flags, circular reload, and IDLE one character after a burst
+  *  - Tx DMA streams feed their USART at the line rate, TC follows the last
+  *    character
+  *  - TIM2 counts to its update event, SysTick ticks every LOAD + 1 cycles,
+  *    DWT->CYCCNT is the simulated time
+  *  - a wake-up set with TargetSim_WakeAt() calls the program back, for
+  *    stimuli on their own schedule
+  *  - interrupts whose enable bits and NVIC line are set are dispatched to
+  *    the handlers of stm32f4xx_it.c, then PendSV, the lowest priority, if
+  *    SCB->ICSR pends it and it is not held back
+  *
+  * Interrupts are taken between firmware calls, i.e. whenever the program
+  * calls TargetSim_Run(), from its main loop or from a wrapped function the
+  * main loop calls, unless PRIMASK is set. Handlers run in no simulated time.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TARGET_SIM_H
+#define __TARGET_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "uart_port.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint64_t RxBytes;     /*!< Bytes the line delivered                                  */
+
+  uint64_t RxMissed;    /*!< Of which neither the Rx DMA nor the USART took: disabled  */
+
+  uint64_t TxBytes;     /*!< Bytes the Tx DMA stream sent on the line                  */
+} TargetSim_PortStatsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void     TargetSim_Init(void);
+void     TargetSim_Run(uint64_t Cycles);
+uint64_t TargetSim_GetTime(void);
+
+uint32_t TargetSim_Receive(UartPort_IdTypeDef Id, const uint8_t *pData, uint32_t Len);
+uint32_t TargetSim_GetRxQueued(UartPort_IdTypeDef Id);
+const TargetSim_PortStatsTypeDef *TargetSim_GetPortStats(UartPort_IdTypeDef Id);
+
+void     TargetSim_HoldPendSV(uint64_t Cycles);
+void     TargetSim_WakeAt(uint64_t Time);
+
+void     TargetSim_WakeCallback(void);
+
+void     TargetSim_TxCallback(UartPort_IdTypeDef Id, uint8_t Byte);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TARGET_SIM_H */
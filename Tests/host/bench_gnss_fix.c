@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file           : bench_gnss_fix.c
+  * @brief          : Fix conversions: fixed point against atof and double.
+  ******************************************************************************
+  * @attention
+  *
+  * Times the conversions of one sentence (latitude, longitude, time of day
+  * and speed) with gnss_fix.c, from the decimal fields of the parser, and
+  * with atof() and double arithmetic from the field text.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "gnss_fix.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_ROUNDS                  5000000U
+
+/* Private functions ---------------------------------------------------------*/
+static double FixedPoint(int32_t *pSum)
+{
+  Nmea_DecimalTypeDef lat = { 48070382, 4 };
+  Nmea_DecimalTypeDef lon = { 113100012, 5 };
+  Nmea_DecimalTypeDef time = { 12351900, 2 };
+  Nmea_DecimalTypeDef speed = { 224, 1 };
+  uint64_t ns = HostTest_Ns();
+  int32_t sum = 0;
+  int32_t a;
+  int32_t b;
+  int32_t v;
+  uint32_t t;
+  uint32_t r;
+
+  for (r = 0U; r < BENCH_ROUNDS; r++)
+  {
+    lat.Value += (int32_t)(r & 1U);
+    (void)GnssFix_ToDeg7(&lat, 'N', &a);
+    (void)GnssFix_ToDeg7(&lon, 'E', &b);
+    (void)GnssFix_ToTimeOfDay(&time, &t);
+    (void)GnssFix_KnotsToMms(&speed, &v);
+    sum += a + b + v + (int32_t)t;
+  }
+  *pSum = sum;
+  return (double)(HostTest_Ns() - ns) / BENCH_ROUNDS;
+}
+
+static double Double(int32_t *pSum)
+{
+  const char *volatile lat_text = "4807.038247";
+  const char *volatile lon_text = "01131.000123";
+  const char *volatile time_text = "123519.00";
+  const char *volatile speed_text = "22.4";
+  uint64_t ns = HostTest_Ns();
+  int32_t sum = 0;
+  double lat;
+  double lon;
+  double time;
+  double speed;
+  int lat_deg;
+  int lon_deg;
+  uint32_t r;
+
+  for (r = 0U; r < BENCH_ROUNDS; r++)
+  {
+    lat = atof(lat_text);
+    lon = atof(lon_text);
+    time = atof(time_text);
+    speed = atof(speed_text);
+    lat_deg = (int)(lat / 100.0);
+    lon_deg = (int)(lon / 100.0);
+    sum += (int32_t)((lat_deg + ((lat - (lat_deg * 100.0)) / 60.0)) * 1e7);
+    sum += (int32_t)((lon_deg + ((lon - (lon_deg * 100.0)) / 60.0)) * 1e7);
+    sum += (int32_t)(speed * 514.444) + (int32_t)time;
+  }
+  *pSum = sum;
+  return (double)(HostTest_Ns() - ns) / BENCH_ROUNDS;
+}
+
+int main(void)
+{
+  int32_t sum_fixed;
+  int32_t sum_double;
+  double fixed = FixedPoint(&sum_fixed);
+  double dbl = Double(&sum_double);
+
+  printf("lat, lon, time, speed: fixed point %.1f ns, atof and double %.1f ns (%d %d)\n",
+         fixed, dbl, (int)sum_fixed, (int)sum_double);
+
+  return HostTest_Result("bench_gnss_fix");
+}
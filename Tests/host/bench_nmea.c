@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file           : bench_nmea.c
+  * @brief          : NMEA parser cost per byte.
+  ******************************************************************************
+  * @attention
+  *
+  * Parses 1 MB of a mix of GGA, RMC, VTG, GSA, GSV and unsupported
+  * sentences in one call and reports the time and time stamp counter
+  * cycles per byte. Host figures only compare builds; the Cortex-M4 cost
+  * is measured with the DWT cycle counter. The checks are in test_nmea.c.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "nmea.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_SIZE                    (1U << 20)
+#define BENCH_RUNS                    20U
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const Bodies[] =
+{
+  "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+  "GNRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A",
+  "GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A",
+  "GNGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1,1",
+  "GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00,1",
+  "GPZDA,201530.00,04,07,2002,00,00",
+};
+
+static char Mix[512];
+static uint32_t MixLength;
+static uint8_t Bench[BENCH_SIZE];
+
+/* Private functions ---------------------------------------------------------*/
+/* Append "$body*hh\r\n" */
+static uint32_t Frame(char *pDst, const char *pBody, uint8_t Corrupt)
+{
+  uint8_t cs = 0U;
+  const char *p;
+
+  for (p = pBody; *p != '\0'; p++)
+  {
+    cs ^= (uint8_t)*p;
+  }
+  return (uint32_t)sprintf(pDst, "$%s*%02X\r\n", pBody, (unsigned)(cs ^ Corrupt));
+}
+
+static void Benchmark(void)
+{
+  Nmea_HandleTypeDef h;
+  uint64_t ns;
+  uint64_t cycles;
+  uint32_t len = 0U;
+  uint32_t run;
+
+  while ((len + MixLength) <= BENCH_SIZE)
+  {
+    memcpy(&Bench[len], Mix, MixLength);
+    len += MixLength;
+  }
+
+  Nmea_Init(&h);
+  ns = HostTest_Ns();
+  cycles = HostTest_Cycles();
+  for (run = 0U; run < BENCH_RUNS; run++)
+  {
+    Nmea_Parse(&h, Bench, len);
+  }
+  cycles = HostTest_Cycles() - cycles;
+  ns = HostTest_Ns() - ns;
+
+  printf("Nmea_Parse: %.2f ns/byte, %.1f TSC cycles/byte, %u bytes x %u\n",
+         (double)ns / ((double)len * BENCH_RUNS), (double)cycles / ((double)len * BENCH_RUNS),
+         (unsigned)len, (unsigned)BENCH_RUNS);
+}
+
+int main(void)
+{
+  uint32_t i;
+
+  for (i = 0U; i < (sizeof(Bodies) / sizeof(Bodies[0])); i++)
+  {
+    MixLength += Frame(&Mix[MixLength], Bodies[i], 0U);
+  }
+
+  Benchmark();
+
+  return HostTest_Result("bench_nmea");
+}
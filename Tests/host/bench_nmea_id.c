@@ -0,0 +1,99 @@
+/**
+  ******************************************************************************
+  * @file           : bench_nmea_id.c
+  * @brief          : Sentence type lookup: perfect hash against strcmp.
+  ******************************************************************************
+  * @attention
+  *
+  * nmea.c is included, so that its static Nmea_Identify() can be called.
+  * Times Nmea_Identify() against a linear strcmp() over a table of 12 full
+  * addresses, on a mix of supported and unsupported addresses a
+  * multi-constellation receiver sends. The checks are in test_nmea.c.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../../Core/Src/nmea.c"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_ROUNDS                  5000000U
+
+/* Private variables ---------------------------------------------------------*/
+static const struct
+{
+  const char             *pAddress;
+  Nmea_SentenceIdTypeDef Id;
+} LinearTable[] =
+{
+  { "GPGGA", NMEA_SENTENCE_GGA }, { "GNGGA", NMEA_SENTENCE_GGA },
+  { "GPRMC", NMEA_SENTENCE_RMC }, { "GNRMC", NMEA_SENTENCE_RMC },
+  { "GPVTG", NMEA_SENTENCE_VTG }, { "GNVTG", NMEA_SENTENCE_VTG },
+  { "GPGSA", NMEA_SENTENCE_GSA }, { "GNGSA", NMEA_SENTENCE_GSA },
+  { "GPGSV", NMEA_SENTENCE_GSV }, { "GLGSV", NMEA_SENTENCE_GSV },
+  { "GAGSV", NMEA_SENTENCE_GSV }, { "GBGSV", NMEA_SENTENCE_GSV },
+};
+
+static const char *const Inputs[] =
+{
+  "GNGGA", "GNRMC", "GNVTG", "GNGSA", "GPGSV", "GLGSV",
+  "GAGSV", "GBGSV", "GNGLL", "GNZDA", "GNTXT", "GPGST",
+};
+
+#define NUM_INPUTS                    (sizeof(Inputs) / sizeof(Inputs[0]))
+
+/* Private functions ---------------------------------------------------------*/
+static __attribute__((noinline)) Nmea_SentenceIdTypeDef LinearIdentify(const char *pAddress)
+{
+  uint32_t i;
+
+  for (i = 0U; i < (sizeof(LinearTable) / sizeof(LinearTable[0])); i++)
+  {
+    if (strcmp(pAddress, LinearTable[i].pAddress) == 0)
+    {
+      return LinearTable[i].Id;
+    }
+  }
+  return NMEA_SENTENCE_UNKNOWN;
+}
+
+static __attribute__((noinline)) Nmea_SentenceIdTypeDef HashIdentify(const char *pAddress)
+{
+  return Nmea_Identify(pAddress);
+}
+
+static double Time(Nmea_SentenceIdTypeDef (*pIdentify)(const char *), uint32_t *pSum)
+{
+  const char *volatile *inputs = (const char *volatile *)Inputs;
+  uint64_t ns = HostTest_Ns();
+  uint32_t sum = 0U;
+  uint32_t r;
+  uint32_t i;
+
+  for (r = 0U; r < BENCH_ROUNDS; r++)
+  {
+    for (i = 0U; i < NUM_INPUTS; i++)
+    {
+      sum += (uint32_t)pIdentify(inputs[i]);
+    }
+  }
+  *pSum = sum;
+  return (double)(HostTest_Ns() - ns) / ((double)BENCH_ROUNDS * NUM_INPUTS);
+}
+
+int main(void)
+{
+  uint32_t sum_hash;
+  uint32_t sum_linear;
+  double hash;
+  double linear;
+
+  hash = Time(HashIdentify, &sum_hash);
+  linear = Time(LinearIdentify, &sum_linear);
+  HOST_CHECK(sum_hash == sum_linear);
+  printf("perfect hash %.2f ns/lookup, strcmp over %u addresses %.2f ns/lookup\n", hash,
+         (unsigned)(sizeof(LinearTable) / sizeof(LinearTable[0])), linear);
+
+  return HostTest_Result("bench_nmea_id");
+}
@@ -0,0 +1,17 @@
+/**
+  ******************************************************************************
+  * @file           : hal_host.c
+  * @brief          : Registers and globals of the host HAL stand-in.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported variables --------------------------------------------------------*/
+uint32_t       SystemCoreClock = 16000000U;
+GPIO_TypeDef   HostGpio[11];
+DWT_Type       HostDwt;
+EXTI_TypeDef   HostExti;
+SYSCFG_TypeDef HostSyscfg;
+FLASH_TypeDef  HostFlash;
@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file           : host_test.h
+  * @brief          : Checks and timing shared by the host test programs.
+  ******************************************************************************
+  * @attention
+  *
+  * HOST_CHECK() reports a failed condition and counts it; a program returns
+  * HostTest_Result(), non-zero after a failure, so that make stops. Timings
+  * are taken with the monotonic clock and, on x86, with the time stamp
+  * counter, which runs at a fixed reference frequency.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HOST_TEST_H
+#define __HOST_TEST_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+#define HOST_CHECK(__COND__)                                                       \
+  do                                                                               \
+  {                                                                                \
+    if (!(__COND__))                                                               \
+    {                                                                              \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #__COND__);          \
+      HostTest_Failures++;                                                         \
+    }                                                                              \
+  } while (0)
+
+/* Exported variables --------------------------------------------------------*/
+static uint32_t HostTest_Failures;
+
+/* Exported functions --------------------------------------------------------*/
+/* Monotonic time in nanoseconds */
+static inline uint64_t HostTest_Ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/* Time stamp counter, 0 where there is none */
+static inline uint64_t HostTest_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0U;
+#endif
+}
+
+/* Deterministic xorshift generator, so that runs are reproducible */
+static inline uint32_t HostTest_Rand(void)
+{
+  static uint64_t state = 88172645463325252ULL;
+
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return (uint32_t)(state >> 16);
+}
+
+static inline int HostTest_Result(const char *pName)
+{
+  printf("%s: %s\n", pName, (HostTest_Failures == 0U) ? "OK" : "FAILED");
+  return (HostTest_Failures == 0U) ? 0 : 1;
+}
+
+#endif /* __HOST_TEST_H */
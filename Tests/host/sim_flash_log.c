@@ -0,0 +1,446 @@
+/**
+  ******************************************************************************
+  * @file           : sim_flash_log.c
+  * @brief          : Flash log on simulated bank 2 timings, with power cuts.
+  ******************************************************************************
+  * @attention
+  *
+  * Provides the FLASH HAL functions of the stand-in on a copy of the flash
+  * mapped at FLASH_BASE, so that flash_log.c runs unchanged. Programming a
+  * word takes 16 us, up to 100 us once in 20; erasing a 128 KB sector takes
+  * 1 to 2 s (scaled for the 16 and 64 KB sectors), or always 2 s with "w".
+  * Records of 20 to 120 bytes, with one of 600 to 1024 bytes in 97, are
+  * appended at a mean rate in bytes per second, and FLASH interrupts are
+  * delivered at the end of each operation.
+  *
+  * With more than one cycle, power is cut at a random time in each cycle:
+  * the word being programmed gets random bits, the sector being erased is
+  * left half erased. Otherwise the log is flushed at the end. The log is
+  * then initialised again and read back: every record must be intact, in
+  * order, and every record programmed before the end of the cycle must be
+  * there; only the record being programmed at a cut may be missing.
+  *
+  * Usage: sim_flash_log first_sector num_sectors rate cycles cycle_s seed [w]
+  *
+  * Build with -no-pie -fno-pic: the flash is mapped at its own address.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "flash_log.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_FLASH_SIZE                0x200000U
+#define SIM_STAGE_WORDS               4096U
+#define SIM_MAX_RECORDS               4000000U
+
+#define SIM_OP_NONE                   0U
+#define SIM_OP_PROGRAM                1U
+#define SIM_OP_ERASE                  2U
+
+/* Private variables ---------------------------------------------------------*/
+static FlashLog_HandleTypeDef Log;
+static uint32_t Stage[SIM_STAGE_WORDS];
+static uint32_t FirstSector;
+static uint32_t NumSectors;
+
+/* Simulated time in microseconds, and the operation in progress */
+static double Now;
+static double OpEnd;
+static uint32_t Op;
+static uint32_t OpAddress;
+static uint32_t OpData;
+static uint32_t OpSector;
+static double EraseMin = 1e6;
+static double EraseMax = 2e6;
+
+static uint32_t Erases[FLASH_SECTOR_TOTAL];
+static uint32_t Overwrites;
+static uint32_t BusyStarts;
+
+/* Records accepted, with the stage index after each, and records programmed */
+static uint32_t PendingId[SIM_MAX_RECORDS];
+static uint32_t PendingEnd[SIM_MAX_RECORDS];
+static uint32_t NumPending;
+static uint32_t PendingRead;
+static uint32_t Committed[SIM_MAX_RECORDS];
+static uint32_t NumCommitted;
+
+/* Seeded from the command line, unlike HostTest_Rand() */
+static uint64_t RandState = 88172645463325252ULL;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Rand(void)
+{
+  RandState ^= RandState << 13;
+  RandState ^= RandState >> 7;
+  RandState ^= RandState << 17;
+  return (uint32_t)RandState;
+}
+
+/* Uniform in [0, 1) */
+static double Uniform(void)
+{
+  return (Rand() & 0xFFFFFFU) / 16777216.0;
+}
+
+static uint32_t SectorSize(uint32_t Sector)
+{
+  Sector %= 12U;
+  return (Sector < 4U) ? 0x4000U : ((Sector == 4U) ? 0x10000U : 0x20000U);
+}
+
+static uint32_t SectorBase(uint32_t Sector)
+{
+  uint32_t base = FLASH_BASE + ((Sector / 12U) * 0x100000U);
+
+  Sector %= 12U;
+  if (Sector < 4U)
+  {
+    return base + (Sector * 0x4000U);
+  }
+  return base + ((Sector == 4U) ? 0x10000U : ((Sector - 4U) * 0x20000U));
+}
+
+/* Record Id: Id in the first 4 bytes, pseudo-random rest */
+static uint32_t RecordLength(uint32_t Id)
+{
+  uint32_t x = Id * 40503U;
+
+  x ^= x >> 7;
+  return ((Id % 97U) == 0U) ? (600U + (x % 425U)) : (20U + (x % 100U));
+}
+
+static void RecordFill(uint32_t Id, uint8_t *pData, uint32_t Len)
+{
+  uint32_t x = (Id * 2654435761U) + 1U;
+  uint32_t i;
+
+  memcpy(pData, &Id, 4U);
+  for (i = 4U; i < Len; i++)
+  {
+    x = (x * 1103515245U) + 12345U;
+    pData[i] = (uint8_t)(x >> 16);
+  }
+}
+
+/* Simulated FLASH HAL -------------------------------------------------------*/
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program_IT(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+  HOST_CHECK((TypeProgram == FLASH_TYPEPROGRAM_WORD) && ((Address & 3U) == 0U));
+  if (Op != SIM_OP_NONE)
+  {
+    BusyStarts++;
+  }
+  if (*(uint32_t *)(uintptr_t)Address != 0xFFFFFFFFU)
+  {
+    Overwrites++;
+  }
+  Op = SIM_OP_PROGRAM;
+  OpAddress = Address;
+  OpData = (uint32_t)Data;
+  OpEnd = Now + 16.0 + ((Uniform() < 0.05) ? (Uniform() * 84.0) : 0.0);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase_IT(FLASH_EraseInitTypeDef *pEraseInit)
+{
+  HOST_CHECK((pEraseInit->TypeErase == FLASH_TYPEERASE_SECTORS) && (pEraseInit->NbSectors == 1U));
+  if (Op != SIM_OP_NONE)
+  {
+    BusyStarts++;
+  }
+  Op = SIM_OP_ERASE;
+  OpSector = pEraseInit->Sector;
+  OpEnd = Now + ((EraseMin + (Uniform() * (EraseMax - EraseMin))) * SectorSize(OpSector) / 0x20000U);
+  return HAL_OK;
+}
+
+void HAL_FLASH_IRQHandler(void)
+{
+  FLASH->SR &= ~FLASH_FLAG_EOP;
+}
+
+/* End the operation in progress and deliver its interrupt */
+static void Complete(void)
+{
+  if (Op == SIM_OP_PROGRAM)
+  {
+    *(uint32_t *)(uintptr_t)OpAddress &= OpData;
+  }
+  else
+  {
+    memset((void *)(uintptr_t)SectorBase(OpSector), 0xFF, SectorSize(OpSector));
+    Erases[OpSector]++;
+  }
+  Now = OpEnd;
+  Op = SIM_OP_NONE;
+  FLASH->SR |= FLASH_FLAG_EOP;
+  FlashLog_IRQHandler(&Log);
+}
+
+/* Interrupt the operation in progress */
+static void PowerCut(void)
+{
+  uint32_t *p;
+  uint32_t i;
+  uint32_t r;
+
+  if (Op == SIM_OP_PROGRAM)
+  {
+    *(uint32_t *)(uintptr_t)OpAddress &= (OpData | Rand());
+  }
+  else if (Op == SIM_OP_ERASE)
+  {
+    p = (uint32_t *)(uintptr_t)SectorBase(OpSector);
+    for (i = 0U; i < (SectorSize(OpSector) / 4U); i++)
+    {
+      r = Rand() % 3U;
+      if (r == 1U)
+      {
+        p[i] = 0xFFFFFFFFU;
+      }
+      else if (r == 2U)
+      {
+        p[i] |= Rand();
+      }
+    }
+  }
+  Op = SIM_OP_NONE;
+}
+
+/* Move the records the interrupt has fully programmed to Committed */
+static void Track(void)
+{
+  while ((PendingRead < NumPending) && ((int32_t)(Log.StageTail - PendingEnd[PendingRead]) >= 0))
+  {
+    Committed[NumCommitted++] = PendingId[PendingRead++];
+  }
+}
+
+static HAL_StatusTypeDef Start(void)
+{
+  memset(&Log, 0, sizeof(Log));
+  Log.Init.FirstSector = FirstSector;
+  Log.Init.NumSectors = NumSectors;
+  NumPending = 0U;
+  PendingRead = 0U;
+  return FlashLog_Init(&Log, Stage, SIM_STAGE_WORDS);
+}
+
+/**
+  * @brief  Read the log back and check it against the records programmed.
+  * @param  Cut    Non-zero after a power cut
+  * @param  pBytes Payload bytes read
+  * @retval HAL_OK, HAL_ERROR on a corrupt, extra or missing record
+  */
+static HAL_StatusTypeDef Verify(uint32_t Cut, uint32_t *pBytes)
+{
+  FlashLog_CursorTypeDef cursor;
+  FlashLog_RecordTypeDef r;
+  HAL_StatusTypeDef status;
+  uint8_t data[FLASHLOG_MAX_LENGTH];
+  uint32_t in_flight = (PendingRead < NumPending) ? PendingId[PendingRead] : 0xFFFFFFFFU;
+  uint32_t read = 0U;
+  uint32_t k = 0U;
+  uint32_t id;
+
+  *pBytes = 0U;
+  FlashLog_ResetCursor(&Log, &cursor);
+  for (;;)
+  {
+    status = FlashLog_ReadNext(&Log, &cursor, &r);
+    if (status == HAL_BUSY)
+    {
+      Complete();
+      continue;
+    }
+    if (status != HAL_OK)
+    {
+      break;
+    }
+
+    id = r.Timestamp;
+    RecordFill(id, data, RecordLength(id));
+    if ((r.Len != RecordLength(id)) || (memcmp(data, r.pData, r.Len) != 0))
+    {
+      printf("corrupt record %u\n", (unsigned)id);
+      return HAL_ERROR;
+    }
+    /* The oldest records are erased as the log wraps */
+    if (read == 0U)
+    {
+      while ((k < NumCommitted) && (Committed[k] != id))
+      {
+        k++;
+      }
+    }
+    if ((k < NumCommitted) && (Committed[k] == id))
+    {
+      k++;
+    }
+    else if ((k == NumCommitted) && (Cut != 0U) && (id == in_flight))
+    {
+      /* Programmed to its last word before the cut */
+      Committed[NumCommitted++] = id;
+      PendingRead++;
+      k++;
+    }
+    else
+    {
+      printf("record %u read, %u expected\n", (unsigned)id,
+             (unsigned)((k < NumCommitted) ? Committed[k] : 0xFFFFFFFFU));
+      return HAL_ERROR;
+    }
+    read++;
+    *pBytes += r.Len;
+  }
+
+  if (k != NumCommitted)
+  {
+    printf("%u of %u records programmed read back\n", (unsigned)k, (unsigned)NumCommitted);
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+int main(int argc, char **argv)
+{
+  uint8_t data[FLASHLOG_MAX_LENGTH];
+  uint64_t accepted = 0U;
+  uint64_t dropped = 0U;
+  uint32_t min_bytes = 0xFFFFFFFFU;
+  uint32_t high_water = 0U;
+  uint32_t erase_min = 0xFFFFFFFFU;
+  uint32_t erase_max = 0U;
+  uint32_t bytes;
+  uint32_t id = 0U;
+  uint32_t len;
+  uint32_t s;
+  double rate;
+  double cycle_s;
+  double end;
+  double next;
+  int cycles;
+  int c;
+
+  if (argc < 7)
+  {
+    printf("usage: %s first_sector num_sectors rate cycles cycle_s seed [w]\n", argv[0]);
+    return 2;
+  }
+  FirstSector = (uint32_t)atoi(argv[1]);
+  NumSectors = (uint32_t)atoi(argv[2]);
+  rate = atof(argv[3]);
+  cycles = atoi(argv[4]);
+  cycle_s = atof(argv[5]);
+  RandState ^= (uint64_t)atoi(argv[6]) * 0x9E3779B97F4A7C15ULL;
+  if (argc > 7)
+  {
+    EraseMin = 2e6;
+    EraseMax = 2e6;
+  }
+
+  if (mmap((void *)FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void *)FLASH_BASE)
+  {
+    perror("mmap");
+    return 1;
+  }
+  /* Not erased when shipped */
+  memset((void *)FLASH_BASE, 0x5A, SIM_FLASH_SIZE);
+
+  HOST_CHECK(Start() == HAL_OK);
+  for (c = 0; (c < cycles) && (HostTest_Failures == 0U); c++)
+  {
+    end = Now + (cycle_s * 1e6 * ((cycles > 1) ? Uniform() : 1.0));
+    next = Now;
+    for (;;)
+    {
+      if ((Op != SIM_OP_NONE) && (OpEnd <= next))
+      {
+        if (OpEnd > end)
+        {
+          break;
+        }
+        Complete();
+        Track();
+        continue;
+      }
+      if (next > end)
+      {
+        break;
+      }
+
+      Now = next;
+      len = RecordLength(id);
+      RecordFill(id, data, len);
+      if (FlashLog_Append(&Log, data, len, id) == HAL_OK)
+      {
+        PendingId[NumPending] = id;
+        PendingEnd[NumPending++] = Log.StageHead;
+        accepted++;
+      }
+      else
+      {
+        dropped++;
+      }
+      id++;
+      if ((NumPending == SIM_MAX_RECORDS) || (NumCommitted >= (SIM_MAX_RECORDS - 10U)))
+      {
+        puts("too many records for the simulation");
+        return 1;
+      }
+      next = Now + (len * 1e6 / rate * (0.5 + Uniform()));
+    }
+    Now = end;
+    Track();
+    high_water = (Log.StageHighWater > high_water) ? Log.StageHighWater : high_water;
+
+    if (cycles > 1)
+    {
+      PowerCut();
+    }
+    else
+    {
+      while (Op != SIM_OP_NONE)
+      {
+        Complete();
+        Track();
+      }
+    }
+
+    HOST_CHECK(Start() == HAL_OK);
+    HOST_CHECK(Verify((cycles > 1) ? 1U : 0U, &bytes) == HAL_OK);
+    if ((NumCommitted != 0U) && (Erases[FirstSector] > 1U) && (bytes < min_bytes))
+    {
+      min_bytes = bytes;
+    }
+  }
+
+  for (s = FirstSector; s < (FirstSector + NumSectors); s++)
+  {
+    erase_min = (Erases[s] < erase_min) ? Erases[s] : erase_min;
+    erase_max = (Erases[s] > erase_max) ? Erases[s] : erase_max;
+  }
+  HOST_CHECK(Overwrites == 0U);
+  HOST_CHECK(BusyStarts == 0U);
+  printf("sectors %u+%u, %.0f B/s, %d cycles, %.0f s: %lu records accepted, %lu dropped, %u programmed,"
+         " stage high water %u words, erases per sector %u..%u, %u B readable after a wrap at least\n",
+         (unsigned)FirstSector, (unsigned)NumSectors, rate, c, Now / 1e6, (unsigned long)accepted,
+         (unsigned long)dropped, (unsigned)NumCommitted, (unsigned)high_water, (unsigned)erase_min,
+         (unsigned)erase_max, (unsigned)((min_bytes == 0xFFFFFFFFU) ? 0U : min_bytes));
+
+  return HostTest_Result("sim_flash_log");
+}
@@ -0,0 +1,205 @@
+/**
+  ******************************************************************************
+  * @file           : test_autobaud.c
+  * @brief          : Baud rate detection on simulated RX edge timings.
+  ******************************************************************************
+  * @attention
+  *
+  * Builds the edge timestamps of 8N1 characters (NMEA joined at a random
+  * offset, or random binary, with random idle gaps) and feeds them to
+  * AutoBaud_Edge(), for every candidate rate with -2%, 0 and +2% rate error,
+  * at 72 and 180 MHz, with and without 80 cycles of EXTI latency jitter and
+  * injected glitches. Every run must lock on the right rate within 6
+  * characters. The EXTI path is then run through AutoBaud_IRQHandler() on
+  * the register stand-ins.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "autobaud.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define RUNS                          300U
+#define MAX_CHARS                     200U
+#define MAX_LOCK_CHARS                6U
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t Rates[] = { 4800, 9600, 19200, 38400, 57600, 115200 };
+static const char Nmea[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+                           "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+#define NUM_RATES                     (sizeof(Rates) / sizeof(Rates[0]))
+
+static uint32_t Locked;
+
+/* Private functions ---------------------------------------------------------*/
+void AutoBaud_LockedCallback(AutoBaud_HandleTypeDef *habaud)
+{
+  UNUSED(habaud);
+  Locked++;
+}
+
+/* Byte of the simulated line */
+static uint8_t Traffic(uint32_t Binary, uint32_t Offset, uint32_t Index)
+{
+  return (Binary != 0U) ? (uint8_t)HostTest_Rand() : (uint8_t)Nmea[(Offset + Index) % (sizeof(Nmea) - 1U)];
+}
+
+/**
+  * @brief  Feed the edges of a character stream until the detector locks.
+  * @retval Characters sent until the lock, 0 if it did not lock
+  */
+static uint32_t Run(uint32_t Clock, double Baud, uint32_t Binary, uint32_t Jitter, uint32_t Glitch,
+                    uint32_t *pRate)
+{
+  AutoBaud_HandleTypeDef h;
+  double bit = Clock / Baud;
+  double t = (double)(HostTest_Rand() % 100000U);
+  uint32_t t0 = HostTest_Rand();
+  uint32_t offset = HostTest_Rand() % (sizeof(Nmea) - 1U);
+  uint32_t level = 1U;
+  uint32_t stamp;
+  uint32_t c;
+  uint32_t i;
+  uint32_t b;
+  uint8_t bits[10];
+
+  memset(&h, 0, sizeof(h));
+  h.Init.pRates = Rates;
+  h.Init.NumRates = NUM_RATES;
+  h.Init.CycleClock = Clock;
+  HOST_CHECK(AutoBaud_Init(&h) == HAL_OK);
+
+  for (c = 0U; c < MAX_CHARS; c++)
+  {
+    b = Traffic(Binary, offset, c);
+    bits[0] = 0U;
+    for (i = 0U; i < 8U; i++)
+    {
+      bits[i + 1U] = (uint8_t)((b >> i) & 1U);
+    }
+    bits[9] = 1U;
+
+    for (i = 0U; i < 10U; i++)
+    {
+      if (bits[i] != level)
+      {
+        level = bits[i];
+        stamp = t0 + (uint32_t)t + 12U + ((Jitter != 0U) ? (HostTest_Rand() % Jitter) : 0U);
+        if (AutoBaud_Edge(&h, stamp) != 0U)
+        {
+          *pRate = h.BaudRate;
+          return c + 1U;
+        }
+        if ((Glitch != 0U) && ((HostTest_Rand() % 40U) == 0U))
+        {
+          (void)AutoBaud_Edge(&h, stamp + 20U);
+          (void)AutoBaud_Edge(&h, stamp + 40U);
+        }
+      }
+      t += bit;
+    }
+    /* Idle gap after one character in three */
+    if ((HostTest_Rand() % 3U) == 0U)
+    {
+      t += bit * (HostTest_Rand() % 30U);
+    }
+  }
+
+  *pRate = 0U;
+  return 0U;
+}
+
+static void CheckDetection(void)
+{
+  static const uint32_t Clocks[] = { 72000000U, 180000000U };
+  static const double Errors[] = { -0.02, 0.0, 0.02 };
+  uint32_t runs = 0U;
+  uint32_t wrong = 0U;
+  uint32_t unlocked = 0U;
+  uint32_t max_chars = 0U;
+  uint64_t sum_chars = 0U;
+  uint32_t k;
+  uint32_t binary;
+  uint32_t jitter;
+  uint32_t glitch;
+  uint32_t r;
+  uint32_t e;
+  uint32_t n;
+  uint32_t chars;
+  uint32_t rate;
+
+  for (k = 0U; k < 2U; k++)
+  for (binary = 0U; binary < 2U; binary++)
+  for (jitter = 0U; jitter <= 80U; jitter += 80U)
+  for (glitch = 0U; glitch < 2U; glitch++)
+  for (r = 0U; r < NUM_RATES; r++)
+  for (e = 0U; e < 3U; e++)
+  for (n = 0U; n < RUNS; n++)
+  {
+    chars = Run(Clocks[k], Rates[r] * (1.0 + Errors[e]), binary, jitter, glitch, &rate);
+    runs++;
+    if (chars == 0U)
+    {
+      unlocked++;
+    }
+    else if (rate != Rates[r])
+    {
+      wrong++;
+    }
+    else
+    {
+      sum_chars += chars;
+      max_chars = (chars > max_chars) ? chars : max_chars;
+    }
+  }
+
+  HOST_CHECK((wrong == 0U) && (unlocked == 0U));
+  HOST_CHECK(max_chars <= MAX_LOCK_CHARS);
+  printf("%u runs: %u wrong, %u not locked, lock after %.1f characters on average, %u at most\n",
+         (unsigned)runs, (unsigned)wrong, (unsigned)unlocked,
+         (double)sum_chars / (double)(runs - wrong - unlocked), (unsigned)max_chars);
+}
+
+/* The same detection through the EXTI interrupt handler */
+static void CheckIrqHandler(void)
+{
+  AutoBaud_HandleTypeDef h;
+  uint32_t bit = 72000000U / 9600U;
+  uint32_t edges = 0U;
+
+  memset(&h, 0, sizeof(h));
+  h.Init.GPIOx = GPIOA;
+  h.Init.Pin = GPIO_PIN_10;
+  h.Init.pRates = Rates;
+  h.Init.NumRates = NUM_RATES;
+  h.Init.CycleClock = 72000000U;
+  HOST_CHECK(AutoBaud_Init(&h) == HAL_OK);
+  HOST_CHECK(AutoBaud_Start(&h) == HAL_OK);
+  HOST_CHECK(((EXTI->IMR & GPIO_PIN_10) != 0U) && ((EXTI->RTSR & EXTI->FTSR & GPIO_PIN_10) != 0U));
+  HOST_CHECK((SYSCFG->EXTICR[2] & 0x0F00U) == 0U);
+
+  /* 0x55 'U': an edge on every bit, idle gap of 3 bits */
+  Locked = 0U;
+  DWT->CYCCNT = 1000U;
+  while ((Locked == 0U) && (edges < 1000U))
+  {
+    EXTI->PR |= GPIO_PIN_10;
+    AutoBaud_IRQHandler(&h);
+    DWT->CYCCNT += bit * ((((edges % 10U) == 9U)) ? 4U : 1U);
+    edges++;
+  }
+  HOST_CHECK((Locked == 1U) && (h.BaudRate == 9600U));
+  HOST_CHECK((EXTI->IMR & GPIO_PIN_10) == 0U);
+}
+
+int main(void)
+{
+  CheckDetection();
+  CheckIrqHandler();
+
+  return HostTest_Result("test_autobaud");
+}
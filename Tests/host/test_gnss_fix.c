@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file           : test_gnss_fix.c
+  * @brief          : Fixed-point conversions against a double reference.
+  ******************************************************************************
+  * @attention
+  *
+  * Random ddmm.mmmm angles with 0 to 8 fraction digits, speeds in knots and
+  * km/h and times of day are converted with gnss_fix.c and with doubles;
+  * the results must agree within 1 LSB. Fields out of range, including
+  * degrees that would wrap the 32-bit scaling, must be rejected.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdlib.h>
+#include "gnss_fix.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ANGLES                        2000000U
+#define SPEEDS                        1000000U
+
+/* Private variables ---------------------------------------------------------*/
+static const double Pow10[10] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+static const uint32_t Pow10U[10] = { 1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U,
+                                     10000000U, 100000000U, 1000000000U };
+
+/* Private functions ---------------------------------------------------------*/
+static void CheckAngles(void)
+{
+  Nmea_DecimalTypeDef f;
+  uint32_t deg;
+  uint32_t min;
+  uint32_t frac;
+  uint32_t scale;
+  uint32_t i;
+  int32_t deg7;
+  double value;
+  double ref;
+  long err;
+  long max_err = 0;
+  uint32_t checked = 0U;
+
+  for (i = 0U; i < ANGLES; i++)
+  {
+    scale = HostTest_Rand() % 9U;
+    deg = HostTest_Rand() % 180U;
+    min = HostTest_Rand() % 60U;
+    frac = HostTest_Rand() % Pow10U[scale];
+    value = ((((double)deg * 100.0) + min) * Pow10[scale]) + frac;
+    if (value > 2147483647.0)
+    {
+      continue;
+    }
+    f.Value = (int32_t)value;
+    f.Scale = (uint8_t)scale;
+
+    HOST_CHECK(GnssFix_ToDeg7(&f, ((i & 1U) != 0U) ? 'W' : 'N', &deg7) == HAL_OK);
+    ref = (deg + ((min + (frac / Pow10[scale])) / 60.0)) * 1e7;
+    err = labs(lround(((i & 1U) != 0U) ? -ref : ref) - deg7);
+    if (err > max_err)
+    {
+      max_err = err;
+    }
+    checked++;
+  }
+  HOST_CHECK(max_err <= 1);
+  printf("ToDeg7: %u angles, max error %ld LSB\n", (unsigned)checked, max_err);
+}
+
+static HAL_StatusTypeDef Deg7(int32_t Value, uint8_t Scale, char Hemisphere)
+{
+  Nmea_DecimalTypeDef f = { Value, Scale };
+  int32_t deg7;
+
+  return GnssFix_ToDeg7(&f, Hemisphere, &deg7);
+}
+
+static void CheckAngleErrors(void)
+{
+  Nmea_DecimalTypeDef f = { 179599999, 4 };
+  int32_t deg7;
+
+  HOST_CHECK(GnssFix_ToDeg7(&f, 'E', &deg7) == HAL_OK);
+  HOST_CHECK(deg7 == 1799999983);
+  HOST_CHECK(Deg7(180000000, 4, 'E') == HAL_OK);
+  HOST_CHECK(Deg7(180000001, 4, 'E') == HAL_ERROR);
+  HOST_CHECK(Deg7(181000000, 4, 'E') == HAL_ERROR);
+  /* 430 degrees and above wrap deg * 10^7 in 32 bits */
+  HOST_CHECK(Deg7(430000000, 4, 'E') == HAL_ERROR);
+  HOST_CHECK(Deg7(2147483647, 0, 'E') == HAL_ERROR);
+  HOST_CHECK(Deg7(4860000, 3, 'N') == HAL_ERROR);             /* 60 minutes */
+  HOST_CHECK(Deg7(-4807038, 3, 'N') == HAL_ERROR);
+  HOST_CHECK(Deg7(4807038, NMEA_DECIMAL_EMPTY, 'N') == HAL_ERROR);
+  HOST_CHECK(Deg7(4807038, 3, 'X') == HAL_ERROR);
+}
+
+static void CheckSpeeds(void)
+{
+  Nmea_DecimalTypeDef f;
+  uint32_t scale;
+  uint32_t i;
+  int32_t mms;
+  long err;
+  long max_err = 0;
+
+  for (i = 0U; i < SPEEDS; i++)
+  {
+    scale = HostTest_Rand() % 4U;
+    f.Value = (int32_t)(HostTest_Rand() % 1000000U);
+    f.Scale = (uint8_t)scale;
+
+    if (GnssFix_KnotsToMms(&f, &mms) == HAL_OK)
+    {
+      err = labs(lround((f.Value / Pow10[scale]) * 1852000.0 / 3600.0) - mms);
+      max_err = (err > max_err) ? err : max_err;
+    }
+    if (GnssFix_KmhToMms(&f, &mms) == HAL_OK)
+    {
+      err = labs(lround((f.Value / Pow10[scale]) * 1e6 / 3600.0) - mms);
+      max_err = (err > max_err) ? err : max_err;
+    }
+  }
+  HOST_CHECK(max_err <= 1);
+  printf("KnotsToMms, KmhToMms: max error %ld LSB\n", max_err);
+}
+
+static void CheckTimes(void)
+{
+  Nmea_DecimalTypeDef f;
+  uint32_t ms;
+
+  f.Value = 12351999;
+  f.Scale = 2U;
+  HOST_CHECK((GnssFix_ToTimeOfDay(&f, &ms) == HAL_OK) && (ms == ((12U * 3600000U) + (35U * 60000U) + 19990U)));
+  f.Value = 235960;                                           /* leap second */
+  f.Scale = 0U;
+  HOST_CHECK((GnssFix_ToTimeOfDay(&f, &ms) == HAL_OK) && (ms == 86400000U));
+  f.Value = 2360000;
+  f.Scale = 1U;
+  HOST_CHECK(GnssFix_ToTimeOfDay(&f, &ms) == HAL_ERROR);
+  f.Value = 240000;
+  f.Scale = 0U;
+  HOST_CHECK(GnssFix_ToTimeOfDay(&f, &ms) == HAL_ERROR);
+}
+
+int main(void)
+{
+  CheckAngles();
+  CheckAngleErrors();
+  CheckSpeeds();
+  CheckTimes();
+
+  return HostTest_Result("test_gnss_fix");
+}
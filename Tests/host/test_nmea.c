@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file           : test_nmea.c
+  * @brief          : NMEA parser delivery, fields, checksum and mask.
+  ******************************************************************************
+  * @attention
+  *
+  * Feeds a mix of GGA, RMC, VTG, GSA, GSV and unsupported sentences to
+  * Nmea_Parse(), split at every position, and checks what is delivered;
+  * then the fields of a GGA, a wrong checksum and SentenceMask. Last, a
+  * sentence for every alphanumeric formatter behind known and unknown
+  * talker IDs: only the supported formatters are delivered, although
+  * thousands of the others share their hash slot.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "nmea.h"
+#include "host_test.h"
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const Bodies[] =
+{
+  "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+  "GNRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A",
+  "GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A",
+  "GNGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1,1",
+  "GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00,1",
+  "GPZDA,201530.00,04,07,2002,00,00",
+};
+
+static const struct
+{
+  const char             *pFormatter;
+  Nmea_SentenceIdTypeDef Id;
+} Supported[] =
+{
+  { "GGA", NMEA_SENTENCE_GGA }, { "RMC", NMEA_SENTENCE_RMC }, { "VTG", NMEA_SENTENCE_VTG },
+  { "GSA", NMEA_SENTENCE_GSA }, { "GSV", NMEA_SENTENCE_GSV },
+};
+
+#define NUM_SUPPORTED                 (sizeof(Supported) / sizeof(Supported[0]))
+
+static char Mix[512];
+static uint32_t MixLength;
+static uint32_t Delivered[NMEA_SENTENCE_GSV + 1U];
+static Nmea_SentenceTypeDef Last;
+
+/* Private functions ---------------------------------------------------------*/
+void Nmea_SentenceCallback(Nmea_HandleTypeDef *hnmea, const Nmea_SentenceTypeDef *pSentence)
+{
+  UNUSED(hnmea);
+  Delivered[pSentence->Id]++;
+  Last = *pSentence;
+}
+
+/* Append "$body*hh\r\n" */
+static uint32_t Frame(char *pDst, const char *pBody, uint8_t Corrupt)
+{
+  uint8_t cs = 0U;
+  const char *p;
+
+  for (p = pBody; *p != '\0'; p++)
+  {
+    cs ^= (uint8_t)*p;
+  }
+  return (uint32_t)sprintf(pDst, "$%s*%02X\r\n", pBody, (unsigned)(cs ^ Corrupt));
+}
+
+static void ParseSplit(Nmea_HandleTypeDef *hnmea, const char *pData, uint32_t Len, uint32_t Split)
+{
+  Nmea_Parse(hnmea, (const uint8_t *)pData, Split);
+  Nmea_Parse(hnmea, (const uint8_t *)&pData[Split], Len - Split);
+}
+
+static void CheckSplits(void)
+{
+  Nmea_HandleTypeDef h;
+  uint32_t split;
+
+  for (split = 0U; split <= MixLength; split++)
+  {
+    memset(Delivered, 0, sizeof(Delivered));
+    Nmea_Init(&h);
+    ParseSplit(&h, Mix, MixLength, split);
+    HOST_CHECK(h.SentenceCount == 5U);
+    HOST_CHECK(h.IgnoredCount == 1U);
+    HOST_CHECK((h.ChecksumErrors == 0U) && (h.FormatErrors == 0U));
+    HOST_CHECK((Delivered[NMEA_SENTENCE_GGA] == 1U) && (Delivered[NMEA_SENTENCE_GSV] == 1U));
+  }
+}
+
+static void CheckFields(void)
+{
+  Nmea_HandleTypeDef h;
+  char line[128];
+  uint32_t n;
+
+  Nmea_Init(&h);
+  n = Frame(line, Bodies[0], 0U);
+  Nmea_Parse(&h, (const uint8_t *)line, n);
+  HOST_CHECK(Last.Id == NMEA_SENTENCE_GGA);
+  HOST_CHECK((Last.Data.GGA.Latitude.Value == 4807038) && (Last.Data.GGA.Latitude.Scale == 3U));
+  HOST_CHECK((Last.Data.GGA.NS == 'N') && (Last.Data.GGA.EW == 'E'));
+  HOST_CHECK((Last.Data.GGA.Quality == 1U) && (Last.Data.GGA.NumSatellites == 8U));
+  HOST_CHECK((Last.Data.GGA.Altitude.Value == 5454) && (Last.Data.GGA.Altitude.Scale == 1U));
+
+  /* A wrong checksum is counted and nothing is delivered */
+  memset(Delivered, 0, sizeof(Delivered));
+  n = Frame(line, Bodies[1], 0x01U);
+  Nmea_Parse(&h, (const uint8_t *)line, n);
+  HOST_CHECK((h.ChecksumErrors == 1U) && (Delivered[NMEA_SENTENCE_RMC] == 0U));
+
+  /* Masked types are skipped once their address is known */
+  h.SentenceMask = NMEA_SENTENCE_MASK(NMEA_SENTENCE_RMC);
+  n = Frame(line, Bodies[0], 0U);
+  Nmea_Parse(&h, (const uint8_t *)line, n);
+  HOST_CHECK((h.IgnoredCount == 1U) && (Delivered[NMEA_SENTENCE_GGA] == 0U));
+}
+
+/* 36^3 formatters in NMEA_HASH_SIZE slots: every supported formatter shares
+   its slot with over a thousand unknown ones, which Nmea_Identify() must
+   tell apart by the key compare */
+static void CheckIdentify(void)
+{
+  static const char Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  static const char *const Talkers[] = { "GP", "GN", "GL", "GA", "GB", "BD", "QZ", "XX", "II", "P0" };
+  Nmea_HandleTypeDef h;
+  Nmea_SentenceIdTypeDef expected;
+  uint32_t sentences = 0U;
+  uint32_t wrong = 0U;
+  uint32_t before;
+  uint32_t t;
+  uint32_t c;
+  uint32_t s;
+  char body[16];
+  char line[32];
+  uint32_t n;
+
+  Nmea_Init(&h);
+  for (c = 0U; c < (36U * 36U * 36U); c++)
+  {
+    body[2] = Chars[c / (36U * 36U)];
+    body[3] = Chars[(c / 36U) % 36U];
+    body[4] = Chars[c % 36U];
+    memcpy(&body[5], ",1", 3U);
+
+    expected = NMEA_SENTENCE_UNKNOWN;
+    for (s = 0U; s < NUM_SUPPORTED; s++)
+    {
+      if (memcmp(&body[2], Supported[s].pFormatter, 3U) == 0)
+      {
+        expected = Supported[s].Id;
+      }
+    }
+
+    for (t = 0U; t < (sizeof(Talkers) / sizeof(Talkers[0])); t++)
+    {
+      memcpy(body, Talkers[t], 2U);
+      n = Frame(line, body, 0U);
+      before = h.SentenceCount;
+      Last.Id = NMEA_SENTENCE_UNKNOWN;
+      Nmea_Parse(&h, (const uint8_t *)line, n);
+      sentences++;
+      if (expected == NMEA_SENTENCE_UNKNOWN)
+      {
+        wrong += ((h.SentenceCount != before) || (Last.Id != NMEA_SENTENCE_UNKNOWN)) ? 1U : 0U;
+      }
+      else
+      {
+        wrong += ((h.SentenceCount != (before + 1U)) || (Last.Id != expected)) ? 1U : 0U;
+      }
+    }
+  }
+
+  HOST_CHECK(wrong == 0U);
+  HOST_CHECK(h.SentenceCount == (NUM_SUPPORTED * (sizeof(Talkers) / sizeof(Talkers[0]))));
+  HOST_CHECK((h.ChecksumErrors == 0U) && (h.FormatErrors == 0U));
+  printf("%u addresses: %u delivered, %u ignored, %u wrong\n", (unsigned)sentences,
+         (unsigned)h.SentenceCount, (unsigned)h.IgnoredCount, (unsigned)wrong);
+}
+
+int main(void)
+{
+  uint32_t i;
+
+  for (i = 0U; i < (sizeof(Bodies) / sizeof(Bodies[0])); i++)
+  {
+    MixLength += Frame(&Mix[MixLength], Bodies[i], 0U);
+  }
+
+  CheckSplits();
+  CheckFields();
+  CheckIdentify();
+
+  return HostTest_Result("test_nmea");
+}
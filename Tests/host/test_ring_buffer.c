@@ -0,0 +1,329 @@
+/**
+  ******************************************************************************
+  * @file           : test_ring_buffer.c
+  * @brief          : USART1 reception into the SPSC ring, on the simulated target.
+  ******************************************************************************
+  * @attention
+  *
+  * The first check runs the reception of main.c on the simulated STM32F429
+  * (Target/target_sim.c): the port registry, the driver and its circular Rx
+  * DMA, the deferred PendSV processing with RxPublish(), the TIM2 timeout
+  * and the main loop RxPoll(), all as shipped with the options of main.h.
+  * The line carries GGA sentences numbered in their altitude field, in
+  * groups with gaps shorter than RX_EOF_TIMEOUT, one burst per 100 ms epoch,
+  * queued from simulator wake-ups whatever the firmware is doing.
+  * The main loop pays a cost per byte parsed, and interrupts preempt it
+  * between calls (Nmea_Parse is wrapped for that, and to collect the
+  * sentences delivered).
+  *  - nominal: every sentence is delivered intact, nothing is lost, and the
+  *    timeout elapses once per epoch
+  *  - overload: PendSV is held back for longer than the DMA takes to lap
+  *    RxData, and the main loop stalls for longer than the ring holds. The
+  *    bytes sent must be the bytes the ring accepted plus those the driver
+  *    counted as overwritten (RxLostCount) and those the full ring refused
+  *    (DroppedBytes); the sentences delivered are intact and in order, and
+  *    what the framer cut at a loss is the tail of a sentence.
+  * The second check runs a producer and a consumer of a ring in two
+  * threads, which exercises the acquire/release ordering of the indexes; a
+  * side that cannot progress yields, so that a single CPU host completes.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+/* Host headers first: the CMSIS register qualifiers (__I, __O) are macros */
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "host_test.h"
+#define main Firmware_main
+#include "main.c"
+#undef main
+#include "target_sim.h"
+
+/* Private define ------------------------------------------------------------*/
+#define EPOCH_MS                      100U
+#define SENTENCES_PER_EPOCH           8U
+#define NOMINAL_EPOCHS                100U
+#define OVERLOAD_EPOCHS               300U
+
+/* Main loop: a pass costs LOOP_CYCLES and up to as much again, parsing a byte
+   costs PARSE_CYCLES */
+#define LOOP_CYCLES                   1000U
+#define PARSE_CYCLES                  40U
+
+#define RING_SIZE                     1024U
+#define THREAD_BYTES                  20000000U
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t Ms;
+static uint64_t Char;
+
+/* Line traffic */
+static uint32_t SentSentences;
+static uint32_t SentBytes;
+static uint32_t EpochsLeft;
+static uint32_t InEpoch;
+static uint64_t EpochAt;
+
+/* Sentences delivered to Nmea_Parse() */
+static char Line[RXFRAME_MAX_LENGTH + 1U];
+static uint32_t LineLen;
+static uint32_t Delivered;
+static uint32_t Corrupted;
+static uint32_t Fragments;
+static int64_t LastSeq = -1;
+
+/* Overload: chance in 1/n of a main loop stall per sentence and of PendSV
+   held back per main loop pass, 0 for none */
+static uint32_t StallOdds;
+static uint32_t HoldOdds;
+
+static uint8_t Storage[RING_SIZE];
+static RingBuf_HandleTypeDef Ring;
+
+/* Private functions ---------------------------------------------------------*/
+void __real_Nmea_Parse(Nmea_HandleTypeDef *hnmea, const uint8_t *pData, uint32_t Len);
+
+static uint32_t Sentence(uint32_t Seq, char *pBuf)
+{
+  uint8_t sum = 0U;
+  int len = sprintf(pBuf, "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,%u.0,M,46.9,M,,", (unsigned)Seq);
+  int i;
+
+  for (i = 1; i < len; i++)
+  {
+    sum ^= (uint8_t)pBuf[i];
+  }
+  return (uint32_t)(len + sprintf(&pBuf[len], "*%02X\r\n", sum));
+}
+
+/* The main loop parses a frame: it costs time, during which it is preempted */
+void __wrap_Nmea_Parse(Nmea_HandleTypeDef *hnmea, const uint8_t *pData, uint32_t Len)
+{
+  char expected[RXFRAME_MAX_LENGTH + 1U];
+  const char *alt;
+  unsigned long seq;
+
+  TargetSim_Run((uint64_t)Len * PARSE_CYCLES);
+  if ((StallOdds != 0U) && ((HostTest_Rand() % StallOdds) == 0U))
+  {
+    TargetSim_Run((300U + (HostTest_Rand() % 900U)) * Ms);
+  }
+
+  if ((LineLen + Len) <= RXFRAME_MAX_LENGTH)
+  {
+    memcpy(&Line[LineLen], pData, Len);
+  }
+  LineLen += Len;
+  if ((LineLen <= RXFRAME_MAX_LENGTH) && (Line[LineLen - 1U] == '\n'))
+  {
+    /* Whole sentence: it must be the one of its number, after the previous one.
+       The tail of a sentence cut by a loss is a frame of its own. */
+    Line[LineLen] = '\0';
+    alt = strstr(Line, ",0.9,");
+    seq = (alt != NULL) ? strtoul(alt + 5, NULL, 10) : 0UL;
+    if (Line[0] != '$')
+    {
+      Fragments++;
+    }
+    else if ((alt != NULL) && ((int64_t)seq > LastSeq) && (Sentence((uint32_t)seq, expected) == LineLen)
+        && (memcmp(Line, expected, LineLen) == 0))
+    {
+      LastSeq = (int64_t)seq;
+      Delivered++;
+    }
+    else
+    {
+      Corrupted++; printf("CORRUPT %s", Line);
+    }
+    LineLen = 0U;
+  }
+  else if (LineLen > RXFRAME_MAX_LENGTH)
+  {
+    Corrupted++;
+    LineLen = 0U;
+  }
+
+  __real_Nmea_Parse(hnmea, pData, Len);
+}
+
+/* Line traffic, on its own schedule: the next group of sentences, then a
+   wake-up after it for the group after that, or for the next epoch */
+void TargetSim_WakeCallback(void)
+{
+  char buf[RXFRAME_MAX_LENGTH];
+  uint32_t group;
+  uint32_t bytes = 0U;
+  uint32_t len;
+
+  for (group = 1U + (HostTest_Rand() % 3U); (group > 0U) && (InEpoch < SENTENCES_PER_EPOCH); group--)
+  {
+    len = Sentence(SentSentences++, buf);
+    HOST_CHECK(TargetSim_Receive(UARTPORT_USART1, (const uint8_t *)buf, len) == len);
+    bytes += len;
+    InEpoch++;
+  }
+  SentBytes += bytes;
+
+  if (InEpoch < SENTENCES_PER_EPOCH)
+  {
+    /* Between 1.5 and 2.5 characters: IDLE, but no end-of-frame timeout */
+    TargetSim_WakeAt(TargetSim_GetTime() + (bytes * Char) + ((Char * (15U + (HostTest_Rand() % 11U))) / 10U));
+  }
+  else
+  {
+    InEpoch = 0U;
+    EpochAt += EPOCH_MS * Ms;
+    if (--EpochsLeft != 0U)
+    {
+      TargetSim_WakeAt(EpochAt);
+    }
+  }
+}
+
+/* Main loop for a number of epochs of traffic, then until the line is idle */
+static void Run(uint32_t Epochs)
+{
+  uint64_t end;
+  uint64_t hold;
+
+  EpochsLeft = Epochs;
+  EpochAt = TargetSim_GetTime();
+  TargetSim_WakeAt(EpochAt);
+  while ((EpochsLeft != 0U) || (TargetSim_GetRxQueued(UARTPORT_USART1) != 0U))
+  {
+    RxPoll();
+    TargetSim_Run(LOOP_CYCLES + (HostTest_Rand() % LOOP_CYCLES));
+    if ((HoldOdds != 0U) && ((HostTest_Rand() % HoldOdds) == 0U))
+    {
+      /* Higher priority work: neither PendSV nor the main loop runs */
+      hold = (30U + (HostTest_Rand() % 50U)) * Ms;
+      TargetSim_HoldPendSV(hold);
+      TargetSim_Run(hold);
+    }
+  }
+  end = TargetSim_GetTime() + (EPOCH_MS * Ms);
+  while (TargetSim_GetTime() < end)
+  {
+    RxPoll();
+    TargetSim_Run(LOOP_CYCLES);
+  }
+}
+
+static void CheckReception(void)
+{
+  const TargetSim_PortStatsTypeDef *line = TargetSim_GetPortStats(UARTPORT_USART1);
+  uint32_t sent;
+  uint32_t elapsed;
+
+  /* What main() does up to the main loop, for USART1 reception */
+  TargetSim_Init();
+  HOST_CHECK(HAL_Init() == HAL_OK);
+  MX_GPIO_Init();
+  HOST_CHECK(UartPort_Init(UartPortConfig, sizeof(UartPortConfig) / sizeof(UartPortConfig[0])) == HAL_OK);
+  RxInit();
+  RxStart();
+  Ms = SystemCoreClock / 1000U;
+  Char = (10ULL * SystemCoreClock) / hDMAIdleReciever1.Init.BaudRate;
+
+  Run(NOMINAL_EPOCHS);
+  HOST_CHECK((Delivered == SentSentences) && (Corrupted == 0U) && (Fragments == 0U));
+  HOST_CHECK((hDMAIdleReciever1.RxLostCount == 0U) && (hRxRing.DroppedBytes == 0U));
+  HOST_CHECK(hRxTimeout.ElapsedCount == NOMINAL_EPOCHS);
+  HOST_CHECK(line->RxBytes == SentBytes);
+  printf("nominal: %u sentences, %u bytes at %u baud, %u delivered, %u end-of-frame timeouts\n",
+         (unsigned)SentSentences, (unsigned)SentBytes, (unsigned)hDMAIdleReciever1.Init.BaudRate,
+         (unsigned)Delivered, (unsigned)hRxTimeout.ElapsedCount);
+
+  sent = SentSentences;
+  elapsed = hRxTimeout.ElapsedCount;
+  StallOdds = 400U;
+  HoldOdds = 20000U;
+  Run(OVERLOAD_EPOCHS);
+
+  /* Every byte on the line is in the ring, overwritten in RxData, or refused */
+  HOST_CHECK(line->RxMissed == 0U);
+  HOST_CHECK(line->RxBytes == SentBytes);
+  HOST_CHECK(line->RxBytes == ((uint64_t)hRxRing.Head + hDMAIdleReciever1.RxLostCount + hRxRing.DroppedBytes));
+  HOST_CHECK((hDMAIdleReciever1.RxLapCount != 0U) && (hRxRing.OverflowCount != 0U));
+  HOST_CHECK((Corrupted == 0U) && (hNmea.ChecksumErrors == 0U));
+  HOST_CHECK((Delivered < SentSentences) && (Delivered > sent));
+  HOST_CHECK(RingBuf_GetCount(&hRxRing) == 0U);
+  printf("overload: %u sentences, %u delivered, %u tails; %u bytes overwritten in %u laps, %u refused by the "
+         "ring in %u writes, %u timeouts\n", (unsigned)(SentSentences - sent), (unsigned)(Delivered - sent),
+         (unsigned)Fragments, (unsigned)hDMAIdleReciever1.RxLostCount, (unsigned)hDMAIdleReciever1.RxLapCount,
+         (unsigned)hRxRing.DroppedBytes, (unsigned)hRxRing.OverflowCount,
+         (unsigned)(hRxTimeout.ElapsedCount - elapsed));
+}
+
+/* Bytes carry their position in the stream of accepted bytes */
+static void *Producer(void *pArg)
+{
+  uint8_t buf[64];
+  uint32_t pos = 0U;
+  uint32_t len;
+  uint32_t n;
+  uint32_t i;
+
+  UNUSED(pArg);
+  while (pos < THREAD_BYTES)
+  {
+    len = 1U + (HostTest_Rand() % sizeof(buf));
+    if (len > (THREAD_BYTES - pos))
+    {
+      len = THREAD_BYTES - pos;
+    }
+    for (i = 0U; i < len; i++)
+    {
+      buf[i] = (uint8_t)((pos + i) * 7U);
+    }
+    n = RingBuf_Write(&Ring, buf, len);
+    pos += n;
+    if (n < len)
+    {
+      /* Full: let the consumer run, on a single CPU too */
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+static void CheckThreads(void)
+{
+  pthread_t producer;
+  uint8_t buf[97];
+  uint32_t pos = 0U;
+  uint32_t errors = 0U;
+  uint32_t n;
+  uint32_t i;
+
+  HOST_CHECK(RingBuf_Init(&Ring, Storage, RING_SIZE) == HAL_OK);
+  HOST_CHECK(pthread_create(&producer, NULL, Producer, NULL) == 0);
+  while (pos < THREAD_BYTES)
+  {
+    n = RingBuf_Read(&Ring, buf, 1U + (pos % sizeof(buf)));
+    for (i = 0U; i < n; i++)
+    {
+      errors += (buf[i] != (uint8_t)((pos + i) * 7U)) ? 1U : 0U;
+    }
+    pos += n;
+    if (n == 0U)
+    {
+      sched_yield();
+    }
+  }
+  pthread_join(producer, NULL);
+
+  HOST_CHECK(errors == 0U);
+  HOST_CHECK(RingBuf_GetCount(&Ring) == 0U);
+  printf("threads: %u bytes, %u truncated writes\n", (unsigned)pos, (unsigned)Ring.OverflowCount);
+}
+
+int main(void)
+{
+  CheckReception();
+  CheckThreads();
+
+  return HostTest_Result("test_ring_buffer");
+}
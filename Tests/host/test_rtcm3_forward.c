@@ -0,0 +1,276 @@
+/**
+  ******************************************************************************
+  * @file           : test_rtcm3_forward.c
+  * @brief          : RTCM3 frames forwarded to USART6 in place from the RX ring.
+  ******************************************************************************
+  * @attention
+  *
+  * Runs the reception of main.c on the simulated STM32F429 with USART1 at
+  * 460800 baud: every 200 ms, two GGA sentences then a burst of up to 1 KB
+  * of RTCM3 frames, numbered in their payload. TxQueue_Send() is wrapped:
+  * the segments the sink queues are copied at that point, and what USART6
+  * sends must be exactly those copies, which checks that the ring held the
+  * bytes until the Tx DMA read them. The frames sent must each be intact and
+  * later than the one before.
+  *  - nominal: USART6 at 115200 baud keeps up, every frame is forwarded,
+  *    some of them in two segments across the end of the ring storage
+  *  - slow sink: USART6 at 9600 baud. Held frames fill the ring and the
+  *    queue: frames are dropped whole, bytes refused by the full ring, and
+  *    what is sent is still whole frames, in order.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+/* Host headers first: the CMSIS register qualifiers (__I, __O) are macros */
+#include <stdlib.h>
+#include "host_test.h"
+#define main Firmware_main
+#include "main.c"
+#undef main
+#include "target_sim.h"
+
+/* Private define ------------------------------------------------------------*/
+#define RX_BAUD                       460800U
+#define SLOW_BAUD                     9600U
+#define EPOCH_MS                      200U
+#define NOMINAL_EPOCHS                100U
+#define SLOW_EPOCHS                   50U
+#define SENTENCES_PER_EPOCH           2U
+#define BURST_BYTES                   1024U
+
+/* Main loop pass: LOOP_CYCLES and up to as much again */
+#define LOOP_CYCLES                   1000U
+
+#define FRAME_MAX                     (RTCM3_HEADER_LENGTH + RTCM3_MAX_PAYLOAD + RTCM3_CRC_LENGTH)
+#define EXPECTED_SIZE                 (1024U * 1024U)
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t Ms;
+
+/* Line traffic */
+static uint32_t EpochsLeft;
+static uint64_t EpochAt;
+static uint32_t SentFrames;
+static uint32_t SentSentences;
+
+/* Bytes the sink queued, and frames of them queued in two segments */
+static uint8_t Expected[EXPECTED_SIZE];
+static uint32_t ExpectedLen;
+static uint32_t ExpectedFrame;
+static uint32_t Split;
+
+/* Bytes sent on USART6, and the frames they make */
+static uint32_t TxLen;
+static uint32_t TxMismatch;
+static uint32_t TxFrame;
+static int64_t LastSeq = -1;
+static uint32_t Forwarded;
+static uint32_t Corrupted;
+
+/* Private functions ---------------------------------------------------------*/
+HAL_StatusTypeDef __real_TxQueue_Send(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len);
+
+static uint32_t Sentence(uint32_t Seq, char *pBuf)
+{
+  uint8_t sum = 0U;
+  int len = sprintf(pBuf, "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,%u.0,M,46.9,M,,", (unsigned)Seq);
+  int i;
+
+  for (i = 1; i < len; i++)
+  {
+    sum ^= (uint8_t)pBuf[i];
+  }
+  return (uint32_t)(len + sprintf(&pBuf[len], "*%02X\r\n", sum));
+}
+
+/* Frame Seq: message 1005-like header, the number, then bytes that hold the
+   odd preamble; no CR or LF, which would cut the sentences after it */
+static uint32_t Frame(uint32_t Seq, uint8_t *pBuf)
+{
+  uint32_t x = (Seq * 2654435761U) + 1U;
+  uint32_t len = 8U + (x % 240U);
+  uint32_t crc;
+  uint32_t i;
+
+  pBuf[0] = RTCM3_PREAMBLE;
+  pBuf[1] = (uint8_t)(len >> 8);
+  pBuf[2] = (uint8_t)len;
+  pBuf[3] = 0x3EU;
+  pBuf[4] = 0xD0U;
+  memcpy(&pBuf[5], &Seq, 4U);
+  for (i = 9U; i < (RTCM3_HEADER_LENGTH + len); i++)
+  {
+    x = (x * 1103515245U) + 12345U;
+    pBuf[i] = ((x >> 27) == 0U) ? RTCM3_PREAMBLE : (uint8_t)(x >> 16);
+    if ((pBuf[i] == '\r') || (pBuf[i] == '\n'))
+    {
+      pBuf[i] = 0U;
+    }
+  }
+  crc = Rtcm3_Crc24q(0U, pBuf, RTCM3_HEADER_LENGTH + len);
+  pBuf[i++] = (uint8_t)(crc >> 16);
+  pBuf[i++] = (uint8_t)(crc >> 8);
+  pBuf[i++] = (uint8_t)crc;
+  return i;
+}
+
+/* Length of the frame at pFrame, once its header is in the Len bytes there */
+static uint32_t FrameLength(const uint8_t *pFrame, uint32_t Len)
+{
+  return (Len < RTCM3_HEADER_LENGTH) ? UINT32_MAX
+         : (RTCM3_HEADER_LENGTH + ((((uint32_t)pFrame[1] & 0x03U) << 8) | pFrame[2]) + RTCM3_CRC_LENGTH);
+}
+
+/* The sink queues segments from the main loop: copy them as they are then */
+HAL_StatusTypeDef __wrap_TxQueue_Send(TxQueue_HandleTypeDef *htxq, const uint8_t *pData, uint16_t Len)
+{
+  HAL_StatusTypeDef status = __real_TxQueue_Send(htxq, pData, Len);
+
+  if ((htxq == &hRtcm3TxQueue) && (status == HAL_OK) && ((ExpectedLen + Len) <= EXPECTED_SIZE))
+  {
+    memcpy(&Expected[ExpectedLen], pData, Len);
+    ExpectedLen += Len;
+    while ((ExpectedLen - ExpectedFrame) >= FrameLength(&Expected[ExpectedFrame], ExpectedLen - ExpectedFrame))
+    {
+      ExpectedFrame += FrameLength(&Expected[ExpectedFrame], ExpectedLen - ExpectedFrame);
+    }
+    Split += (ExpectedFrame != ExpectedLen) ? 1U : 0U;
+  }
+  return status;
+}
+
+/* USART6 output: the bytes queued, in whole frames sent in order */
+void TargetSim_TxCallback(UartPort_IdTypeDef Id, uint8_t Byte)
+{
+  uint8_t expected[FRAME_MAX];
+  uint32_t len;
+  uint32_t seq;
+
+  if (Id != UARTPORT_USART6)
+  {
+    return;
+  }
+
+  TxMismatch += ((TxLen >= ExpectedLen) || (Expected[TxLen] != Byte)) ? 1U : 0U;
+  TxLen++;
+  len = FrameLength(&Expected[TxFrame], TxLen - TxFrame);
+  if ((TxLen - TxFrame) == len)
+  {
+    memcpy(&seq, &Expected[TxFrame + 5U], 4U);
+    if ((len >= 9U) && ((int64_t)seq > LastSeq) && (Frame(seq, expected) == len)
+        && (memcmp(&Expected[TxFrame], expected, len) == 0))
+    {
+      LastSeq = (int64_t)seq;
+      Forwarded++;
+    }
+    else
+    {
+      Corrupted++;
+    }
+    TxFrame = TxLen;
+  }
+}
+
+/* Line traffic, on its own schedule: the sentences and the burst of an epoch */
+void TargetSim_WakeCallback(void)
+{
+  uint8_t buf[FRAME_MAX];
+  uint32_t burst = 0U;
+  uint32_t len;
+  uint32_t i;
+
+  for (i = 0U; i < SENTENCES_PER_EPOCH; i++)
+  {
+    len = Sentence(SentSentences++, (char *)buf);
+    HOST_CHECK(TargetSim_Receive(UARTPORT_USART1, buf, len) == len);
+  }
+  while ((len = Frame(SentFrames, buf)), ((burst + len) <= BURST_BYTES))
+  {
+    HOST_CHECK(TargetSim_Receive(UARTPORT_USART1, buf, len) == len);
+    burst += len;
+    SentFrames++;
+  }
+
+  EpochAt += EPOCH_MS * Ms;
+  if (--EpochsLeft != 0U)
+  {
+    TargetSim_WakeAt(EpochAt);
+  }
+}
+
+/* Main loop for a number of epochs of traffic, then until USART6 is done */
+static void Run(uint32_t Epochs)
+{
+  uint64_t end;
+
+  EpochsLeft = Epochs;
+  EpochAt = TargetSim_GetTime();
+  TargetSim_WakeAt(EpochAt);
+  while ((EpochsLeft != 0U) || (TargetSim_GetRxQueued(UARTPORT_USART1) != 0U)
+         || (TxQueue_GetPending(&hRtcm3TxQueue) != 0U))
+  {
+    RxPoll();
+    TargetSim_Run(LOOP_CYCLES + (HostTest_Rand() % LOOP_CYCLES));
+  }
+  end = TargetSim_GetTime() + (EPOCH_MS * Ms);
+  while (TargetSim_GetTime() < end)
+  {
+    RxPoll();
+    TargetSim_Run(LOOP_CYCLES);
+  }
+}
+
+int main(void)
+{
+  const TargetSim_PortStatsTypeDef *line = TargetSim_GetPortStats(UARTPORT_USART6);
+  uint32_t frames;
+  uint32_t validated;
+  uint32_t forwarded;
+  uint32_t dropped;
+  uint32_t bytes;
+
+  /* What main() does up to the main loop, for USART1 reception */
+  TargetSim_Init();
+  HOST_CHECK(HAL_Init() == HAL_OK);
+  MX_GPIO_Init();
+  HOST_CHECK(UartPort_Init(UartPortConfig, sizeof(UartPortConfig) / sizeof(UartPortConfig[0])) == HAL_OK);
+  HOST_CHECK(UartPort_SetBaudRate(UARTPORT_USART1, RX_BAUD) == HAL_OK);
+  RxInit();
+  RxStart();
+  Ms = SystemCoreClock / 1000U;
+
+  Run(NOMINAL_EPOCHS);
+  HOST_CHECK((hRtcm3.FrameCount == SentFrames) && (hRtcm3.CrcErrors == 0U) && (rtcm3DroppedFrames == 0U));
+  HOST_CHECK((Forwarded == SentFrames) && (Corrupted == 0U) && (Split != 0U));
+  HOST_CHECK((TxLen == ExpectedLen) && (TxMismatch == 0U) && (line->TxBytes == TxLen));
+  HOST_CHECK((hNmea.SentenceCount == SentSentences) && (hRxRing.DroppedBytes == 0U));
+  HOST_CHECK((rtcm3HeldHead == rtcm3HeldTail) && (RingBuf_GetCount(&hRxRing) == 0U));
+  printf("nominal: %u frames, %u bytes forwarded at %u baud, %u in two segments, %u sentences\n",
+         (unsigned)SentFrames, (unsigned)TxLen, (unsigned)hDMAIdleReciever6.Init.BaudRate, (unsigned)Split,
+         (unsigned)hNmea.SentenceCount);
+
+  /* The queue is idle: nothing is aborted */
+  frames = SentFrames;
+  validated = hRtcm3.FrameCount;
+  forwarded = Forwarded;
+  dropped = rtcm3DroppedFrames;
+  bytes = TxLen;
+  HOST_CHECK(UartPort_SetBaudRate(UARTPORT_USART6, SLOW_BAUD) == HAL_OK);
+  TxQueue_Abort(&hRtcm3TxQueue);
+  Run(SLOW_EPOCHS);
+
+  /* Every frame validated is either sent whole or dropped whole */
+  HOST_CHECK((rtcm3DroppedFrames != dropped) && (hRxRing.DroppedBytes != 0U));
+  HOST_CHECK((hRtcm3.FrameCount - validated) == ((Forwarded - forwarded) + (rtcm3DroppedFrames - dropped)));
+  HOST_CHECK((hRtcm3.FrameCount - validated) < (SentFrames - frames));
+  HOST_CHECK((TxLen == ExpectedLen) && (TxMismatch == 0U) && (line->TxBytes == TxLen));
+  HOST_CHECK((Corrupted == 0U) && (hNmea.ChecksumErrors == 0U));
+  HOST_CHECK(rtcm3HeldHead == rtcm3HeldTail);
+  printf("slow sink: %u frames, %u validated, %u forwarded at %u baud (%u bytes), %u dropped whole; "
+         "%u bytes refused by the ring\n", (unsigned)(SentFrames - frames), (unsigned)(hRtcm3.FrameCount - validated),
+         (unsigned)(Forwarded - forwarded), (unsigned)hDMAIdleReciever6.Init.BaudRate, (unsigned)(TxLen - bytes),
+         (unsigned)(rtcm3DroppedFrames - dropped), (unsigned)hRxRing.DroppedBytes);
+
+  return HostTest_Result("test_rtcm3_forward");
+}
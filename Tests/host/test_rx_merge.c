@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file           : test_rx_merge.c
+  * @brief          : Time-ordered merge of three synthetic interleaved feeds.
+  ******************************************************************************
+  * @attention
+  *
+  * Three sources produce frames at different rates; each frame reaches the
+  * merger after a random delivery latency, in the order of its source, and
+  * source 2 goes silent for 4000 ticks. Timestamps start just below 2^32
+  * so that they wrap. Every record is checked against its frame (timestamp,
+  * source, sequence number). With latencies below the merge window, records
+  * must come out in timestamp order and none late; with latencies beyond
+  * it, records out of order must be flagged late, and none may be lost.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "rx_merge.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_SOURCES                   3U
+#define WINDOW                        50U
+#define TICKS                         20000U
+#define QUEUE_SIZE                    1024U
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Timestamp;
+  uint32_t Due;
+} Frame_TypeDef;
+
+typedef struct
+{
+  uint32_t Pushed;
+  uint32_t Merged;
+  uint32_t Late;
+  uint32_t Disorder;
+  uint32_t Corrupt;
+} Stats_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static RxMerge_HandleTypeDef Merge;
+static RxMerge_SourceTypeDef Sources[NUM_SOURCES];
+static uint8_t Output[1024];
+static uint8_t Stage[NUM_SOURCES][1024];
+
+/* Frames on their way to the merger, per source */
+static Frame_TypeDef Queue[NUM_SOURCES][QUEUE_SIZE];
+static uint32_t QueueHead[NUM_SOURCES];
+static uint32_t QueueTail[NUM_SOURCES];
+static uint32_t PushSeq[NUM_SOURCES];
+static uint32_t MergeSeq[NUM_SOURCES];
+
+/* Private functions ---------------------------------------------------------*/
+static void Drain(Stats_TypeDef *pStats, uint32_t *pLast)
+{
+  RxMerge_RecordTypeDef r;
+  const uint8_t *p;
+  uint8_t payload[32];
+  uint32_t index;
+  uint32_t left;
+  uint32_t k;
+  uint32_t n;
+  uint32_t ts;
+  uint32_t seq;
+
+  while (RxMerge_GetRecord(&Merge, &r) != 0U)
+  {
+    index = r.Offset;
+    left = r.Length;
+    k = 0U;
+    while ((left != 0U) && ((n = RingBuf_Peek(&Merge.Output, index, &p)) != 0U))
+    {
+      n = (n > left) ? left : n;
+      memcpy(&payload[k], p, n);
+      k += n;
+      index += n;
+      left -= n;
+    }
+    memcpy(&ts, &payload[0], 4U);
+    memcpy(&seq, &payload[5], 4U);
+    if ((k != r.Length) || (ts != r.Timestamp) || (payload[4] != r.Source) || (r.Source >= NUM_SOURCES)
+        || (seq != MergeSeq[r.Source]))
+    {
+      pStats->Corrupt++;
+    }
+    else
+    {
+      MergeSeq[r.Source]++;
+    }
+
+    if ((r.Flags & RXMERGE_FLAG_LATE) != 0U)
+    {
+      pStats->Late++;
+    }
+    else
+    {
+      if ((int32_t)(r.Timestamp - *pLast) < 0)
+      {
+        pStats->Disorder++;
+      }
+      *pLast = r.Timestamp;
+    }
+    pStats->Merged++;
+    RxMerge_Release(&Merge, &r);
+  }
+}
+
+static void Run(uint32_t MaxLatency, Stats_TypeDef *pStats)
+{
+  uint32_t now = 0xFFFFF000U;
+  uint32_t last = now;
+  uint32_t due;
+  uint32_t t;
+  uint32_t s;
+  uint8_t frame[16];
+  Frame_TypeDef *f;
+
+  memset(pStats, 0, sizeof(*pStats));
+  memset(QueueHead, 0, sizeof(QueueHead));
+  memset(QueueTail, 0, sizeof(QueueTail));
+  memset(PushSeq, 0, sizeof(PushSeq));
+  memset(MergeSeq, 0, sizeof(MergeSeq));
+  HOST_CHECK(RxMerge_Init(&Merge, Sources, NUM_SOURCES, Output, sizeof(Output), WINDOW) == HAL_OK);
+  for (s = 0U; s < NUM_SOURCES; s++)
+  {
+    HOST_CHECK(RxMerge_InitSource(&Merge, s, Stage[s], sizeof(Stage[s])) == HAL_OK);
+  }
+
+  for (t = 0U; t < TICKS; t++, now++)
+  {
+    for (s = 0U; s < NUM_SOURCES; s++)
+    {
+      /* One frame every 5, 12 and 19 ticks on average; source 2 pauses */
+      if (((HostTest_Rand() % (5U + (7U * s))) == 0U) && !((s == 2U) && (t > 5000U) && (t < 9000U)))
+      {
+        due = now + (HostTest_Rand() % MaxLatency);
+        f = &Queue[s][QueueHead[s]++ % QUEUE_SIZE];
+        f->Timestamp = now;
+        f->Due = due;
+      }
+
+      /* Frames of a source reach the merger in order, once due */
+      while ((QueueTail[s] != QueueHead[s])
+             && ((int32_t)(now - Queue[s][QueueTail[s] % QUEUE_SIZE].Due) >= 0))
+      {
+        f = &Queue[s][QueueTail[s]++ % QUEUE_SIZE];
+        memcpy(&frame[0], &f->Timestamp, 4U);
+        frame[4] = (uint8_t)s;
+        memcpy(&frame[5], &PushSeq[s], 4U);
+        if (RxMerge_Push(&Merge, s, frame, (uint16_t)(9U + (HostTest_Rand() % 7U)), f->Timestamp) == HAL_OK)
+        {
+          PushSeq[s]++;
+          pStats->Pushed++;
+        }
+      }
+    }
+    RxMerge_Poll(&Merge, now);
+    Drain(pStats, &last);
+  }
+  RxMerge_Poll(&Merge, now + 1000U);
+  Drain(pStats, &last);
+
+  for (s = 0U; s < NUM_SOURCES; s++)
+  {
+    HOST_CHECK(Sources[s].DroppedFrames == 0U);
+  }
+  HOST_CHECK(pStats->Merged == pStats->Pushed);
+  HOST_CHECK(pStats->Corrupt == 0U);
+  HOST_CHECK(pStats->Disorder == 0U);
+  printf("latency < %u ticks, window %u: %u frames merged, %u late\n", (unsigned)MaxLatency,
+         (unsigned)WINDOW, (unsigned)pStats->Merged, (unsigned)pStats->Late);
+}
+
+int main(void)
+{
+  Stats_TypeDef stats;
+
+  Run(20U, &stats);
+  HOST_CHECK(stats.Late == 0U);
+
+  Run(80U, &stats);
+  HOST_CHECK(stats.Late != 0U);
+
+  return HostTest_Result("test_rx_merge");
+}
@@ -0,0 +1,250 @@
+/**
+  ******************************************************************************
+  * @file           : test_ubx.c
+  * @brief          : UBX frames among NMEA, RTCM3 and false syncs.
+  ******************************************************************************
+  * @attention
+  *
+  * Builds a stream of UBX frames (NAV-PVT and numbered frames whose payload
+  * holds B5 62 pairs) mixed with NMEA sentences, RTCM3-like binary blocks and
+  * false B5 62 headers, announcing either more than UBX_MAX_PAYLOAD bytes or a
+  * plausible length that covers the frames after them. The stream is fed in
+  * random fragments; every UBX frame must be delivered once, intact and in
+  * order, and nothing else.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "ubx.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FRAMES                        20000U
+#define STREAM_SIZE                   (16U * 1024U * 1024U)
+#define TEST_CLASS                    0xF7U
+#define TEST_ID                       0x01U
+
+/* Private variables ---------------------------------------------------------*/
+static Ubx_HandleTypeDef Ubx;
+static uint8_t Stream[STREAM_SIZE];
+static uint32_t StreamLen;
+
+/* Sequence number of the next frame expected, and what was delivered */
+static uint32_t NextSeq;
+static uint32_t NextPvt;
+static uint32_t Delivered;
+static uint32_t Unexpected;
+
+/* Private functions ---------------------------------------------------------*/
+static void Put(const void *pData, uint32_t Len)
+{
+  memcpy(&Stream[StreamLen], pData, Len);
+  StreamLen += Len;
+}
+
+static void PutFrame(uint8_t Class, uint8_t Id, const uint8_t *pPayload, uint16_t Len)
+{
+  uint8_t header[6] = { UBX_SYNC_CHAR_1, UBX_SYNC_CHAR_2, Class, Id, (uint8_t)Len, (uint8_t)(Len >> 8) };
+  uint8_t ck[2] = { 0U, 0U };
+  uint32_t i;
+
+  for (i = 2U; i < 6U; i++)
+  {
+    ck[0] += header[i];
+    ck[1] += ck[0];
+  }
+  for (i = 0U; i < Len; i++)
+  {
+    ck[0] += pPayload[i];
+    ck[1] += ck[0];
+  }
+  Put(header, 6U);
+  Put(pPayload, Len);
+  Put(ck, 2U);
+}
+
+/* Payload of numbered frame Seq: the number, then bytes with B5 62 pairs */
+static uint16_t TestPayload(uint32_t Seq, uint8_t *pPayload)
+{
+  uint32_t x = (Seq * 2654435761U) + 1U;
+  uint16_t len = (uint16_t)(4U + (x % 300U));
+  uint32_t i;
+
+  memcpy(pPayload, &Seq, 4U);
+  for (i = 4U; i < len; i++)
+  {
+    x = (x * 1103515245U) + 12345U;
+    pPayload[i] = ((x >> 28) == 0U) ? (((i & 1U) == 0U) ? UBX_SYNC_CHAR_1 : UBX_SYNC_CHAR_2) : (uint8_t)(x >> 16);
+  }
+  return len;
+}
+
+static void PutNoise(void)
+{
+  static const char *const Sentences[] =
+  {
+    "$GNGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n",
+    "$GNRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n",
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n",
+  };
+  const char *sentence;
+  uint8_t block[600];
+  uint32_t len;
+  uint32_t i;
+
+  switch (HostTest_Rand() % 4U)
+  {
+    case 0:
+      sentence = Sentences[HostTest_Rand() % 3U];
+      Put(sentence, (uint32_t)strlen(sentence));
+      break;
+
+    case 1:
+      /* RTCM3 frame shape, binary body with the odd B5 62 */
+      len = 6U + (HostTest_Rand() % 500U);
+      for (i = 0U; i < len; i++)
+      {
+        block[i] = (uint8_t)HostTest_Rand();
+      }
+      if ((HostTest_Rand() % 4U) == 0U)
+      {
+        i = 3U + (HostTest_Rand() % (len - 4U));
+        block[i] = UBX_SYNC_CHAR_1;
+        block[i + 1U] = UBX_SYNC_CHAR_2;
+      }
+      block[0] = 0xD3U;
+      block[1] = (uint8_t)((len - 6U) >> 8);
+      block[2] = (uint8_t)(len - 6U);
+      Put(block, len);
+      break;
+
+    case 2:
+      /* False sync announcing more than UBX_MAX_PAYLOAD */
+      len = UBX_MAX_PAYLOAD + 1U + (HostTest_Rand() % (65535U - UBX_MAX_PAYLOAD));
+      block[0] = UBX_SYNC_CHAR_1;
+      block[1] = UBX_SYNC_CHAR_2;
+      block[2] = (uint8_t)HostTest_Rand();
+      block[3] = (uint8_t)HostTest_Rand();
+      block[4] = (uint8_t)len;
+      block[5] = (uint8_t)(len >> 8);
+      Put(block, 6U);
+      break;
+
+    default:
+      /* False sync with a plausible length, covering the next frames */
+      len = HostTest_Rand() % (UBX_MAX_PAYLOAD + 1U);
+      block[0] = UBX_SYNC_CHAR_1;
+      block[1] = UBX_SYNC_CHAR_2;
+      block[2] = (uint8_t)HostTest_Rand();
+      block[3] = (uint8_t)HostTest_Rand();
+      block[4] = (uint8_t)len;
+      block[5] = (uint8_t)(len >> 8);
+      Put(block, 2U + (HostTest_Rand() % 5U));
+      break;
+  }
+}
+
+static Ubx_NavPvtTypeDef PvtOf(uint32_t Seq)
+{
+  Ubx_NavPvtTypeDef pvt;
+
+  memset(&pvt, 0, sizeof(pvt));
+  pvt.iTOW = Seq * 1000U;
+  pvt.Lat = 480638970 + (int32_t)Seq;
+  pvt.Lon = -(int32_t)(115166670U + Seq);
+  pvt.FixType = 3U;
+  return pvt;
+}
+
+static void PutPvt(uint32_t Seq)
+{
+  Ubx_NavPvtTypeDef pvt = PvtOf(Seq);
+  uint8_t payload[UBX_NAV_PVT_LENGTH];
+
+  memset(payload, 0xB5, sizeof(payload));
+  memcpy(&payload[0], &pvt.iTOW, 4U);
+  payload[20] = pvt.FixType;
+  memcpy(&payload[24], &pvt.Lon, 4U);
+  memcpy(&payload[28], &pvt.Lat, 4U);
+  PutFrame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LENGTH);
+}
+
+void Ubx_MessageCallback(Ubx_HandleTypeDef *hubx, uint8_t Class, uint8_t Id, const uint8_t *pPayload, uint16_t Length)
+{
+  uint8_t expected[UBX_MAX_PAYLOAD];
+
+  UNUSED(hubx);
+  if ((Class == TEST_CLASS) && (Id == TEST_ID) && (Length == TestPayload(NextSeq, expected))
+      && (memcmp(pPayload, expected, Length) == 0))
+  {
+    NextSeq++;
+    Delivered++;
+  }
+  else
+  {
+    Unexpected++;
+  }
+}
+
+void Ubx_NavPvtCallback(Ubx_HandleTypeDef *hubx, const Ubx_NavPvtTypeDef *pNavPvt)
+{
+  Ubx_NavPvtTypeDef pvt = PvtOf(NextPvt);
+
+  UNUSED(hubx);
+  if ((pNavPvt->iTOW == pvt.iTOW) && (pNavPvt->Lat == pvt.Lat) && (pNavPvt->Lon == pvt.Lon)
+      && (pNavPvt->FixType == pvt.FixType))
+  {
+    NextPvt++;
+    Delivered++;
+  }
+  else
+  {
+    Unexpected++;
+  }
+}
+
+int main(void)
+{
+  uint8_t payload[UBX_MAX_PAYLOAD];
+  uint32_t pvts = 0U;
+  uint32_t seq = 0U;
+  uint32_t i;
+  uint32_t n;
+
+  for (i = 0U; i < FRAMES; i++)
+  {
+    while ((HostTest_Rand() % 3U) != 0U)
+    {
+      PutNoise();
+    }
+    if ((HostTest_Rand() % 4U) == 0U)
+    {
+      PutPvt(pvts++);
+    }
+    else
+    {
+      PutFrame(TEST_CLASS, TEST_ID, payload, TestPayload(seq, payload));
+      seq++;
+    }
+  }
+
+  Ubx_Init(&Ubx);
+  for (i = 0U; i < StreamLen; i += n)
+  {
+    n = 1U + (HostTest_Rand() % 300U);
+    n = (n > (StreamLen - i)) ? (StreamLen - i) : n;
+    Ubx_Parse(&Ubx, &Stream[i], n);
+  }
+
+  HOST_CHECK(Delivered == FRAMES);
+  HOST_CHECK((NextSeq == seq) && (NextPvt == pvts));
+  HOST_CHECK(Unexpected == 0U);
+  HOST_CHECK(Ubx.FrameCount == FRAMES);
+  printf("%u KB: %u of %u frames delivered, %u unexpected, %u checksum and %u length rejections\n",
+         (unsigned)(StreamLen / 1024U), (unsigned)Delivered, (unsigned)FRAMES, (unsigned)Unexpected,
+         (unsigned)Ubx.ChecksumErrors, (unsigned)Ubx.LengthErrors);
+
+  return HostTest_Result("test_ubx");
+}
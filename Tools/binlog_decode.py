@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Decode a log captured from USART1 that mixes text and BINLOG() records.
+
+Usage: binlog_decode.py ELF [CAPTURE]
+
+ELF is the image running on the target (Debug/DMAIdleReciever.elf); the format strings
+are read from its .binlog section. CAPTURE is the raw byte capture, standard
+input if omitted. Text is copied as is, records are formatted with their
+string; a record that cannot be decoded is shown as <binlog ...>.
+"""
+
+import re
+import struct
+import sys
+
+SYNC = 0xFF
+
+# %[flags][width][.precision][length]conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|j|z|t)?([diuxXocp%])")
+
+
+def read_binlog_section(path):
+    """Return the .binlog section of an ELF32 little-endian file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise ValueError("%s: not a little-endian ELF32 file" % path)
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def header(i):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<IIIIII", elf, shoff + i * shentsize)
+
+    names = header(shstrndx)[4]
+    for i in range(shnum):
+        name, _, _, _, offset, size = header(i)
+        end = elf.index(b"\0", names + name)
+        if elf[names + name:end] == b".binlog":
+            return elf[offset:offset + size]
+    raise ValueError("%s: no .binlog section" % path)
+
+
+def string_table(section):
+    """Map the offset of each NUL-terminated string to its text."""
+    table = {}
+    start = 0
+    while start < len(section):
+        end = section.find(b"\0", start)
+        if end < 0:
+            end = len(section)
+        if end > start:
+            table[start] = section[start:end].decode("latin-1")
+        start = end + 1
+    return table
+
+
+def varints(payload):
+    """Split a payload into the LEB128 values it holds."""
+    values = []
+    value = 0
+    shift = 0
+    for byte in payload:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            values.append(value & 0xFFFFFFFF)
+            value = 0
+            shift = 0
+        elif shift > 28:
+            raise ValueError("varint too long")
+    if shift != 0:
+        raise ValueError("truncated varint")
+    return values
+
+
+def format_record(fmt, args):
+    """Apply a C format string to 32-bit arguments."""
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = args.pop(0)
+        if conversion in "di":
+            value -= (value & 0x80000000) << 1
+        elif conversion == "c":
+            return ("%" + flags.replace("0", "") + width + "s") % chr(value)
+        elif conversion == "p":
+            conversion, flags = "x", flags + "#"
+        spec = "%" + flags + width
+        if precision is not None:
+            spec += "." + precision
+        return (spec + conversion) % value
+
+    text = CONVERSION.sub(convert, fmt)
+    if args:
+        raise ValueError("unused arguments")
+    return text
+
+
+def decode(data, table, out):
+    i = 0
+    while i < len(data):
+        if data[i] != SYNC:
+            end = data.find(bytes([SYNC]), i)
+            if end < 0:
+                end = len(data)
+            out.write(data[i:end].decode("latin-1"))
+            i = end
+            continue
+        if i + 2 > len(data):
+            out.write("<binlog truncated>")
+            break
+        length = data[i + 1]
+        payload = data[i + 2:i + 2 + length]
+        i += 2 + length
+        try:
+            values = varints(payload)
+            out.write(format_record(table[values[0]], values[1:]))
+        except (ValueError, KeyError, IndexError):
+            out.write("<binlog %s>" % payload.hex())
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    table = string_table(read_binlog_section(argv[1]))
+    if len(argv) == 3:
+        with open(argv[2], "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(data, table, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))